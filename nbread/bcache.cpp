@@ -0,0 +1,285 @@
+/****************************************************************************
+FILE          : bcache.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the notice body cache.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cctype>
+#include <cstdlib>
+
+using namespace std;
+
+#include "bcache.hpp"
+#include "config.hpp"
+#include "metrics.hpp"
+
+// Used when no budget has been configured.
+static const size_t Default_Budget = 4 * 1024 * 1024;
+
+static const spica::parameter_handle Cache_Size_Handle = spica::resolve_parameter("Notice_Cache_Size");
+
+static spica::metric_counter   Cache_Hits("body_cache.hits");
+static spica::metric_counter   Cache_Misses("body_cache.misses");
+static spica::metric_counter   Body_Bytes("body_cache.bytes_loaded");
+static spica::metric_histogram Body_Loads("body_cache.load");
+
+//
+// Cache_Key
+//
+// Notice paths are case insensitive so the keys are folded to upper case.
+//
+static string Cache_Key(const char *Path)
+  {
+    string Key(Path);
+    for (string::iterator Stepper = Key.begin(); Stepper != Key.end(); Stepper++) {
+      *Stepper = static_cast<char>(toupper(static_cast<unsigned char>(*Stepper)));
+    }
+    return Key;
+  }
+
+
+//
+// Body_Cost
+//
+// Returns the number of bytes a body is charged against the budget: the text itself plus
+//   its line index.
+//
+static size_t Body_Cost(const Notice_Body &Body)
+  {
+    return sizeof(Notice_Body) + Body.Size() + Body.Line_Count() * sizeof(unsigned);
+  }
+
+
+//
+// Load_Body
+//
+static shared_ptr<const Notice_Body> Load_Body(const string &Path, bool &Opened)
+  {
+    spica::metric_timer Timer(Body_Loads);
+    shared_ptr<Notice_Body> Body(new Notice_Body);
+    Opened = Body->Load(Path.c_str());
+    Body_Bytes.add(Body->Size());
+    return Body;
+  }
+
+
+//
+// Body_Cache::Instance
+//
+Body_Cache &Body_Cache::Instance()
+  {
+    static Body_Cache The_Cache;
+    return The_Cache;
+  }
+
+
+//
+// Body_Cache::Body_Cache
+//
+Body_Cache::Body_Cache() :
+  Byte_Budget(Default_Budget),
+  Config_Generation(0),
+  Byte_Count (0),
+  Stopping   (false)
+  { }
+
+
+//
+// Body_Cache::~Body_Cache
+//
+Body_Cache::~Body_Cache()
+  {
+    {
+      lock_guard<mutex> Guard(Lock);
+      Stopping = true;
+    }
+    Wakeup.notify_one();
+    if (Loader.joinable()) Loader.join();
+  }
+
+
+//
+// Body_Cache::Fetch
+//
+// The notice is loaded without holding the lock so that a slow file doesn't block the
+//   prefetch thread (or the other way around).
+//
+shared_ptr<const Notice_Body> Body_Cache::Fetch(const char *Path)
+  {
+    string Key(Cache_Key(Path));
+    {
+      lock_guard<mutex> Guard(Lock);
+      unordered_map<string, Entry_List::iterator>::iterator Found = Index.find(Key);
+      if (Found != Index.end()) {
+        Entries.splice(Entries.begin(), Entries, Found->second);
+        Cache_Hits.add();
+        return Found->second->Body;
+      }
+    }
+    Cache_Misses.add();
+
+    bool Opened;
+    shared_ptr<const Notice_Body> Body(Load_Body(Path, Opened));
+    if (!Opened) return Body;
+
+    lock_guard<mutex> Guard(Lock);
+    return Insert(Key, Body);
+  }
+
+
+//
+// Body_Cache::Prefetch
+//
+void Body_Cache::Prefetch(const char *Path)
+  {
+    string Key(Cache_Key(Path));
+
+    lock_guard<mutex> Guard(Lock);
+    if (Index.find(Key) != Index.end()) return;
+
+    Pending = Path;
+    if (!Loader.joinable()) Loader = thread(&Body_Cache::Run_Loader, this);
+    Wakeup.notify_one();
+  }
+
+
+//
+// Body_Cache::Budget
+//
+size_t Body_Cache::Budget()
+  {
+    lock_guard<mutex> Guard(Lock);
+    Read_Budget();
+    return Byte_Budget;
+  }
+
+
+//
+// Body_Cache::Used
+//
+size_t Body_Cache::Used()
+  {
+    lock_guard<mutex> Guard(Lock);
+    return Byte_Count;
+  }
+
+
+//
+// Body_Cache::Insert
+//
+// The caller must hold the lock. If the body was loaded by someone else in the meantime
+//   the existing copy wins and the new one is discarded.
+//
+shared_ptr<const Notice_Body>
+  Body_Cache::Insert(const string &Key, shared_ptr<const Notice_Body> Body)
+  {
+    unordered_map<string, Entry_List::iterator>::iterator Found = Index.find(Key);
+    if (Found != Index.end()) {
+      Entries.splice(Entries.begin(), Entries, Found->second);
+      return Found->second->Body;
+    }
+
+    Entry New_Entry;
+    New_Entry.Key  = Key;
+    New_Entry.Body = Body;
+    New_Entry.Cost = Body_Cost(*Body);
+    Entries.push_front(New_Entry);
+    Index[Key] = Entries.begin();
+    Byte_Count += New_Entry.Cost;
+    Read_Budget();
+    Trim();
+    return Body;
+  }
+
+
+//
+// Body_Cache::Read_Budget
+//
+// The caller must hold the lock. The snapshot is only examined when a new one has been
+//   published. A budget that is missing or not positive leaves the default in effect.
+//
+void Body_Cache::Read_Budget()
+  {
+    shared_ptr<const spica::Config_Snapshot> Settings = spica::config_snapshot();
+    if (Settings->generation() == Config_Generation) return;
+    Config_Generation = Settings->generation();
+
+    Byte_Budget = Default_Budget;
+    const string *Cache_Size = Settings->lookup(Cache_Size_Handle);
+    if (Cache_Size != 0) {
+      long Kilobytes = atol(Cache_Size->c_str());
+      if (Kilobytes > 0) Byte_Budget = static_cast<size_t>(Kilobytes) * 1024;
+    }
+  }
+
+
+//
+// Body_Cache::Trim
+//
+// The caller must hold the lock. The most recently used body is always kept, even if it
+//   is larger than the entire budget by itself.
+//
+void Body_Cache::Trim()
+  {
+    while (Byte_Count > Byte_Budget && Entries.size() > 1) {
+      Entry &Victim = Entries.back();
+      Byte_Count -= Victim.Cost;
+      Index.erase(Victim.Key);
+      Entries.pop_back();
+    }
+  }
+
+
+//
+// Body_Cache::Run_Loader
+//
+// This is the body of the prefetch thread.
+//
+void Body_Cache::Run_Loader()
+  {
+    unique_lock<mutex> Guard(Lock);
+    while (true) {
+      while (!Stopping && Pending.empty()) Wakeup.wait(Guard);
+      if (Stopping) return;
+
+      string Path;
+      Path.swap(Pending);
+      string Key(Cache_Key(Path.c_str()));
+      if (Index.find(Key) != Index.end()) continue;
+
+      Guard.unlock();
+      bool Opened;
+      shared_ptr<const Notice_Body> Body(Load_Body(Path, Opened));
+      Guard.lock();
+
+      if (Opened) Insert(Key, Body);
+    }
+  }
@@ -0,0 +1,111 @@
+/****************************************************************************
+FILE          : bcache.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the notice body cache.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+There is one Body_Cache for the whole process. It holds the bodies of recently
+viewed notices up to a byte budget, discarding the least recently used bodies
+when the budget is exceeded. A body that has been discarded is simply loaded
+again the next time it is wanted. The cache can also load a body ahead of
+time on a background thread so that it is ready when the user gets to it.
+
+The budget is the configuration parameter Notice_Cache_Size (in kilobytes).
+The cache reads it from the published configuration snapshot, on whichever
+thread is inserting a body, so a change to the configuration files takes
+effect without the user interface thread having to pass it along.
+
+Bodies are handed out as shared pointers. A body that is evicted while it is
+being drawn stays alive until the drawing code lets go of it.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef BCACHE_H
+#define BCACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "nbody.hpp"
+
+class Body_Cache {
+  public:
+    static Body_Cache &Instance();
+      // Returns the process-wide cache.
+
+   ~Body_Cache();
+
+    std::shared_ptr<const Notice_Body> Fetch(const char *Path);
+      // Returns the body of the named notice, loading it if necessary. Never returns null;
+      //   a notice that can't be opened has an empty body (which is not cached).
+
+    void Prefetch(const char *Path);
+      // Arranges for the named notice to be loaded in the background. Only the most recent
+      //   request is remembered; an older one that hasn't started yet is dropped.
+
+    std::size_t Budget();
+    std::size_t Used();
+      // Hits and misses are counted by the body_cache.hits and body_cache.misses metrics.
+
+  private:
+    struct Entry {
+      std::string                        Key;
+      std::shared_ptr<const Notice_Body> Body;
+      std::size_t                        Cost;
+    };
+    typedef std::list<Entry> Entry_List;
+
+    Entry_List  Entries;  // Most recently used first.
+    std::unordered_map<std::string, Entry_List::iterator> Index;
+    std::size_t Byte_Budget;
+    unsigned long Config_Generation;  // Snapshot the budget was last read from.
+    std::size_t Byte_Count;
+
+    std::mutex              Lock;      // Protects everything above.
+    std::thread             Loader;    // Started by the first prefetch request.
+    std::condition_variable Wakeup;
+    std::string             Pending;   // Path to prefetch next (empty if none).
+    bool                    Stopping;
+
+    Body_Cache();
+    Body_Cache(const Body_Cache &);
+    Body_Cache &operator=(const Body_Cache &);
+
+    std::shared_ptr<const Notice_Body>
+         Insert(const std::string &Key, std::shared_ptr<const Notice_Body> Body);
+    void Read_Budget();
+    void Trim();
+    void Run_Loader();
+};
+
+#endif
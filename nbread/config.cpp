@@ -4,42 +4,173 @@
 
 */
 
+#include "environ.hpp"
+
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
 #include <fstream>
-#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#if eOPSYS == eWIN32
+#include <windows.h>
+#undef min
+#undef max
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
 #include "config.hpp"
+#include "metrics.hpp"
 
 using namespace std;
 
 namespace spica {
 
-    struct dictionary_entry {
-        string name;
-        string value;
-        bool   personalized;
-
-        // I don't believe this is necessary, but to be on the safe side...
-        dictionary_entry( ) : personalized( false ) { }
-    };
-
-    // This is the dictionary. This should really be upgraded to a map someday. The reason it's
-    // a list is because this is "legacy" C code that has been lightly gone over for use with
-    // C++.
+    // Parameter names are shared by all configurations. Each name is interned once, as a key in
+    // the index, and given the next number; the number is the parameter's position in every
+    // configuration's dictionary. The table is created on first use and never destroyed. The
+    // lock is only taken when a name has to be looked up, which the handles avoid.
     //
-    static list< dictionary_entry > the_dictionary;
+    struct name_table {
+        mutex                             lock;
+        unordered_map< string, unsigned > index;
+        vector< const string * >          names;  // Points at the keys in the index.
+    };
 
     // The character used to mark the start of a comment in a
     // configuration file. Comments run to the end of the line.
     //
     const char comment_char = '#';
 
+    // Lookups by name search the name table under its lock, so they are worth counting.
+    static metric_counter   name_lookups( "config.name_lookups" );
+    static metric_counter   reloads( "config.reloads" );
+    static metric_histogram load_times( "config.load" );
+
     // ===========================
     // Internally Linked Functions
     // ===========================
 
 
+    /*!
+     * Returns the name table.
+     */
+    static name_table &the_names( )
+    {
+        static name_table *names = new name_table;
+        return *names;
+    }
+
+
+    /*!
+     * Returns the number of the given name, adding it to the table if it hasn't been seen
+     * before.
+     */
+    static unsigned intern( const string &name )
+    {
+        name_table &table = the_names( );
+        lock_guard< mutex > guard( table.lock );
+
+        pair< unordered_map< string, unsigned >::iterator, bool > result =
+            table.index.insert( make_pair( name, static_cast< unsigned >( table.names.size( ) ) ) );
+
+        if( result.second ) table.names.push_back( &result.first->first );
+        return result.first->second;
+    }
+
+
+    /*!
+     * Looks for the given name without adding it. Returns false if the name hasn't been seen.
+     */
+    static bool find_name( const char *name, unsigned &number )
+    {
+        name_table &table = the_names( );
+        lock_guard< mutex > guard( table.lock );
+
+        unordered_map< string, unsigned >::iterator found = table.index.find( name );
+        if( found == table.index.end( ) ) return false;
+        number = found->second;
+        return true;
+    }
+
+
+    /*!
+     * Returns the name with the given number.
+     */
+    static const string &name_of( unsigned number )
+    {
+        name_table &table = the_names( );
+        lock_guard< mutex > guard( table.lock );
+
+        return *table.names[number];
+    }
+
+
+    /*!
+     * Returns the dictionary entry for the given number, enlarging the dictionary as needed.
+     * Enlarging a deque at the end doesn't move the existing entries.
+     */
+    static parameter_value &entry( deque< parameter_value > &dictionary, unsigned number )
+    {
+        if( number >= dictionary.size( ) ) dictionary.resize( number + 1 );
+        return dictionary[number];
+    }
+
+
+    /*!
+     * Gives the named parameter a value, replacing any value it already had.
+     */
+    static void store(
+        deque< parameter_value > &dictionary,
+        const string &name,
+        const string &value,
+        bool personalized
+    )
+    {
+        parameter_value &slot = entry( dictionary, intern( name ) );
+
+        slot.value        = value;
+        slot.defined      = true;
+        slot.personalized = personalized;
+    }
+
+
+    /*!
+     * Fills in a file's time stamp. A file that can't be examined gets a zero stamp, so one
+     * that appears later is seen as a change. The modification time is kept at the finest
+     * resolution the system offers (100ns on Win32, nanoseconds on most POSIX systems) so that
+     * an edit that doesn't change the size is noticed even within the same second.
+     */
+    static void examine( const string &path, long long &modified, long long &size )
+    {
+        modified = 0;
+        size     = 0;
+        if( path.empty( ) ) return;
+
+#if eOPSYS == eWIN32
+        WIN32_FILE_ATTRIBUTE_DATA information;
+        if( !GetFileAttributesEx( path.c_str( ), GetFileExInfoStandard, &information ) ) return;
+        modified = ( static_cast< long long >( information.ftLastWriteTime.dwHighDateTime ) << 32 ) |
+                     information.ftLastWriteTime.dwLowDateTime;
+        size     = ( static_cast< long long >( information.nFileSizeHigh ) << 32 ) |
+                     information.nFileSizeLow;
+#else
+        struct stat information;
+        if( stat( path.c_str( ), &information ) != 0 ) return;
+        modified = static_cast< long long >( information.st_mtime ) * 1000000000LL;
+#if defined(__APPLE__)
+        modified += information.st_mtimespec.tv_nsec;
+#elif defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L
+        modified += information.st_mtim.tv_nsec;
+#endif
+        size     = static_cast< long long >( information.st_size );
+#endif
+    }
+
+
     /*!
      * Return true if the argument is a white space character. Otherwise it returns false. This
      * function defines the meaning of "white space" in a configuration file. I you want to make
@@ -107,20 +238,23 @@ namespace spica {
      * "=VALUE" assigns the string "VALUE" to the name "". This might be useful for some
      * programs. This behavior is currently undocumented.
     */
-    static void analyze_line( const string &the_line, bool personalized )
+    static void analyze_line(
+        const string &the_line,
+        bool personalized,
+        deque< parameter_value > &dictionary
+    )
     {
         const char *p = the_line.c_str( );
-        bool            happy = false;  // =true if this line has the right syntax.
-        dictionary_entry temp;
-
-        temp.personalized = personalized;
+        bool   happy = false;  // =true if this line has the right syntax.
+        string name;
+        string value;
 
         if( blank_line( the_line ) ) return;
         while( *p && is_white( *p ) ) p++;
 
         // Copy the first word into the temporary dictionary entry.
         while( *p && *p != '=' && !is_white( *p ) ) {
-            temp.name.append( 1, *p++ );
+            name.append( 1, *p++ );
         }
         
         while( *p && is_white( *p ) ) p++;
@@ -135,42 +269,32 @@ namespace spica {
             // behavior includes embeded white spaces in the value, and it also includes
             // trailing white spaces.
             // 
-            while( *p ) temp.value.append( 1, *p++ );
-            trim_string( temp.value );
+            while( *p ) value.append( 1, *p++ );
+            trim_string( value );
         }
 
         // If the syntax looks good, then lets add this information to the dictionary. Otherwise
         // we'll just ignore this line.
         // 
-        if( happy ) {
-            list< dictionary_entry >::iterator stepper = the_dictionary.begin( );
-
-            while( stepper != the_dictionary.end( ) ) {
-                if( stepper->name == temp.name ) {
-                    *stepper = temp;
-                    break;
-                }
-                stepper++;
-            }
-
-            if( stepper == the_dictionary.end( ) ) {
-                the_dictionary.push_back( temp );
-            }
-        }
+        if( happy ) store( dictionary, name, value, personalized );
     }
 
 
     /*!
      * There is no error checking on the handling of string or the reading of the file.
      */
-    static void process_config_file( ifstream &the_file, bool personalized )
+    static void process_config_file(
+        ifstream &the_file,
+        bool personalized,
+        deque< parameter_value > &dictionary
+    )
     {
         for( ;; ) {
             string line;
 
             getline( the_file, line );
             if( !the_file && line.size( ) == 0 ) return;
-            analyze_line( line, personalized );
+            analyze_line( line, personalized, dictionary );
         }
     }
 
@@ -178,6 +302,57 @@ namespace spica {
     // Externally Linked Functions
     // ===========================
 
+    //! Resolves a parameter name to a handle.
+    /*!
+     * The name is interned if it hasn't been seen before. The parameter need not have a value
+     * yet; a value given to it later (by a configuration file or by register_parameter()) is
+     * visible through the handle.
+     *
+     * \param name The name to resolve.
+     *
+     * \return A handle that can be passed to lookup_parameter() or to the lookup functions of
+     * any Configuration or Config_Snapshot.
+     */
+    parameter_handle resolve_parameter( const char *name )
+    {
+        return parameter_handle( intern( name ) + 1 );
+    }
+
+
+    //! Returns the value associated with the given name in this snapshot.
+    /*!
+     * \return A pointer to the value or a NULL pointer if the parameter has no value. The
+     * pointer is valid as long as the snapshot is.
+     */
+    const string *Config_Snapshot::lookup( const char *name ) const
+    {
+        unsigned number;
+
+        name_lookups.add( );
+        if( !find_name( name, number ) ) return 0;
+        return lookup( parameter_handle( number + 1 ) );
+    }
+
+
+    //! Returns the value of a resolved parameter in this snapshot.
+    const string *Config_Snapshot::lookup( parameter_handle handle ) const
+    {
+        if( !handle.is_valid( ) || handle.id > values.size( ) ) return 0;
+        const parameter_value &slot = values[handle.id - 1];
+        return slot.defined ? &slot.value : 0;
+    }
+
+
+    //! Creates an empty configuration.
+    /*!
+     * The configuration's first snapshot is empty. Nothing is published until the configuration
+     * files are read or a parameter is registered.
+     */
+    Configuration::Configuration( ) :
+        serial( 0 ), published( new Config_Snapshot )
+    { }
+
+
     //! Reads the master and personal configuration files.
     /*!
      * This function reads the given configuration file and loads a dictionary of (name, value)
@@ -191,27 +366,78 @@ namespace spica {
      * as well. Note that it is not necessary for PERSONAL_CONFIGURATION to be defined in the
      * master configuration file. It can be added ahead of time using register_parameter().
      *
+     * The new values are published as a snapshot.
+     *
      * \param path The name of the master configuration file.
      *
      * \return There is no error return. This function does not complain if it can't open the
      * configuration files.
      */
-    void read_config_files( const char *path )
+    void Configuration::read_files( const char *path )
+    {
+        master.path = path;
+        load_files( );
+        publish( );
+    }
+
+
+    //! Rereads the configuration files if either has changed.
+    /*!
+     * A file is considered changed if its modification time or size differs from when it was
+     * last read, or if it has appeared or disappeared. This is cheap enough to call whenever the
+     * program is idle. The dictionary is rebuilt from the registered values and the files, so a
+     * setting removed from a file reverts to its registered default.
+     *
+     * \return True if the files were reread and a new snapshot published.
+     */
+    bool Configuration::reload_if_changed( )
     {
+        long long master_modified, master_size;
+        long long personal_modified, personal_size;
+
+        if( master.path.empty( ) ) return false;
+        examine( master.path, master_modified, master_size );
+        examine( personal.path, personal_modified, personal_size );
+
+        if( master_modified   == master.modified   && master_size   == master.size &&
+            personal_modified == personal.modified && personal_size == personal.size ) {
+            return false;
+        }
+        reloads.add( );
+        load_files( );
+        publish( );
+        return true;
+    }
+
+
+    /*!
+     * Rebuilds the working dictionary from the registered values and the configuration files.
+     * The entries are assigned in place so that pointers returned by lookup( ) stay valid.
+     */
+    void Configuration::load_files( )
+    {
+        metric_timer timer( load_times );
         ifstream primary_config;
         ifstream secondary_config;
 
-        primary_config.open( path );
+        if( working.size( ) < registered.size( ) ) working.resize( registered.size( ) );
+        for( dictionary::size_type i = 0; i < working.size( ); ++i ) {
+            working[i] = ( i < registered.size( ) ) ? registered[i] : parameter_value( );
+        }
+
+        examine( master.path, master.modified, master.size );
+        primary_config.open( master.path.c_str( ) );
         if( primary_config )
-            process_config_file( primary_config, false );
+            process_config_file( primary_config, false, working );
 
-        string *secondary_config_name =
-            lookup_parameter( "PERSONAL_CONFIGURATION" );
+        string *secondary_config_name = lookup( "PERSONAL_CONFIGURATION" );
 
-        if( secondary_config_name != 0 ) {
-            secondary_config.open( secondary_config_name->c_str( ) );
+        personal.path = ( secondary_config_name != 0 ) ? *secondary_config_name : string( );
+        examine( personal.path, personal.modified, personal.size );
+        if( !personal.path.empty( ) ) {
+            secondary_config.open( personal.path.c_str( ) );
             if( !secondary_config ) return;
-            process_config_file( secondary_config, true );
+            process_config_file( secondary_config, true, working );
         }
     }
 
@@ -219,33 +445,51 @@ namespace spica {
     //! Returns the value associated with the given name.
     /*!
      * The dictionary of (name, value) pairs is searched using a case sensitive comparision on
-     * 'name'. The pointer returned may be invalidated if more items are added to the dictionary
-     * by register_parameter().
+     * 'name'. The pointer returned remains valid as more items are added to the dictionary and
+     * when the files are reread. This refers to the owner's working copy; other threads should
+     * use a snapshot.
      *
      * \param name The name to look up.
      *
      * \return A pointer to the associated value. If there is no value associated with the given
      * name, a NULL pointer is returned. The object pointed at by the return value can be
-     * modified. When that object is looked up again, the new value will be returned.
+     * modified. When that object is looked up again, the new value will be returned. The change
+     * is not seen by other threads until publish() is called.
      */
-    string *lookup_parameter( const char *name )
+    string *Configuration::lookup( const char *name )
     {
-        list< dictionary_entry >::iterator stepper = the_dictionary.begin( );
+        unsigned number;
 
-        while( stepper != the_dictionary.end( ) ) {
-            if( stepper->name == name ) return &stepper->value;
-            stepper++;
-        }
-        return 0;
+        name_lookups.add( );
+        if( !find_name( name, number ) ) return 0;
+        return lookup( parameter_handle( number + 1 ) );
+    }
+
+
+    //! Returns the value of a parameter that has already been resolved.
+    /*!
+     * This is the same as looking the parameter up by name except that no searching is done.
+     *
+     * \param handle A handle returned by resolve_parameter().
+     *
+     * \return A pointer to the associated value or a NULL pointer if the parameter has no value
+     * (or the handle is not valid).
+     */
+    string *Configuration::lookup( parameter_handle handle )
+    {
+        if( !handle.is_valid( ) || handle.id > working.size( ) ) return 0;
+        parameter_value &slot = working[handle.id - 1];
+        return slot.defined ? &slot.value : 0;
     }
 
 
     //! Install a (name, value) pair into the dictionary.
     /*!
      * This function can be used to install program default values into the (name, value)
-     * dictionary before read_config_files() is called. This simplifies the program by allowing
+     * dictionary before read_files() is called. This simplifies the program by allowing
      * places where configuration information is needed to ignore the possibility of default
-     * values.
+     * values. Registered values are remembered and reapplied, under the values from the files,
+     * when the files are reread. The new value is published as a snapshot.
      *  
      * \param name The name to add to the dictionary. The string pointed at by this parameter is
      * copied.
@@ -254,34 +498,18 @@ namespace spica {
      * parameter is copied. If the given name is already in the dictionary, this new value
      * overwrites the old value.
      *
-     * \param personalized Flags this (name, value) entry as a personal entry. The
-     * write_config_file function will write this entry to the personal configuration file.
+     * \param personalized Flags this (name, value) entry as a personal entry. The write_file
+     * function will write this entry to the personal configuration file.
      */
-    void register_parameter(
+    void Configuration::register_parameter(
         const char *name,
         const char *value,
         bool personalized
     )
     {
-        dictionary_entry temp;
-
-        temp.name         = name;
-        temp.value        = value;
-        temp.personalized = personalized;
-
-        list< dictionary_entry >::iterator stepper = the_dictionary.begin( );
-        
-        while( stepper != the_dictionary.end( ) ) {
-            if( stepper->name == name ) {
-                *stepper = temp;
-                break;
-            }
-            stepper++;
-        }
-
-        if( stepper == the_dictionary.end( ) ) {
-            the_dictionary.push_back( temp );
-        }
+        store( registered, name, value, personalized );
+        store( working, name, value, personalized );
+        publish( );
     }
 
 
@@ -292,24 +520,108 @@ namespace spica {
      * name PERSONAL_CONFIGURATION in the dictionary. If no personal configuration file is
      * specified this function has no effect.
      */
-    void write_config_file( )
+    void Configuration::write_file( )
     {
-        string *personal_config_name =
-            lookup_parameter( "PERSONAL_CONFIGURATION" );
+        string *personal_config_name = lookup( "PERSONAL_CONFIGURATION" );
         if( personal_config_name == 0 ) return;
 
         ofstream config_file( personal_config_name->c_str( ) );
         if( !config_file ) return;
 
-        list< dictionary_entry >::iterator stepper;
+        for( dictionary::size_type i = 0; i < working.size( ); ++i ) {
+            if( !working[i].defined || !working[i].personalized ) continue;
+            config_file << name_of( static_cast< unsigned >( i ) ) << "=" << working[i].value << endl;
+        }
+    }
 
-        for( stepper  = the_dictionary.begin( );
-             stepper != the_dictionary.end( );
-             stepper++ ) {
 
-            if( !stepper->personalized ) continue;
-            config_file << stepper->name << "=" << stepper->value << endl;
-        }
+    //! Publishes the working dictionary as a new snapshot.
+    /*!
+     * This is done automatically when the dictionary changes through this class. Call it after
+     * changing values through pointers returned by lookup().
+     */
+    void Configuration::publish( )
+    {
+        shared_ptr< Config_Snapshot > fresh( new Config_Snapshot );
+
+        fresh->values.assign( working.begin( ), working.end( ) );
+        fresh->serial = ++serial;
+        atomic_store( &published, shared_ptr< const Config_Snapshot >( fresh ) );
+    }
+
+
+    //! Returns the most recently published snapshot.
+    /*!
+     * This can be called from any thread. The snapshot stays valid (and unchanged) as long as
+     * the caller holds it, even if newer snapshots are published in the meantime.
+     */
+    shared_ptr< const Config_Snapshot > Configuration::current( ) const
+    {
+        return atomic_load( &published );
+    }
+
+
+    //! Returns the default configuration.
+    /*!
+     * The default configuration is created on first use and deliberately never destroyed.
+     */
+    Configuration &default_configuration( )
+    {
+        static Configuration *the_default = new Configuration;
+        return *the_default;
+    }
+
+
+    //! Reads the master and personal configuration files into the default configuration.
+    void read_config_files( const char *path )
+    {
+        default_configuration( ).read_files( path );
+    }
+
+
+    //! Rereads the default configuration's files if they have changed.
+    bool reload_config_files( )
+    {
+        return default_configuration( ).reload_if_changed( );
+    }
+
+
+    //! Returns the value associated with the given name in the default configuration.
+    string *lookup_parameter( const char *name )
+    {
+        return default_configuration( ).lookup( name );
+    }
+
+
+    //! Returns the value of a resolved parameter in the default configuration.
+    string *lookup_parameter( parameter_handle handle )
+    {
+        return default_configuration( ).lookup( handle );
+    }
+
+
+    //! Install a (name, value) pair into the default configuration.
+    void register_parameter(
+        const char *name,
+        const char *value,
+        bool personalized
+    )
+    {
+        default_configuration( ).register_parameter( name, value, personalized );
+    }
+
+
+    //! Write the personal configuration file of the default configuration.
+    void write_config_file( )
+    {
+        default_configuration( ).write_file( );
+    }
+
+
+    //! Returns the default configuration's current snapshot.
+    shared_ptr< const Config_Snapshot > config_snapshot( )
+    {
+        return default_configuration( ).current( );
     }
 
 } // End of namespace spica.
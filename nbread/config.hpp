@@ -8,17 +8,128 @@ to the application. The application can install default (name, value) pairs into
 and then allow the configuration files to override the defaults as desired. This component can
 also rewrite the lower level (personal) configuration file with updated (name, value) pairs
 making it easy for the application to save an updated configuration.
+
+The dictionary lives in a Configuration object. Several can coexist, and the free functions below
+use a default instance that is never destroyed (so it can't take part in static destruction
+ordering problems). A Configuration is changed only by the thread that owns it, but it publishes
+an immutable Config_Snapshot after every change. Any thread can take the current snapshot and
+read a consistent set of values from it without locking. The owner can reread the configuration
+files when they change and publish the result, so settings can be tuned on a running program.
 */
 
 #ifndef CONFIG_HPP
 #define CONFIG_HPP
 
+#include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace spica {
 
+    class Configuration;
+    class Config_Snapshot;
+
+    //! A pre-resolved parameter name.
+    /*!
+     * Names are interned when they are first seen, and a handle refers to the interned name
+     * directly. Looking up a parameter by handle costs an array index; there is no hashing or
+     * string comparison. Handles remain valid for the life of the program whether or not the
+     * parameter has a value yet. The same handle works with every Configuration.
+     */
+    class parameter_handle {
+    public:
+        parameter_handle( ) : id( 0 ) { }
+        bool is_valid( ) const { return id != 0; }
+
+    private:
+        friend parameter_handle resolve_parameter( const char *name );
+        friend class Configuration;
+        friend class Config_Snapshot;
+        explicit parameter_handle( unsigned i ) : id( i ) { }
+        unsigned id;  // One more than the name's index; zero means no name.
+    };
+
+    parameter_handle resolve_parameter( const char *name );
+    //!< Interns a name (if necessary) and returns its handle.
+
+    //! The value of one parameter.
+    struct parameter_value {
+        std::string value;
+        bool        defined;       // =false if the parameter has no value.
+        bool        personalized;  // =true if it belongs in the personal configuration file.
+
+        parameter_value( ) : defined( false ), personalized( false ) { }
+    };
+
+    //! An unchanging copy of a configuration.
+    /*!
+     * Snapshots are shared between threads with std::shared_ptr. Once published a snapshot is
+     * never modified, so reading it needs no synchronization.
+     */
+    class Config_Snapshot {
+    public:
+        const std::string *lookup( const char *name ) const;
+        const std::string *lookup( parameter_handle handle ) const;
+        unsigned long generation( ) const { return serial; }
+        //!< Increases each time the owner publishes.
+
+    private:
+        friend class Configuration;
+        Config_Snapshot( ) : serial( 0 ) { }
+
+        std::vector< parameter_value > values;  // Indexed by name.
+        unsigned long serial;
+    };
+
+    //! A configuration dictionary and the files it came from.
+    class Configuration {
+    public:
+        Configuration( );
+
+        void read_files( const char *path );
+        bool reload_if_changed( );
+        void write_file( );
+
+        std::string *lookup( const char *name );
+        std::string *lookup( parameter_handle handle );
+        void register_parameter( const char *name, const char *value, bool personalized );
+
+        void publish( );
+        std::shared_ptr< const Config_Snapshot > current( ) const;
+
+    private:
+        typedef std::deque< parameter_value > dictionary;
+
+        struct file_stamp {
+            std::string path;
+            long long   modified;  // Zero if the file could not be examined.
+            long long   size;
+
+            file_stamp( ) : modified( 0 ), size( 0 ) { }
+        };
+
+        dictionary    working;     // Indexed by name. The entries never move.
+        dictionary    registered;  // Values given by register_parameter( ).
+        file_stamp    master;
+        file_stamp    personal;
+        unsigned long serial;
+        std::shared_ptr< const Config_Snapshot > published;
+
+        void load_files( );
+
+        // Configurations can't be copied. Pointers into them are handed out.
+        Configuration( const Configuration & );
+        Configuration &operator=( const Configuration & );
+    };
+
+    Configuration &default_configuration( );
+    //!< The configuration used by the functions below.
+
     void         read_config_files( const char *path );
+    bool         reload_config_files( );
     std::string *lookup_parameter( const char *name );
+    std::string *lookup_parameter( parameter_handle handle );
 
     void register_parameter(
         const char *name,
@@ -27,6 +138,9 @@ namespace spica {
     );
 
     void write_config_file( );
+
+    std::shared_ptr< const Config_Snapshot > config_snapshot( );
+    //!< The default configuration's current snapshot. It can be called from any thread.
 }
 
 #endif
@@ -206,6 +206,10 @@ BOOL CALLBACK Post_Dialog(HWND Dialog_Handle, UINT Message, WPARAM wParam, LPARA
                 GetWindowText(Body_Handle, Body_Text, Body_Size + 1);
                 Notice_File << "\n" << Body_Text << endl;
                 delete [] Body_Text;
+
+                // The poster has obviously read their own notice.
+                Notice_File.close();
+                Current_Topic->Add_Notice(File_Name, History_Database);
               }
               EndDialog(Dialog_Handle, 0);
             }
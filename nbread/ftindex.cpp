@@ -0,0 +1,731 @@
+/****************************************************************************
+FILE          : ftindex.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the full text index.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#if eOPSYS == eWIN32
+#include <windows.h>
+#undef min
+#undef max
+#endif
+
+using namespace std;
+
+#include "ftindex.hpp"
+
+// The layout of the index file. All integers are little endian.
+//
+//   Header      Magic, counts, and the offset of each section below.
+//   Documents   16 bytes each: path (string offset), flags, modification time.
+//   Dictionary  24 bytes each, sorted by term: term (string offset), document count,
+//               last document number, posting list length, posting list offset.
+//   Strings     Null terminated paths and terms.
+//   Postings    For each document: document number delta, term frequency, and then
+//               that many position deltas. All are variable length integers.
+//
+static const char     Index_Magic[8] = { 'N', 'B', 'F', 'T', 'I', 'X', '1', '\0' };
+static const unsigned Header_Size     = 64;
+static const unsigned Document_Size   = 16;
+static const unsigned Dictionary_Size = 24;
+
+static const unsigned Deleted_Flag = 1;
+
+// Words longer than this are not indexed. They are usually encoded data.
+static const size_t Max_WordLength = 40;
+
+// Added to the position between fields so that phrases can't span fields.
+static const unsigned Field_Gap = 100;
+
+//
+// Little endian helpers
+//
+static void Put_U32(vector<unsigned char> &Out, unsigned long Value)
+  {
+    for (int i = 0; i < 4; i++) Out.push_back(static_cast<unsigned char>((Value >> (8 * i)) & 0xFF));
+  }
+
+static void Put_U64(vector<unsigned char> &Out, unsigned long long Value)
+  {
+    for (int i = 0; i < 8; i++) Out.push_back(static_cast<unsigned char>((Value >> (8 * i)) & 0xFF));
+  }
+
+static unsigned long Get_U32(const unsigned char *In)
+  {
+    return
+      static_cast<unsigned long>(In[0])        | (static_cast<unsigned long>(In[1]) <<  8) |
+      (static_cast<unsigned long>(In[2]) << 16) | (static_cast<unsigned long>(In[3]) << 24);
+  }
+
+static unsigned long long Get_U64(const unsigned char *In)
+  {
+    return static_cast<unsigned long long>(Get_U32(In)) |
+      (static_cast<unsigned long long>(Get_U32(In + 4)) << 32);
+  }
+
+
+//
+// Variable length integers
+//
+// Seven bits per byte, low order first. The high bit is set on every byte except the last.
+//
+static void Put_Varint(vector<unsigned char> &Out, unsigned long Value)
+  {
+    while (Value >= 0x80) {
+      Out.push_back(static_cast<unsigned char>((Value & 0x7F) | 0x80));
+      Value >>= 7;
+    }
+    Out.push_back(static_cast<unsigned char>(Value));
+  }
+
+static unsigned long Get_Varint(const unsigned char *&In, const unsigned char *End)
+  {
+    unsigned long Value = 0;
+    int           Shift = 0;
+    while (In < End) {
+      unsigned char Byte = *In++;
+      Value |= static_cast<unsigned long>(Byte & 0x7F) << Shift;
+      if ((Byte & 0x80) == 0) break;
+      Shift += 7;
+    }
+    return Value;
+  }
+
+
+//
+// Tokenize_Text
+//
+// Bytes above 127 are treated as letters so that accented words (in whatever character
+//   set) stay whole. Only ASCII letters are folded.
+//
+void Tokenize_Text(const char *Text, size_t Length, vector<string> &Words)
+  {
+    const char *Stepper = Text;
+    const char *End     = Text + Length;
+
+    while (Stepper < End) {
+      while (Stepper < End && !(isalnum(static_cast<unsigned char>(*Stepper)) || (*Stepper & 0x80)))
+        Stepper++;
+      const char *Start = Stepper;
+      while (Stepper < End &&  (isalnum(static_cast<unsigned char>(*Stepper)) || (*Stepper & 0x80)))
+        Stepper++;
+
+      size_t Word_Length = Stepper - Start;
+      if (Word_Length == 0 || Word_Length > Max_WordLength) continue;
+
+      string Word(Start, Stepper);
+      for (string::iterator p = Word.begin(); p != Word.end(); p++) {
+        if ((*p & 0x80) == 0) *p = static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+      }
+      Words.push_back(Word);
+    }
+  }
+
+
+//
+// Fulltext_Index::Fulltext_Index
+//
+Fulltext_Index::Fulltext_Index() :
+  Dictionary(0), Term_Count(0), Strings(0), Postings(0), Path_IndexValid(false)
+  { }
+
+
+//
+// Fulltext_Index::Clear
+//
+void Fulltext_Index::Clear()
+  {
+    Index_File.Close();
+    Documents.clear();
+    Dictionary = 0;
+    Term_Count = 0;
+    Strings    = 0;
+    Postings   = 0;
+    Pending.clear();
+    Path_Index.clear();
+    Path_IndexValid = false;
+  }
+
+
+//
+// Fulltext_Index::Load
+//
+// Every offset in the file is checked here so that the query code can trust them.
+//
+bool Fulltext_Index::Load(const char *File_Name)
+  {
+    Clear();
+    if (!Index_File.Open(File_Name)) return false;
+
+    const unsigned char *Base = reinterpret_cast<const unsigned char *>(Index_File.Begin());
+    unsigned long long   Size = Index_File.Length();
+
+    if (Size < Header_Size || memcmp(Base, Index_Magic, sizeof(Index_Magic)) != 0) {
+      Clear();
+      return false;
+    }
+
+    unsigned long      Document_Total  = Get_U32(Base +  8);
+    unsigned long      Term_Total      = Get_U32(Base + 12);
+    unsigned long long Document_Offset = Get_U64(Base + 16);
+    unsigned long long Term_Offset     = Get_U64(Base + 24);
+    unsigned long long Strings_Offset  = Get_U64(Base + 32);
+    unsigned long long Strings_Size    = Get_U64(Base + 40);
+    unsigned long long Postings_Offset = Get_U64(Base + 48);
+    unsigned long long Postings_Size   = Get_U64(Base + 56);
+
+    bool Valid =
+      Document_Offset + Document_Total * Document_Size  <= Size &&
+      Term_Offset     + Term_Total * Dictionary_Size    <= Size &&
+      Strings_Offset  + Strings_Size                    <= Size &&
+      Postings_Offset + Postings_Size                   <= Size &&
+      Strings_Size > 0 && Base[Strings_Offset + Strings_Size - 1] == '\0';
+
+    for (unsigned long i = 0; Valid && i < Term_Total; i++) {
+      const unsigned char *Entry = Base + Term_Offset + i * Dictionary_Size;
+      Valid = Get_U32(Entry) < Strings_Size && Get_U64(Entry + 16) + Get_U32(Entry + 12) <= Postings_Size;
+    }
+    if (!Valid) {
+      Clear();
+      return false;
+    }
+
+    Dictionary = Base + Term_Offset;
+    Term_Count = Term_Total;
+    Strings    = reinterpret_cast<const char *>(Base + Strings_Offset);
+    Postings   = Base + Postings_Offset;
+
+    Documents.resize(Document_Total);
+    for (unsigned long i = 0; i < Document_Total; i++) {
+      const unsigned char *Entry = Base + Document_Offset + i * Document_Size;
+      unsigned long Path_Offset = Get_U32(Entry);
+      Documents[i].Path     = (Path_Offset < Strings_Size) ? Strings + Path_Offset : "";
+      Documents[i].Deleted  = (Get_U32(Entry + 4) & Deleted_Flag) != 0;
+      Documents[i].Modified = static_cast<long long>(Get_U64(Entry + 8));
+    }
+    return true;
+  }
+
+
+//
+// Fulltext_Index::Save
+//
+// The new index is written beside the old one and then renamed over it. The old file is
+//   still mapped while the new one is written since its posting lists are copied over.
+//
+bool Fulltext_Index::Save(const char *File_Name)
+  {
+    vector<unsigned char> Document_Table;
+    vector<unsigned char> Term_Table;
+    string                String_Blob;
+
+    // Segments of posting data to be written, in order.
+    vector<pair<const unsigned char *, size_t> > Segments;
+    unsigned long long Postings_Size = 0;
+
+    for (vector<Document>::const_iterator Stepper = Documents.begin(); Stepper != Documents.end(); Stepper++) {
+      Put_U32(Document_Table, static_cast<unsigned long>(String_Blob.size()));
+      Put_U32(Document_Table, Stepper->Deleted ? Deleted_Flag : 0);
+      Put_U64(Document_Table, static_cast<unsigned long long>(Stepper->Modified));
+      String_Blob.append(Stepper->Path.c_str(), Stepper->Path.size() + 1);
+    }
+
+    // Merge the mapped dictionary with the pending terms. Both are sorted.
+    unsigned long New_TermCount = 0;
+    unsigned      Mapped_Index  = 0;
+    map<string, Pending_Postings>::const_iterator Pending_Stepper = Pending.begin();
+
+    while (Mapped_Index < Term_Count || Pending_Stepper != Pending.end()) {
+      const unsigned char *Entry = 0;
+      const char          *Term;
+      int                  Order;
+
+      if (Mapped_Index < Term_Count) Entry = Dictionary + Mapped_Index * Dictionary_Size;
+      if      (Entry == 0)                  Order =  1;
+      else if (Pending_Stepper == Pending.end()) Order = -1;
+      else Order = strcmp(Strings + Get_U32(Entry), Pending_Stepper->first.c_str());
+
+      unsigned long Document_Count = 0;
+      unsigned long Last_Document  = 0;
+      unsigned long Length         = 0;
+
+      if (Order <= 0) {
+        Term           = Strings + Get_U32(Entry);
+        Document_Count = Get_U32(Entry + 4);
+        Last_Document  = Get_U32(Entry + 8);
+        Length         = Get_U32(Entry + 12);
+        Segments.push_back(make_pair(Postings + Get_U64(Entry + 16), static_cast<size_t>(Length)));
+        Mapped_Index++;
+      }
+      if (Order >= 0) {
+        const Pending_Postings &Extra = Pending_Stepper->second;
+        Term            = Pending_Stepper->first.c_str();
+        Document_Count += Extra.Document_Count;
+        Last_Document   = Extra.Last_Document;
+        Length         += static_cast<unsigned long>(Extra.Bytes.size());
+        Segments.push_back(make_pair(&Extra.Bytes[0], Extra.Bytes.size()));
+        Pending_Stepper++;
+      }
+
+      Put_U32(Term_Table, static_cast<unsigned long>(String_Blob.size()));
+      Put_U32(Term_Table, Document_Count);
+      Put_U32(Term_Table, Last_Document);
+      Put_U32(Term_Table, Length);
+      Put_U64(Term_Table, Postings_Size);
+      String_Blob.append(Term, strlen(Term) + 1);
+      Postings_Size += Length;
+      New_TermCount++;
+    }
+    if (String_Blob.empty()) String_Blob.push_back('\0');
+
+    vector<unsigned char> Header(Index_Magic, Index_Magic + sizeof(Index_Magic));
+    unsigned long long Offset = Header_Size;
+    Put_U32(Header, static_cast<unsigned long>(Documents.size()));
+    Put_U32(Header, New_TermCount);
+    Put_U64(Header, Offset);  Offset += Document_Table.size();
+    Put_U64(Header, Offset);  Offset += Term_Table.size();
+    Put_U64(Header, Offset);
+    Put_U64(Header, String_Blob.size());  Offset += String_Blob.size();
+    Put_U64(Header, Offset);
+    Put_U64(Header, Postings_Size);
+
+    string New_Name(File_Name);
+    New_Name.append(".new");
+
+    FILE *Output = fopen(New_Name.c_str(), "wb");
+    if (Output == 0) return false;
+
+    bool Written =
+      fwrite(&Header[0], 1, Header.size(), Output) == Header.size() &&
+      (Document_Table.empty() || fwrite(&Document_Table[0], 1, Document_Table.size(), Output) == Document_Table.size()) &&
+      (Term_Table.empty()     || fwrite(&Term_Table[0], 1, Term_Table.size(), Output) == Term_Table.size()) &&
+      fwrite(String_Blob.data(), 1, String_Blob.size(), Output) == String_Blob.size();
+
+    for (size_t i = 0; Written && i < Segments.size(); i++) {
+      if (Segments[i].second == 0) continue;
+      Written = fwrite(Segments[i].first, 1, Segments[i].second, Output) == Segments[i].second;
+    }
+    if (fclose(Output) != 0) Written = false;
+    if (!Written) {
+      remove(New_Name.c_str());
+      return false;
+    }
+
+    // The old file has to be unmapped before it can be replaced (on Win32 at least).
+    Index_File.Close();
+
+    #if eOPSYS == eWIN32
+    bool Replaced = MoveFileEx(New_Name.c_str(), File_Name, MOVEFILE_REPLACE_EXISTING) != 0;
+    #else
+    bool Replaced = rename(New_Name.c_str(), File_Name) == 0;
+    #endif
+
+    return Replaced && Load(File_Name);
+  }
+
+
+//
+// Fulltext_Index::Add_Document
+//
+int Fulltext_Index::Add_Document(
+  const string &Path,
+  long long     Modified,
+  const char   *Subject,
+  const char   *Poster,
+  const char   *Body,
+  size_t        Body_Length)
+  {
+    int Number = static_cast<int>(Documents.size());
+
+    Document New_Document;
+    New_Document.Path     = Path;
+    New_Document.Modified = Modified;
+    New_Document.Deleted  = false;
+    Documents.push_back(New_Document);
+    if (Path_IndexValid) Path_Index[Path] = Number;
+
+    // Collect the positions of each word in this document.
+    unordered_map<string, vector<unsigned> > Word_Positions;
+    vector<string> Words;
+    unsigned       Position = 0;
+
+    const char *Fields[]        = { Subject, Poster, Body };
+    size_t      Field_Lengths[] = { strlen(Subject), strlen(Poster), Body_Length };
+    for (int Field = 0; Field < 3; Field++) {
+      Words.clear();
+      Tokenize_Text(Fields[Field], Field_Lengths[Field], Words);
+      for (vector<string>::iterator Stepper = Words.begin(); Stepper != Words.end(); Stepper++) {
+        Word_Positions[*Stepper].push_back(Position++);
+      }
+      Position += Field_Gap;
+    }
+
+    // Append a posting to each word's pending list.
+    unordered_map<string, vector<unsigned> >::iterator Stepper;
+    for (Stepper = Word_Positions.begin(); Stepper != Word_Positions.end(); Stepper++) {
+      map<string, Pending_Postings>::iterator Found = Pending.find(Stepper->first);
+      if (Found == Pending.end()) {
+        Pending_Postings Empty;
+        Empty.Last_Document  = 0;
+        Empty.Document_Count = 0;
+
+        // Continue the delta encoding from the end of the existing list.
+        int Index = Find_MappedTerm(Stepper->first);
+        if (Index >= 0) Empty.Last_Document = Get_U32(Dictionary + Index * Dictionary_Size + 8);
+        Found = Pending.insert(make_pair(Stepper->first, Empty)).first;
+      }
+
+      Pending_Postings       &List      = Found->second;
+      const vector<unsigned> &Positions = Stepper->second;
+
+      Put_Varint(List.Bytes, Number - List.Last_Document);
+      Put_Varint(List.Bytes, static_cast<unsigned long>(Positions.size()));
+      unsigned Previous = 0;
+      for (size_t i = 0; i < Positions.size(); i++) {
+        Put_Varint(List.Bytes, Positions[i] - Previous);
+        Previous = Positions[i];
+      }
+      List.Last_Document = Number;
+      List.Document_Count++;
+    }
+    return Number;
+  }
+
+
+//
+// Fulltext_Index::Remove_Document
+//
+void Fulltext_Index::Remove_Document(int Number)
+  {
+    Documents[Number].Deleted = true;
+    if (Path_IndexValid) {
+      unordered_map<string, int>::iterator Found = Path_Index.find(Documents[Number].Path);
+      if (Found != Path_Index.end() && Found->second == Number) Path_Index.erase(Found);
+    }
+  }
+
+
+//
+// Fulltext_Index::Find_Document
+//
+int Fulltext_Index::Find_Document(const string &Path)
+  {
+    if (!Path_IndexValid) {
+      for (int i = 0; i < Document_Count(); i++) {
+        if (!Documents[i].Deleted) Path_Index[Documents[i].Path] = i;
+      }
+      Path_IndexValid = true;
+    }
+    unordered_map<string, int>::iterator Found = Path_Index.find(Path);
+    return (Found == Path_Index.end()) ? -1 : Found->second;
+  }
+
+
+//
+// Fulltext_Index::Find_MappedTerm
+//
+// Binary search of the mapped dictionary. Returns the entry number or -1.
+//
+int Fulltext_Index::Find_MappedTerm(const string &Term) const
+  {
+    unsigned Low  = 0;
+    unsigned High = Term_Count;
+    while (Low < High) {
+      unsigned Middle = Low + (High - Low) / 2;
+      int Order = strcmp(Strings + Get_U32(Dictionary + Middle * Dictionary_Size), Term.c_str());
+      if      (Order < 0) Low  = Middle + 1;
+      else if (Order > 0) High = Middle;
+      else return static_cast<int>(Middle);
+    }
+    return -1;
+  }
+
+
+//
+// Fulltext_Index::Lookup
+//
+bool Fulltext_Index::Lookup(const string &Term, Term_Reference &Reference) const
+  {
+    Reference.Mapped         = 0;
+    Reference.Mapped_Length  = 0;
+    Reference.Document_Count = 0;
+    Reference.Pending        = 0;
+
+    int Index = Find_MappedTerm(Term);
+    if (Index >= 0) {
+      const unsigned char *Entry = Dictionary + Index * Dictionary_Size;
+      Reference.Mapped         = Postings + Get_U64(Entry + 16);
+      Reference.Mapped_Length  = Get_U32(Entry + 12);
+      Reference.Document_Count = Get_U32(Entry + 4);
+    }
+
+    map<string, Pending_Postings>::const_iterator Found = Pending.find(Term);
+    if (Found != Pending.end()) {
+      Reference.Pending         = &Found->second;
+      Reference.Document_Count += Found->second.Document_Count;
+    }
+    return Index >= 0 || Reference.Pending != 0;
+  }
+
+
+//
+// Fulltext_Index::Term_Postings
+//
+// The pending postings continue the delta encoding of the mapped ones so the two parts
+//   are decoded as one list.
+//
+void Fulltext_Index::Term_Postings(const string &Term, Position_List &Result, bool With_Positions) const
+  {
+    Result.Documents.clear();
+    Result.Start.clear();
+    Result.Positions.clear();
+
+    Term_Reference Reference;
+    if (!Lookup(Term, Reference)) {
+      Result.Start.push_back(0);
+      return;
+    }
+    Result.Documents.reserve(Reference.Document_Count);
+
+    const unsigned char *Segment[2][2] = { { Reference.Mapped, Reference.Mapped + Reference.Mapped_Length }, { 0, 0 } };
+    if (Reference.Pending != 0 && !Reference.Pending->Bytes.empty()) {
+      Segment[1][0] = &Reference.Pending->Bytes[0];
+      Segment[1][1] = Segment[1][0] + Reference.Pending->Bytes.size();
+    }
+
+    unsigned long Number = 0;
+    for (int i = 0; i < 2; i++) {
+      const unsigned char *Stepper = Segment[i][0];
+      const unsigned char *End     = Segment[i][1];
+      while (Stepper < End) {
+        Number += Get_Varint(Stepper, End);
+        unsigned long Frequency = Get_Varint(Stepper, End);
+
+        Result.Documents.push_back(Number);
+        Result.Start.push_back(static_cast<unsigned>(Result.Positions.size()));
+        unsigned long Position = 0;
+        for (unsigned long j = 0; j < Frequency; j++) {
+          Position += Get_Varint(Stepper, End);
+          if (With_Positions) Result.Positions.push_back(Position);
+        }
+      }
+    }
+    Result.Start.push_back(static_cast<unsigned>(Result.Positions.size()));
+  }
+
+
+//
+// Fulltext_Index::Phrase_Documents
+//
+// A single word is just its document list. For a longer phrase, documents containing
+//   every word are found first and then the positions are checked.
+//
+void Fulltext_Index::Phrase_Documents(const vector<string> &Terms, vector<unsigned> &Result) const
+  {
+    Result.clear();
+    vector<Position_List> Lists(Terms.size());
+    for (size_t i = 0; i < Terms.size(); i++) {
+      Term_Postings(Terms[i], Lists[i], Terms.size() > 1);
+      if (Lists[i].Documents.empty()) return;
+    }
+    if (Terms.size() == 1) {
+      Result.swap(Lists[0].Documents);
+      return;
+    }
+
+    vector<size_t> Cursor(Terms.size(), 0);
+    for (size_t d = 0; d < Lists[0].Documents.size(); d++) {
+      unsigned Number = Lists[0].Documents[d];
+
+      // Advance every other list to this document.
+      bool In_All = true;
+      for (size_t k = 1; k < Lists.size() && In_All; k++) {
+        const vector<unsigned> &Documents = Lists[k].Documents;
+        while (Cursor[k] < Documents.size() && Documents[Cursor[k]] < Number) Cursor[k]++;
+        if (Cursor[k] == Documents.size()) return;
+        In_All = (Documents[Cursor[k]] == Number);
+      }
+      if (!In_All) continue;
+
+      // Look for a starting position where each following word is at the next position.
+      const unsigned *First     = &Lists[0].Positions[0] + Lists[0].Start[d];
+      const unsigned *First_End = &Lists[0].Positions[0] + Lists[0].Start[d + 1];
+      bool Found = false;
+      for (const unsigned *p = First; p < First_End && !Found; p++) {
+        Found = true;
+        for (size_t k = 1; k < Lists.size() && Found; k++) {
+          const unsigned *Begin = &Lists[k].Positions[0] + Lists[k].Start[Cursor[k]];
+          const unsigned *End   = &Lists[k].Positions[0] + Lists[k].Start[Cursor[k] + 1];
+          Found = binary_search(Begin, End, static_cast<unsigned>(*p + k));
+        }
+      }
+      if (Found) Result.push_back(Number);
+    }
+  }
+
+
+//
+// Fulltext_Index::Search
+//
+// A query is a list of clauses separated by OR. Each clause is a list of items that must
+//   all match (or, for items starting with '-', must not match).
+//
+bool Fulltext_Index::Search(const string &Query, vector<int> &Results, string &Error)
+  {
+    Results.clear();
+    Error.clear();
+
+    vector<unsigned> Query_Result;
+    vector<unsigned> Clause_Result;
+    vector<unsigned> Excluded;
+    bool             Have_Positive = false;
+    bool             Clause_Empty  = true;
+    bool             Any_Clause    = false;
+
+    size_t Index = 0;
+    while (true) {
+
+      // Find the next item (or the end of the query).
+      while (Index < Query.size() && isspace(static_cast<unsigned char>(Query[Index]))) Index++;
+      bool   At_End = (Index == Query.size());
+      bool   Negate = false;
+      string Item;
+
+      if (!At_End) {
+        if (Query[Index] == '-') {
+          Negate = true;
+          Index++;
+        }
+        if (Index < Query.size() && Query[Index] == '"') {
+          size_t Close = Query.find('"', Index + 1);
+          if (Close == string::npos) {
+            Error = "Unterminated phrase";
+            return false;
+          }
+          Item  = Query.substr(Index + 1, Close - Index - 1);
+          Index = Close + 1;
+        }
+        else {
+          size_t Start = Index;
+          while (Index < Query.size() && !isspace(static_cast<unsigned char>(Query[Index]))) Index++;
+          Item = Query.substr(Start, Index - Start);
+
+          if (!Negate && Item == "OR") {
+            if (Clause_Empty) {
+              Error = "OR must be between search terms";
+              return false;
+            }
+          }
+        }
+      }
+
+      // Finish the current clause at OR or at the end of the query.
+      if (At_End || (!Negate && Item == "OR")) {
+        if (Clause_Empty) {
+          if (At_End && Any_Clause) {
+            Error = "OR must be between search terms";
+            return false;
+          }
+          if (At_End) break;
+        }
+        if (!Have_Positive) {
+          Clause_Result.clear();
+          for (int i = 0; i < Document_Count(); i++) Clause_Result.push_back(i);
+        }
+        vector<unsigned> Difference;
+        sort(Excluded.begin(), Excluded.end());
+        set_difference(
+          Clause_Result.begin(), Clause_Result.end(), Excluded.begin(), Excluded.end(), back_inserter(Difference));
+
+        vector<unsigned> Union;
+        set_union(
+          Query_Result.begin(), Query_Result.end(), Difference.begin(), Difference.end(), back_inserter(Union));
+        Query_Result.swap(Union);
+
+        Clause_Result.clear();
+        Excluded.clear();
+        Have_Positive = false;
+        Clause_Empty  = true;
+        Any_Clause    = true;
+        if (At_End) break;
+        continue;
+      }
+
+      vector<string> Words;
+      Tokenize_Text(Item.data(), Item.size(), Words);
+      if (Words.empty()) continue;
+      Clause_Empty = false;
+
+      vector<unsigned> Matches;
+      Phrase_Documents(Words, Matches);
+      if (Negate) {
+        Excluded.insert(Excluded.end(), Matches.begin(), Matches.end());
+      }
+      else if (!Have_Positive) {
+        Clause_Result.swap(Matches);
+        Have_Positive = true;
+      }
+      else {
+        vector<unsigned> Intersection;
+        set_intersection(
+          Clause_Result.begin(), Clause_Result.end(), Matches.begin(), Matches.end(), back_inserter(Intersection));
+        Clause_Result.swap(Intersection);
+      }
+    }
+
+    if (!Any_Clause) {
+      Error = "Nothing to search for";
+      return false;
+    }
+
+    for (vector<unsigned>::iterator Stepper = Query_Result.begin(); Stepper != Query_Result.end(); Stepper++) {
+      if (!Documents[*Stepper].Deleted) Results.push_back(static_cast<int>(*Stepper));
+    }
+
+    // Most recent first. Ties go to the later document.
+    struct Newer {
+      const vector<Document> *Documents;
+      bool operator()(int Left, int Right) const
+        {
+          long long L = (*Documents)[Left].Modified;
+          long long R = (*Documents)[Right].Modified;
+          return L != R ? L > R : Left > Right;
+        }
+    };
+    Newer Order = { &Documents };
+    sort(Results.begin(), Results.end(), Order);
+    return true;
+  }
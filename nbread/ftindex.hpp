@@ -0,0 +1,155 @@
+/****************************************************************************
+FILE          : ftindex.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the full text index.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+A Fulltext_Index maps words to the notices that contain them. The subject,
+poster, and body of each notice are broken into words (runs of letters and
+digits, folded to lower case) and the position of every word is recorded so
+that phrases can be found as well as single words.
+
+The index lives in one file. The file is memory mapped when it is loaded and
+queries only touch the parts of it they need: the term dictionary is sorted
+and searched in place, and only the posting lists of the query terms are
+decoded. Posting lists are delta encoded with variable length integers.
+
+Notices can be added to a loaded index without rebuilding it. Their postings
+are held in memory and appended to the existing lists when the index is
+saved. Removed (or changed) notices are only marked as deleted; their
+postings stay in the file until the index is rebuilt from scratch.
+
+Query syntax:
+
+  word word        Notices containing both words.
+  word OR word     Notices containing either word.
+  -word            Notices not containing the word.
+  "some phrase"    Notices containing the words in that order.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef FTINDEX_H
+#define FTINDEX_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mapfile.hpp"
+
+class Fulltext_Index {
+  public:
+    Fulltext_Index();
+
+    bool Load(const char *File_Name);
+      // Maps an existing index file. Returns false (leaving the index empty) if the file
+      //   doesn't exist or isn't a valid index.
+
+    bool Save(const char *File_Name);
+      // Writes the index, including any added notices, and reloads it from the new
+      //   file. The file is replaced atomically. Returns false if it can't be written.
+
+    int Add_Document(
+      const std::string &Path,
+      long long          Modified,
+      const char        *Subject,
+      const char        *Poster,
+      const char        *Body,
+      std::size_t        Body_Length
+    );
+      // Indexes a notice and returns its document number.
+
+    void Remove_Document(int Document);
+      // Marks a notice as deleted so that queries no longer return it.
+
+    int Find_Document(const std::string &Path);
+      // Returns the document number of a (non-deleted) notice, or -1.
+
+    int                Document_Count() const { return static_cast<int>(Documents.size()); }
+    const std::string &Document_Path(int Document) const { return Documents[Document].Path; }
+    long long          Document_Modified(int Document) const { return Documents[Document].Modified; }
+    bool               Is_Deleted(int Document) const { return Documents[Document].Deleted; }
+
+    bool Search(const std::string &Query, std::vector<int> &Results, std::string &Error);
+      // Evaluates a query. Results are document numbers, most recently modified first.
+      //   Returns false (with a description in Error) if the query is malformed.
+
+  private:
+    struct Document {
+      std::string Path;
+      long long   Modified;
+      bool        Deleted;
+    };
+
+    // Postings for documents added since the index was loaded.
+    struct Pending_Postings {
+      std::vector<unsigned char> Bytes;
+      unsigned                   Last_Document;  // For delta encoding.
+      unsigned                   Document_Count;
+    };
+
+    // Everything known about one term; the mapped and pending parts form one list.
+    struct Term_Reference {
+      const unsigned char    *Mapped;
+      std::size_t             Mapped_Length;
+      unsigned                Document_Count;
+      const Pending_Postings *Pending;
+    };
+
+    // The positions of one term in a set of documents.
+    struct Position_List {
+      std::vector<unsigned> Documents;
+      std::vector<unsigned> Start;      // Start[i] indexes Positions for Documents[i].
+      std::vector<unsigned> Positions;  // Start has one extra entry at the end.
+    };
+
+    Mapped_File                             Index_File;
+    std::vector<Document>                   Documents;
+    const unsigned char                    *Dictionary;   // Points into the mapping.
+    unsigned                                Term_Count;
+    const char                             *Strings;
+    const unsigned char                    *Postings;
+    std::map<std::string, Pending_Postings> Pending;
+    std::unordered_map<std::string, int>    Path_Index;   // Built on first use.
+    bool                                    Path_IndexValid;
+
+    // Fulltext_Indexes can't be copied because Mapped_Files can't be.
+    Fulltext_Index(const Fulltext_Index &);
+    Fulltext_Index &operator=(const Fulltext_Index &);
+
+    void Clear();
+    int  Find_MappedTerm(const std::string &Term) const;
+    bool Lookup(const std::string &Term, Term_Reference &Reference) const;
+    void Term_Postings(const std::string &Term, Position_List &Result, bool With_Positions) const;
+    void Phrase_Documents(const std::vector<std::string> &Terms, std::vector<unsigned> &Result) const;
+};
+
+void Tokenize_Text(const char *Text, std::size_t Length, std::vector<std::string> &Words);
+  // Breaks text into index terms the same way the index does.
+
+#endif
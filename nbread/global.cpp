@@ -52,8 +52,12 @@ int          Minor_Version  = 0;
 int          Configuration_Version = 100;
 NB_Topic    *Current_Topic  = 0;
 NB_Notice   *Current_Notice = 0;
+History     *History_Database = 0;
 spica::String *Full_Name;
 spica::String *Email_Address;
+bool         Threaded_View  = false;
+bool         Wrap_Lines     = false;
+int          Tab_Width      = 8;
 
 //
 // Here are the definitions of the various Win32 global parameters.
@@ -56,12 +56,24 @@ extern NB_Topic *Current_Topic;
 // This points at the object current displayed in the notice window.
 extern NB_Notice *Current_Notice;
 
+// This points at the History object being used to manage read notices.
+extern History *History_Database;
+
 // The user's full name as entered into the configuration dialog.
 extern spica::String *Full_Name;
 
 // The user's email address as entered into the configuration dialog.
 extern spica::String *Email_Address;
 
+// =true if notice lists are arranged in conversation threads rather than by date.
+extern bool Threaded_View;
+
+// =true if long lines are wrapped to the width of the notice window.
+extern bool Wrap_Lines;
+
+// The distance between tab stops in the notice window.
+extern int Tab_Width;
+
 #if eOPSYS != eWIN32
 #error Class Global requires the Win32 operating system!
 #endif
@@ -0,0 +1,183 @@
+/****************************************************************************
+FILE          : header.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the mail header parser.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cctype>
+#include <cstring>
+
+using namespace std;
+
+#include "header.hpp"
+
+//
+// Same_Name
+//
+// Compares a field name with a null terminated name ignoring case. Field names are ASCII
+//   so a simple case fold is enough.
+//
+static bool Same_Name(const Header_Field &Field, const char *Name)
+  {
+    for (int i = 0; i < Field.Name_Length; i++) {
+      if (Name[i] == '\0') return false;
+      if (toupper(static_cast<unsigned char>(Field.Name[i])) != toupper(static_cast<unsigned char>(Name[i])))
+        return false;
+    }
+    return Name[Field.Name_Length] == '\0';
+  }
+
+
+//
+// Line_End
+//
+// Returns a pointer to the newline that ends the line starting at Stepper, or to Limit if
+//   there isn't one.
+//
+static const char *Line_End(const char *Stepper, const char *Limit)
+  {
+    const char *End = static_cast<const char *>(memchr(Stepper, '\n', Limit - Stepper));
+    return (End == 0) ? Limit : End;
+  }
+
+
+//
+// Header_Block::Parse
+//
+// Lines without a colon (for example the "From " line of a mailbox file) are skipped. A
+//   continuation line at the very top, with no field to belong to, is skipped as well.
+//
+const char *Header_Block::Parse(const char *Begin, const char *End)
+  {
+    Fields.clear();
+    Complete   = false;
+    Body_Start = End;
+
+    const char *Stepper = Begin;
+    while (Stepper < End) {
+      const char *Newline  = Line_End(Stepper, End);
+      const char *Line_Top = Stepper;
+      const char *Next     = (Newline == End) ? End : Newline + 1;
+
+      // A blank line (allowing for a carriage return) ends the headers.
+      if (Newline == Stepper || (Newline == Stepper + 1 && *Stepper == '\r')) {
+        Complete   = true;
+        Body_Start = Next;
+        break;
+      }
+      Stepper = Next;
+
+      if (*Line_Top == ' ' || *Line_Top == '\t') continue;
+
+      const char *Colon = static_cast<const char *>(memchr(Line_Top, ':', Newline - Line_Top));
+      if (Colon == 0 || Colon == Line_Top) continue;
+
+      // Field names can't contain white space.
+      const char *Name_End = Colon;
+      while (Name_End > Line_Top && (Name_End[-1] == ' ' || Name_End[-1] == '\t')) Name_End--;
+
+      // Absorb any continuation lines into this field.
+      const char *Value_End = Newline;
+      bool        Folded    = false;
+      while (Stepper < End && (*Stepper == ' ' || *Stepper == '\t')) {
+        Value_End = Line_End(Stepper, End);
+        Stepper   = (Value_End == End) ? End : Value_End + 1;
+        Folded    = true;
+      }
+
+      const char *Value_Start = Colon + 1;
+      while (Value_Start < Value_End && isspace(static_cast<unsigned char>(*Value_Start))) Value_Start++;
+      while (Value_End > Value_Start && isspace(static_cast<unsigned char>(Value_End[-1]))) Value_End--;
+
+      Header_Field Field;
+      Field.Name         = Line_Top;
+      Field.Name_Length  = static_cast<int>(Name_End - Line_Top);
+      Field.Value        = Value_Start;
+      Field.Value_Length = static_cast<int>(Value_End - Value_Start);
+      Field.Folded       = Folded && memchr(Value_Start, '\n', Value_End - Value_Start) != 0;
+      Fields.push_back(Field);
+    }
+    return Body_Start;
+  }
+
+
+//
+// Header_Block::Find
+//
+const Header_Field *Header_Block::Find(const char *Name) const
+  {
+    int Index = Find_Next(Name, 0);
+    return (Index < 0) ? 0 : &Fields[Index];
+  }
+
+
+//
+// Header_Block::Find_Next
+//
+int Header_Block::Find_Next(const char *Name, int Start) const
+  {
+    for (int Index = Start; Index < Count(); Index++) {
+      if (Same_Name(Fields[Index], Name)) return Index;
+    }
+    return -1;
+  }
+
+
+//
+// Header_Block::Unfolded
+//
+// Unfolding just removes the line breaks (RFC 5322 section 2.2.3); the white space that
+//   starts each continuation line is kept.
+//
+string Header_Block::Unfolded(const Header_Field &Field)
+  {
+    const char *Stepper = Field.Value;
+    const char *Limit   = Field.Value + Field.Value_Length;
+    if (!Field.Folded) return string(Stepper, Limit);
+
+    string Result;
+    Result.reserve(Field.Value_Length);
+    while (Stepper < Limit) {
+      if (*Stepper != '\r' && *Stepper != '\n') Result += *Stepper;
+      Stepper++;
+    }
+    return Result;
+  }
+
+
+//
+// Header_Block::Value
+//
+string Header_Block::Value(const char *Name) const
+  {
+    const Header_Field *Field = Find(Name);
+    return (Field == 0) ? string() : Unfolded(*Field);
+  }
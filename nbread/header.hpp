@@ -0,0 +1,90 @@
+/****************************************************************************
+FILE          : header.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the mail header parser.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+A Header_Block parses the header section of a notice (RFC 5322 style) in one
+pass over a buffer. Each field is recorded as a pair of spans pointing into
+the buffer; nothing is copied. The buffer must therefore outlive the
+Header_Block. Parsing stops at the blank line that separates the headers
+from the body.
+
+Folded fields (values continued on lines that start with white space) are
+recorded as a single span that includes the line breaks. Use Unfolded() to
+get the logical value as a string when the field is folded.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef HEADER_H
+#define HEADER_H
+
+#include <string>
+#include <vector>
+
+struct Header_Field {
+  const char *Name;          // Field name, without the colon.
+  int         Name_Length;
+  const char *Value;         // Raw value with surrounding white space removed.
+  int         Value_Length;
+  bool        Folded;        // =true if the value contains line breaks.
+};
+
+class Header_Block {
+  public:
+    Header_Block() : Body_Start(0), Complete(false) { }
+
+    const char *Parse(const char *Begin, const char *End);
+      // Parses the headers in [Begin, End) and returns a pointer to the first byte of
+      //   the body. If no blank line is found, End is returned and Is_Complete() is false
+      //   (in that case the last field might have been cut short).
+
+    bool Is_Complete() const { return Complete; }
+    const char *Body() const { return Body_Start; }
+    int  Count() const { return static_cast<int>(Fields.size()); }
+    const Header_Field &Field(int Index) const { return Fields[Index]; }
+
+    const Header_Field *Find(const char *Name) const;
+      // Returns the first field with the given name (case insensitive) or null.
+
+    int Find_Next(const char *Name, int Start) const;
+      // Returns the index of the next field at or after Start with the given name, or -1.
+      //   Use this for fields that can appear more than once (Received, etc).
+
+    static std::string Unfolded(const Header_Field &Field);
+      // Returns the value of the field with line breaks removed.
+
+    std::string Value(const char *Name) const;
+      // Returns the unfolded value of the named field, or an empty string.
+
+  private:
+    std::vector<Header_Field> Fields;
+    const char *Body_Start;
+    bool        Complete;
+};
+
+#endif
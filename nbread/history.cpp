@@ -38,10 +38,17 @@ Please send comments or bug reports to
 #include <fstream>
 #include <map>
 #include <set>
+#include <string>
+
+#if eOPSYS == ePOSIX
+#include <strings.h>
+#define _stricmp strcasecmp
+#endif
 
 using namespace std;
 
 #include "history.hpp"
+#include "metrics.hpp"
 #include "str.hpp"
 
 // This should really come from the environment or configuration file.
@@ -51,6 +58,10 @@ const char * const History_FileName = "f:\\nbread.hst";
 const char * const History_FileName = "c:\\home\\svn\\VTC\\nbread\\nbread.hst";
 #endif
 
+static spica::metric_counter   History_Lookups("history.lookups");
+static spica::metric_counter   History_Marks("history.marks");
+static spica::metric_histogram History_Load("history.load");
+
 #if eCOMPILER == eMETROWERKS
 
 // I need stricmp() below and this compiler does not supply it.
@@ -117,32 +128,67 @@ struct History::Implementation {
 
   // The read notice database itself.
   str_set Database;
+
+  // Where the database came from (and where it goes back to).
+  string File_Name;
+
+  void Read();
 };
 
 
 //
-// History::History
+// History::Implementation::Read
 //
-// The constructor creates an instance of the implementation.
+// Every filename found in the history file is inserted into the database. A missing file is
+//   just an empty history.
 //
-History::History() : Do_Write(true)
+void History::Implementation::Read()
   {
-    Imp = new Implementation;
-
-    // Now read the history file and insert every filename we find in it
-    //   into the database.
-    //
-    ifstream History_File(History_FileName);
+    spica::metric_timer Timer(History_Load);
+    ifstream History_File(File_Name.c_str());
     if (!History_File) return;
 
     // If the file opened okay, read every line.
     spica::String Line;
     while (History_File >> Line) {
-      Imp->Database.insert(Line);
+      Database.insert(Line);
     }
   }
 
 
+//
+// History::History
+//
+// The constructor creates an instance of the implementation.
+//
+History::History() : Do_Write(true)
+  {
+    Imp = new Implementation;
+    Imp->File_Name = History_FileName;
+    Imp->Read();
+  }
+
+
+//
+// History::History
+//
+History::History(const char *File_Name) : Do_Write(true)
+  {
+    Imp = new Implementation;
+    Imp->File_Name = File_Name;
+    Imp->Read();
+  }
+
+
+//
+// History::Default_FileName
+//
+const char *History::Default_FileName()
+  {
+    return History_FileName;
+  }
+
+
 //
 // History::~History
 //
@@ -153,7 +199,7 @@ History::~History()
     if (Do_Write) {
 
       // Write out the new history file.
-      ofstream History_File(History_FileName);
+      ofstream History_File(Imp->File_Name.c_str());
       if (!History_File) return;
 
       str_set::iterator Stepper;
@@ -186,6 +232,7 @@ void History::Inhibit_Write() const
 //
 bool History::Has_Read(const spica::String &Notice_Path) const
   {
+    History_Lookups.add();
     str_set::iterator Result = Imp->Database.find(Notice_Path);
 
     if (Result == Imp->Database.end()) return false;
@@ -201,6 +248,19 @@ bool History::Has_Read(const spica::String &Notice_Path) const
 //
 void History::Mark_Read(const spica::String &Notice_Path)
   {
+    History_Marks.add();
     Imp->Database.insert(Notice_Path);
   }
 
+
+//
+// History::Visit
+//
+void History::Visit(void (*Visitor)(const spica::String &, void *), void *Data) const
+  {
+    str_set::iterator Stepper;
+    for (Stepper = Imp->Database.begin(); Stepper != Imp->Database.end(); Stepper++) {
+      Visitor(*Stepper, Data);
+    }
+  }
+
@@ -58,7 +58,13 @@ class History {
 
   public:
     History();
-      // Read the history file.
+      // Read the default history file.
+
+    explicit History(const char *File_Name);
+      // Read the named history file. It is also where the history is written back.
+
+    static const char *Default_FileName();
+      // The file used by the default constructor.
 
    ~History();
       // Write the updated history file.
@@ -75,6 +81,10 @@ class History {
     void Mark_Read(const spica::String &);
       // Mark the given notice path (full path required) as a read notice. If
       //   the notice has already been read, there is no effect.
+
+    void Visit(void (*Visitor)(const spica::String &, void *), void *Data) const;
+      // Calls Visitor once for every notice path in the history, passing Data
+      //   along. Used by programs that need to compare paths some other way.
 };
 
 #endif
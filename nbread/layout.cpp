@@ -0,0 +1,268 @@
+/****************************************************************************
+FILE          : layout.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the Text_Layout class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+using namespace std;
+
+#include "layout.hpp"
+
+// The number of wrap widths whose rows are remembered.
+static const size_t Remembered_Widths = 4;
+
+//
+// Text_Layout::Text_Layout
+//
+Text_Layout::Text_Layout() :
+  Body(0), Tab_Size(8), Wrap_Width(0), Widest_Row(0)
+  { }
+
+
+//
+// Text_Layout::Attach
+//
+// Bodies can be evicted from the cache and loaded again between redraws. The weak pointer
+//   tells whether this is still the same object without keeping it alive.
+//
+void Text_Layout::Attach(const shared_ptr<const Notice_Body> &New_Body)
+  {
+    bool Same = !Source.expired() && !Source.owner_before(New_Body) && !New_Body.owner_before(Source);
+    if (!Same) {
+      Source     = New_Body;
+      Indexes.clear();
+      Widest_Row = 0;
+    }
+    Body = New_Body.get();
+    if (Body->Longest_Line() > Widest_Row) Widest_Row = Body->Longest_Line();
+  }
+
+
+//
+// Text_Layout::Set_Format
+//
+// The rows for each width depend on the tab size too, so changing it forgets everything.
+//
+void Text_Layout::Set_Format(int Tab_Width, int New_Width)
+  {
+    if (Tab_Width < 1) Tab_Width = 1;
+    if (New_Width < 0) New_Width = 0;
+    if (Tab_Width != Tab_Size) {
+      Tab_Size = Tab_Width;
+      Indexes.clear();
+      Widest_Row = (Body == 0) ? 0 : Body->Longest_Line();
+    }
+    Wrap_Width = New_Width;
+  }
+
+
+//
+// Text_Layout::Column_After
+//
+// Returns the column reached after displaying [Begin, End) starting at Column.
+//
+int Text_Layout::Column_After(const char *Begin, const char *End, int Column) const
+  {
+    for (; Begin < End; Begin++) {
+      if (*Begin == '\t') Column += Tab_Size - Column % Tab_Size;
+      else Column++;
+    }
+    return Column;
+  }
+
+
+//
+// Text_Layout::Break_Line
+//
+// A row is broken after the last space or tab that fits. A word that is too long for a row
+//   by itself is broken at the width. Tab stops are measured from the start of each row.
+//
+void Text_Layout::Break_Line(const char *Text, int Length, vector<int> &Result) const
+  {
+    Result.clear();
+
+    int Row_Start  = 0;
+    int Last_Break = -1;   // Offset just after the last space in this row.
+    int Column     = 0;
+    for (int i = 0; i < Length; i++) {
+      int Next = (Text[i] == '\t') ? Column + Tab_Size - Column % Tab_Size : Column + 1;
+      if (Next > Wrap_Width && i > Row_Start) {
+        int Break = i;
+        Column    = 0;
+        if (Last_Break > Row_Start) {
+          // Tab stops move with the row, so make sure the carried over text still fits.
+          int Carried = Column_After(Text + Last_Break, Text + i, 0);
+          int Width   = (Text[i] == '\t') ? Carried + Tab_Size - Carried % Tab_Size : Carried + 1;
+          if (Width <= Wrap_Width) {
+            Break  = Last_Break;
+            Column = Carried;
+          }
+        }
+        Result.push_back(Break);
+        Row_Start  = Break;
+        Last_Break = -1;
+        Next       = (Text[i] == '\t') ? Column + Tab_Size - Column % Tab_Size : Column + 1;
+      }
+      Column = Next;
+      if (Text[i] == ' ' || Text[i] == '\t') Last_Break = i + 1;
+    }
+  }
+
+
+//
+// Text_Layout::Starts
+//
+// Finds the row starts of a line at the current width, working them out if this is the
+//   first time the line has been needed at this width.
+//
+const vector<int> &Text_Layout::Starts(int Line)
+  {
+    static const vector<int> Single_Row;
+    if (Wrap_Width <= 0) return Single_Row;
+
+    list<Width_Index>::iterator Index = Indexes.begin();
+    while (Index != Indexes.end() && Index->Width != Wrap_Width) Index++;
+    if (Index == Indexes.end()) {
+      if (Indexes.size() >= Remembered_Widths) Indexes.pop_back();
+      Indexes.push_front(Width_Index());
+      Indexes.front().Width = Wrap_Width;
+    }
+    else if (Index != Indexes.begin()) {
+      Indexes.splice(Indexes.begin(), Indexes, Index);
+    }
+
+    Row_Starts &Lines = Indexes.front().Lines;
+    Row_Starts::iterator Found = Lines.find(Line);
+    if (Found != Lines.end()) return Found->second;
+
+    int         Length;
+    const char *Text = Body->Line(Line, Length);
+    vector<int> &Result = Lines[Line];
+    Break_Line(Text, Length, Result);
+    return Result;
+  }
+
+
+//
+// Text_Layout::Rows
+//
+int Text_Layout::Rows(int Line)
+  {
+    return 1 + static_cast<int>(Starts(Line).size());
+  }
+
+
+//
+// Text_Layout::Row_Text
+//
+int Text_Layout::Row_Text(int Line, int Subrow, string &Text)
+  {
+    Text.clear();
+    if (Body == 0 || Line < 0 || Line >= Line_Count()) return 0;
+
+    int         Length;
+    const char *Line_Text = Body->Line(Line, Length);
+
+    const vector<int> &Row_Start = Starts(Line);
+    if (Subrow < 0 || Subrow > static_cast<int>(Row_Start.size())) return 0;
+    int Begin = (Subrow == 0) ? 0 : Row_Start[Subrow - 1];
+    int End   = (Subrow == static_cast<int>(Row_Start.size())) ? Length : Row_Start[Subrow];
+
+    for (const char *Stepper = Line_Text + Begin; Stepper < Line_Text + End; Stepper++) {
+      if (*Stepper == '\t') Text.append(Tab_Size - Text.size() % Tab_Size, ' ');
+      else Text += *Stepper;
+    }
+
+    int Width = static_cast<int>(Text.size());
+    if (Width > Widest_Row) Widest_Row = Width;
+    return Width;
+  }
+
+
+//
+// Text_Layout::Move
+//
+void Text_Layout::Move(Layout_Anchor &Anchor, int Delta)
+  {
+    int Count = Line_Count();
+    if (Count == 0) {
+      Anchor = Layout_Anchor();
+      return;
+    }
+
+    for (; Delta > 0; Delta--) {
+      if (Anchor.Subrow + 1 < Rows(Anchor.Line)) Anchor.Subrow++;
+      else if (Anchor.Line + 1 < Count) {
+        Anchor.Line++;
+        Anchor.Subrow = 0;
+      }
+      else break;
+    }
+    for (; Delta < 0; Delta++) {
+      if (Anchor.Subrow > 0) Anchor.Subrow--;
+      else if (Anchor.Line > 0) {
+        Anchor.Line--;
+        Anchor.Subrow = Rows(Anchor.Line) - 1;
+      }
+      else break;
+    }
+  }
+
+
+//
+// Text_Layout::Clamp
+//
+// The last possible top of page is found by backing up from the final row, which only
+//   lays out the lines on the last page.
+//
+void Text_Layout::Clamp(Layout_Anchor &Anchor, int Page_Rows)
+  {
+    int Count = Line_Count();
+    if (Page_Rows < 1) Page_Rows = 1;
+    if (Count == 0 || Anchor.Line < 0) {
+      Anchor = Layout_Anchor();
+      return;
+    }
+    if (Anchor.Line >= Count) {
+      Anchor.Line   = Count - 1;
+      Anchor.Subrow = 0;
+    }
+    if (Anchor.Subrow < 0) Anchor.Subrow = 0;
+    if (Anchor.Subrow >= Rows(Anchor.Line)) Anchor.Subrow = Rows(Anchor.Line) - 1;
+
+    Layout_Anchor Last_Top;
+    Last_Top.Line   = Count - 1;
+    Last_Top.Subrow = Rows(Last_Top.Line) - 1;
+    Move(Last_Top, -(Page_Rows - 1));
+
+    if (Anchor.Line > Last_Top.Line ||
+        (Anchor.Line == Last_Top.Line && Anchor.Subrow > Last_Top.Subrow)) Anchor = Last_Top;
+  }
@@ -0,0 +1,117 @@
+/****************************************************************************
+FILE          : layout.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the Text_Layout class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+A Text_Layout turns the lines of a Notice_Body into display rows: tabs are
+expanded to spaces and, if a wrap width is given, long lines are broken
+into several rows (at a space if there is one). Rows are worked out one
+line at a time when they are first needed and then remembered, separately
+for each width, so scrolling and resizing only touch the lines that are
+actually on the screen. A few recently used widths are kept so that going
+back to an earlier window size costs nothing.
+
+Positions are given as a Layout_Anchor (a line and a row within it) rather
+than as an absolute row number. An anchor remains meaningful when the wrap
+width changes without anything above it having to be laid out again.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nbody.hpp"
+
+struct Layout_Anchor {
+  int Line;    // Line of the body, zero based.
+  int Subrow;  // Row within that line, zero based. Always zero when not wrapping.
+
+  Layout_Anchor() : Line(0), Subrow(0) { }
+};
+
+class Text_Layout {
+  public:
+    Text_Layout();
+
+    void Attach(const std::shared_ptr<const Notice_Body> &Body);
+      // Selects the body to lay out. Remembered rows are discarded if it is not the same
+      //   body as last time. The caller must keep the body alive while using the layout.
+
+    void Set_Format(int Tab_Width, int Wrap_Width);
+      // A Wrap_Width of zero (or less) turns wrapping off.
+
+    int Line_Count() const { return (Body == 0) ? 0 : Body->Line_Count(); }
+
+    int Rows(int Line);
+      // Returns the number of display rows used by a line (at least one).
+
+    int Widest() const { return Widest_Row; }
+      // The widest expanded row produced so far, or the body's longest line if that is
+      //   greater. It grows as more of the body is displayed.
+
+    int Row_Text(int Line, int Subrow, std::string &Text);
+      // Puts the expanded text of a display row into Text and returns its width.
+
+    void Move(Layout_Anchor &Anchor, int Delta);
+      // Moves an anchor down (or up if Delta is negative) by the given number of rows,
+      //   stopping at the first and last rows.
+
+    void Clamp(Layout_Anchor &Anchor, int Page_Rows);
+      // Adjusts an anchor, used as the top of a page of the given height, so that it is a
+      //   valid position and the page is full if there are enough rows.
+
+  private:
+    // The rows of one line are given by the offsets at which the second and later rows
+    //   start. Lines that fit on one row have an empty list.
+    //
+    typedef std::unordered_map<int, std::vector<int> > Row_Starts;
+
+    struct Width_Index {
+      int        Width;
+      Row_Starts Lines;
+    };
+
+    std::weak_ptr<const Notice_Body> Source;   // Identifies the body the rows belong to.
+    const Notice_Body               *Body;
+    int                              Tab_Size;
+    int                              Wrap_Width;
+    std::list<Width_Index>           Indexes;  // Most recently used width first.
+    int                              Widest_Row;
+
+    const std::vector<int> &Starts(int Line);
+    void Break_Line(const char *Text, int Length, std::vector<int> &Result) const;
+    int  Column_After(const char *Begin, const char *End, int Column) const;
+};
+
+#endif
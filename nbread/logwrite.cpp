@@ -0,0 +1,391 @@
+/*! \file    logwrite.cpp
+    \brief   Implementation of an asynchronous log file writer.
+    \author  Peter C. Chapin <PChapin@vtc.vsc.edu>
+
+The writer thread sleeps until a batch's worth of text has accumulated, a flush is requested, or
+a short interval has passed. Then it swaps the pending buffer for an empty one and writes what it
+took without holding the lock, so callers are only ever blocked for the time it takes to append
+a line to a string.
+*/
+
+#include "environ.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#if eOPSYS == eWIN32
+#include <windows.h>
+#undef min
+#undef max
+#elif eOPSYS == ePOSIX
+#include <signal.h>
+#else
+#error logwrite.cpp not implemented for this operating system!
+#endif
+
+#include "logwrite.hpp"
+
+namespace spica {
+
+    // The writer thread is woken early when this much text is waiting.
+    const std::size_t batch_size = 64 * 1024;
+
+    // Otherwise it writes whatever has accumulated this often (milliseconds).
+    const int batch_interval = 250;
+
+    // Lines are dropped when this much text is waiting. The disk has fallen too far behind.
+    const std::size_t max_pending = 8 * 1024 * 1024;
+
+    //--------------------------------------------
+    //           Internally Linked Data
+    //--------------------------------------------
+
+    // The writers that are currently open, so they can be flushed when the program ends. A crash
+    // handler can't take locks, so the table is a fixed array of atomic pointers.
+    //
+    const int max_writers = 8;
+    static std::atomic<log_writer *> open_writers[max_writers];
+
+    // Called before the writers are flushed at exit or by the crash handler. See set_drainHook().
+    static std::atomic<void (*)(bool)> drain_hook(0);
+
+    //---------------------------------------------------------
+    //           Internally Linked Support Functions
+    //---------------------------------------------------------
+
+    //
+    // flush_openWriters
+    //
+    // This is registered with atexit() so that lines still in memory when the program exits
+    // normally reach the file. The drain hook goes first; the timers that would otherwise have
+    // passed its text on won't run again.
+    //
+    static void flush_openWriters()
+    {
+        void (*hook)(bool) = drain_hook.load();
+        if (hook != 0) hook(false);
+
+        for (int i = 0; i < max_writers; ++i) {
+            log_writer *writer = open_writers[i].load();
+            if (writer != 0) writer->flush();
+        }
+    }
+
+
+    //
+    // crash_flushWriters
+    //
+    static void crash_flushWriters()
+    {
+        void (*hook)(bool) = drain_hook.load();
+        if (hook != 0) hook(true);
+
+        for (int i = 0; i < max_writers; ++i) {
+            log_writer *writer = open_writers[i].load();
+            if (writer != 0) writer->crash_flush();
+        }
+    }
+
+
+    //
+    // register_writer
+    //
+    static void register_writer(log_writer *writer)
+    {
+        static std::once_flag exit_hook;
+        std::call_once(exit_hook, []() { std::atexit(flush_openWriters); });
+
+        for (int i = 0; i < max_writers; ++i) {
+            log_writer *empty = 0;
+            if (open_writers[i].compare_exchange_strong(empty, writer)) return;
+        }
+    }
+
+
+    //
+    // unregister_writer
+    //
+    static void unregister_writer(log_writer *writer)
+    {
+        for (int i = 0; i < max_writers; ++i) {
+            log_writer *expected = writer;
+            open_writers[i].compare_exchange_strong(expected, 0);
+        }
+    }
+
+
+#if eOPSYS == eWIN32
+    //
+    // crash_filter
+    //
+    static LONG WINAPI crash_filter(EXCEPTION_POINTERS *)
+    {
+        crash_flushWriters();
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+#elif eOPSYS == ePOSIX
+    //
+    // crash_signal
+    //
+    // The handler is installed to run once. After flushing, the signal is raised again so the
+    // program dies the way it would have (with a core dump, if enabled). The flush is not
+    // async-signal-safe (see install_crashHandler() in logwrite.hpp). If the crash happened in
+    // the allocator or in stdio it may hang here; a second fault kills the program outright.
+    //
+    static void crash_signal(int signal_number)
+    {
+        crash_flushWriters();
+        raise(signal_number);
+    }
+#endif
+
+    //--------------------------------------
+    //           log_writer Functions
+    //--------------------------------------
+
+    //
+    // log_writer::log_writer
+    //
+    log_writer::log_writer() :
+        file(0), rotate_size(0), keep(0), file_size(0), queued_bytes(0), written_bytes(0),
+        dropped_lines(0), flush_wanted(false), stopping(false)
+    { }
+
+
+    //
+    // log_writer::~log_writer
+    //
+    log_writer::~log_writer()
+    {
+        close();
+    }
+
+
+    //
+    // log_writer::open
+    //
+    bool log_writer::open(const char *file_path, std::size_t rotate_at, int kept_files)
+    {
+        close();
+
+        file = std::fopen(file_path, "w");
+        if (file == 0) return false;
+
+        path          = file_path;
+        rotate_size   = rotate_at;
+        keep          = kept_files;
+        file_size     = 0;
+        queued_bytes  = 0;
+        written_bytes = 0;
+        worker = std::thread(&log_writer::run, this);
+        register_writer(this);
+        return true;
+    }
+
+
+    //
+    // log_writer::close
+    //
+    void log_writer::close()
+    {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        unregister_writer(this);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (file != 0) std::fclose(file);
+        file     = 0;
+        stopping = false;
+        progress.notify_all();
+    }
+
+
+    //
+    // log_writer::write
+    //
+    // The writer thread is only woken when the pending text first crosses the batch size.
+    // Smaller amounts wait for the interval, so most lines cost no system call at all.
+    //
+    void log_writer::write(const std::string &line)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (file == 0) return;
+
+        if (pending.size() >= max_pending) {
+            ++dropped_lines;
+            return;
+        }
+        std::size_t before = pending.size();
+        pending.append(line);
+        pending.append(1, '\n');
+        queued_bytes += line.size() + 1;
+
+        if (before < batch_size && pending.size() >= batch_size) wake.notify_one();
+    }
+
+
+    //
+    // log_writer::flush
+    //
+    void log_writer::flush()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        if (file == 0) return;
+
+        unsigned long long target = queued_bytes;
+        flush_wanted = true;
+        wake.notify_one();
+        progress.wait(guard, [&]() { return file == 0 || written_bytes >= target; });
+    }
+
+
+    //
+    // log_writer::crash_flush
+    //
+    // If the lock can't be had (the crash happened while it was held, perhaps), the pending
+    // text is lost. Waiting could hang the dying program. Without the lock the file handle
+    // can't be trusted either, since the writer thread might be in the middle of a rotation.
+    //
+    void log_writer::crash_flush()
+    {
+        std::unique_lock<std::mutex> guard(lock, std::try_to_lock);
+        if (!guard.owns_lock() || file == 0) return;
+
+        if (!pending.empty()) {
+            std::fwrite(pending.data(), 1, pending.size(), file);
+            written_bytes += pending.size();
+            pending.clear();
+        }
+        std::fflush(file);
+    }
+
+
+    //
+    // log_writer::crash_write
+    //
+    void log_writer::crash_write(const std::string &line)
+    {
+        std::unique_lock<std::mutex> guard(lock, std::try_to_lock);
+        if (!guard.owns_lock() || file == 0 || pending.size() >= max_pending) return;
+
+        pending.append(line);
+        pending.append(1, '\n');
+        queued_bytes += line.size() + 1;
+    }
+
+
+    //
+    // log_writer::run
+    //
+    // This is the writer thread. It exits once it has been asked to stop and nothing is
+    // pending. Only this thread changes the file handle while it runs (when rotating), so it
+    // can use the handle without the lock; the change itself is made with the lock held.
+    //
+    void log_writer::run()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        std::string batch;
+
+        for (;;) {
+            wake.wait_for(guard, std::chrono::milliseconds(batch_interval), [this]() {
+                return stopping || flush_wanted || pending.size() >= batch_size;
+            });
+            flush_wanted = false;
+
+            if (pending.empty()) {
+                progress.notify_all();
+                if (stopping) break;
+                continue;
+            }
+            batch.swap(pending);
+            guard.unlock();
+
+            if (rotate_size != 0 && file_size > 0 && file_size + batch.size() > rotate_size) {
+                guard.lock();
+                rotate();
+                guard.unlock();
+            }
+            if (file != 0) {
+                std::fwrite(batch.data(), 1, batch.size(), file);
+                std::fflush(file);
+                file_size += batch.size();
+            }
+
+            guard.lock();
+            written_bytes += batch.size();
+            batch.clear();
+            progress.notify_all();
+        }
+    }
+
+
+    //
+    // log_writer::rotate
+    //
+    // Each old file is renamed to the next number, the oldest being removed first so that no
+    // rename has to replace an existing file (which fails on Win32). If the new file can't be
+    // created, nothing more is written. The caller holds the lock, so no other thread uses the
+    // handle while it is closed and replaced. Callers of write() wait for the renames, but
+    // rotations are rare.
+    //
+    void log_writer::rotate()
+    {
+        std::fclose(file);
+
+        char number[16];
+        std::sprintf(number, ".%d", keep);
+        std::remove((path + number).c_str());
+        for (int i = keep - 1; i >= 1; --i) {
+            char older[16];
+            std::sprintf(number, ".%d", i);
+            std::sprintf(older, ".%d", i + 1);
+            std::rename((path + number).c_str(), (path + older).c_str());
+        }
+        if (keep > 0) std::rename(path.c_str(), (path + ".1").c_str());
+
+        file = std::fopen(path.c_str(), "w");
+        file_size = 0;
+    }
+
+
+    //--------------------------------------
+    //           Public Functions
+    //--------------------------------------
+
+    //
+    // set_drainHook
+    //
+    void set_drainHook(void (*hook)(bool crashing))
+    {
+        drain_hook.store(hook);
+    }
+
+
+    //
+    // install_crashHandler
+    //
+    void install_crashHandler()
+    {
+#if eOPSYS == eWIN32
+        SetUnhandledExceptionFilter(crash_filter);
+#elif eOPSYS == ePOSIX
+        const int fatal_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+
+        for (std::size_t i = 0; i < sizeof(fatal_signals) / sizeof(fatal_signals[0]); ++i) {
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_handler = crash_signal;
+            action.sa_flags   = SA_RESETHAND;
+            sigemptyset(&action.sa_mask);
+            sigaction(fatal_signals[i], &action, 0);
+        }
+#endif
+    }
+}
@@ -0,0 +1,109 @@
+/*! \file    logwrite.hpp
+    \brief   Interface to an asynchronous log file writer.
+    \author  Peter C. Chapin <PChapin@vtc.vsc.edu>
+
+A log_writer takes lines from any thread and writes them to a file on a thread of its own. The
+caller only appends the line to a buffer in memory; the writer thread takes the whole buffer at
+once and writes it with a single call, so the cost of the disk is paid once per batch and never
+by the thread that produced the line. If the disk falls far enough behind, new lines are dropped
+(and counted) rather than making the callers wait.
+
+The file can be rotated when it reaches a given size: LOG becomes LOG.1, LOG.1 becomes LOG.2,
+and so on, and a new LOG is started. Lines that have been handed to a writer but not yet written
+are written when the program exits normally, along with anything a drain hook can still hand
+over (such as the messages left in the trace ring). If install_crashHandler() has been called
+they are also written, as far as possible, when the program crashes.
+*/
+
+#ifndef LOGWRITE_H
+#define LOGWRITE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace spica {
+
+    class log_writer {
+    public:
+        log_writer();
+       ~log_writer();
+
+        // Opens (truncating) the log file and starts the writer thread. If rotate_size is not
+        // zero the file is rotated when it would grow beyond that many bytes, and 'keep' old
+        // files are kept. Returns false if the file can't be opened.
+        //
+        bool open(const char *path, std::size_t rotate_size = 0, int keep = 3);
+
+        // Writes everything that is pending, stops the writer thread, and closes the file.
+        void close();
+
+        bool is_open() const
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            return file != 0;
+        }
+
+        // Queues one line. A newline is added.
+        void write(const std::string &line);
+
+        // Waits until every line queued so far has been written to the file.
+        void flush();
+
+        // Writes the pending lines directly, without waiting for the writer thread or for the
+        // lock if someone else holds it. This is meant for crash handlers.
+        //
+        void crash_flush();
+
+        // Queues one line if the lock can be had at once; otherwise the line is lost. This is
+        // meant for drain hooks in a crash, which run just before crash_flush().
+        //
+        void crash_write(const std::string &line);
+
+        unsigned long long dropped() const { return dropped_lines; }
+
+    private:
+        mutable std::mutex      lock;      // Also held while the file is being rotated.
+        std::condition_variable wake;      // Tells the writer thread there is work.
+        std::condition_variable progress;  // Tells flush() a batch was written.
+        std::string             pending;   // Lines waiting for the writer thread.
+        std::thread             worker;
+        std::FILE              *file;
+        std::string             path;
+        std::size_t             rotate_size;
+        int                     keep;
+        std::size_t             file_size;       // Bytes in the current file.
+        unsigned long long      queued_bytes;    // Total handed to the writer.
+        unsigned long long      written_bytes;   // Total written by the writer.
+        unsigned long long      dropped_lines;
+        bool                    flush_wanted;
+        bool                    stopping;
+
+        void run();
+        void rotate();
+
+        // Log writers can't be copied. They own a thread and a file.
+        log_writer(const log_writer &);
+        log_writer &operator=(const log_writer &);
+    };
+
+    // Arranges for every open log_writer to be crash_flush()ed if the program dies from an
+    // unhandled exception (Win32) or a fatal signal (POSIX). This is best effort. On POSIX the
+    // flush runs in the signal handler and uses the heap, stdio, and mutexes, none of which are
+    // async-signal-safe: a crash inside malloc() or stdio can lose the text or hang the program
+    // instead of letting it die.
+    //
+    void install_crashHandler();
+
+    // Registers a function to call before the writers are flushed at exit, or by the crash
+    // handler, so text held elsewhere can be given to a writer first. The argument is true in
+    // the crash handler, where the function must not wait for any lock. Only one hook is kept;
+    // a later call replaces the earlier one.
+    //
+    void set_drainHook(void (*hook)(bool crashing));
+}
+
+#endif
@@ -0,0 +1,149 @@
+/****************************************************************************
+FILE          : mapfile.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the Mapped_File class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#if eOPSYS == eWIN32
+#include <windows.h>
+#undef min
+#undef max
+#elif eOPSYS == ePOSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapfile.hpp"
+
+//
+// Mapped_File::Mapped_File
+//
+Mapped_File::Mapped_File(const char *Path) : Data(0), Size(0), Opened(false)
+  {
+    Open(Path);
+  }
+
+
+//
+// Mapped_File::~Mapped_File
+//
+Mapped_File::~Mapped_File()
+  {
+    Close();
+  }
+
+
+//
+// Mapped_File::Open
+//
+// Neither system allows a zero length mapping. Empty files are treated as open but with no
+//   data. A file that isn't empty but can't be mapped is reported as a failure.
+//
+bool Mapped_File::Open(const char *Path)
+  {
+    std::size_t File_Length = 0;  // The size of the file, whether or not it could be mapped.
+
+    Close();
+
+    #if eOPSYS == eWIN32
+    HANDLE File = CreateFile(
+      Path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (File == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER File_Size;
+    if (!GetFileSizeEx(File, &File_Size)) {
+      CloseHandle(File);
+      return false;
+    }
+    Opened      = true;
+    File_Length = static_cast<std::size_t>(File_Size.QuadPart);
+
+    if (File_Size.QuadPart > 0) {
+      HANDLE Mapping = CreateFileMapping(File, 0, PAGE_READONLY, 0, 0, 0);
+      if (Mapping != 0) {
+        Data = static_cast<const char *>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+        if (Data != 0) Size = static_cast<std::size_t>(File_Size.QuadPart);
+
+        // The view keeps the mapping object alive.
+        CloseHandle(Mapping);
+      }
+    }
+    CloseHandle(File);
+
+    #elif eOPSYS == ePOSIX
+    int File = open(Path, O_RDONLY);
+    if (File == -1) return false;
+
+    struct stat File_Info;
+    if (fstat(File, &File_Info) == -1) {
+      close(File);
+      return false;
+    }
+    Opened      = true;
+    File_Length = static_cast<std::size_t>(File_Info.st_size);
+
+    if (File_Info.st_size > 0) {
+      void *Raw = mmap(0, File_Info.st_size, PROT_READ, MAP_SHARED, File, 0);
+      if (Raw != MAP_FAILED) {
+        Data = static_cast<const char *>(Raw);
+        Size = static_cast<std::size_t>(File_Info.st_size);
+      }
+    }
+    close(File);
+
+    #else
+    #error Mapped_File not implemented for this operating system!
+    #endif
+
+    // If the mapping failed we have an open, but apparently empty, file. Report failure.
+    if (Data == 0 && File_Length != 0) Opened = false;
+    return Opened;
+  }
+
+
+//
+// Mapped_File::Close
+//
+void Mapped_File::Close()
+  {
+    if (Data != 0) {
+      #if eOPSYS == eWIN32
+      UnmapViewOfFile(Data);
+      #elif eOPSYS == ePOSIX
+      munmap(const_cast<char *>(Data), Size);
+      #endif
+    }
+    Data   = 0;
+    Size   = 0;
+    Opened = false;
+  }
@@ -0,0 +1,70 @@
+/****************************************************************************
+FILE          : mapfile.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the Mapped_File class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+A Mapped_File maps an entire file into memory, read only. The contents can
+then be used in place without copying them into the heap. The mapping is
+released when the object is destroyed.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <cstddef>
+
+class Mapped_File {
+  public:
+    Mapped_File() : Data(0), Size(0), Opened(false) { }
+    explicit Mapped_File(const char *Path);
+   ~Mapped_File();
+
+    bool Open(const char *Path);
+      // Maps the named file, releasing any previous mapping. Returns false if the file
+      //   can't be opened. An empty file opens successfully but has no data.
+
+    void Close();
+      // Releases the mapping.
+
+    bool        Is_Open() const { return Opened; }
+    const char *Begin()   const { return Data; }
+    const char *End()     const { return Data + Size; }
+    std::size_t Length()  const { return Size; }
+
+  private:
+    const char  *Data;    // Start of the mapping (null if the file is empty).
+    std::size_t  Size;    // Number of bytes mapped.
+    bool         Opened;  // =true if a file was successfully opened.
+
+    // Mapped_Files can't be copied. They own the mapping.
+    Mapped_File(const Mapped_File &);
+    Mapped_File &operator=(const Mapped_File &);
+};
+
+#endif
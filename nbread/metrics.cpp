@@ -0,0 +1,403 @@
+/*! \file    metrics.cpp
+    \brief   Implementation of a registry of counters and latency histograms.
+    \author  Peter C. Chapin <PChapin@vtc.vsc.edu>
+
+Each thread's values are atomics only so that a snapshot can read them while the thread is
+running. The thread that owns a block is the only one that writes it, so an update is a relaxed
+load and store rather than a locked read-modify-write, and the cache line never moves to another
+processor except when a snapshot is taken. The registry's lock is taken when a metric is
+declared, when a thread makes its first update or ends, and when a snapshot is taken.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+
+#include "metrics.hpp"
+
+namespace spica {
+
+    //--------------------------------------------
+    //           Internally Linked Data
+    //--------------------------------------------
+
+    //
+    // struct value_block
+    //
+    // One thread's values (or the totals of the threads that have ended).
+    //
+    struct value_block {
+        std::atomic<unsigned long long> counters[max_counters];
+        std::atomic<unsigned long long> totals[max_histograms];
+        std::atomic<unsigned long long> buckets[max_histograms][histogram_buckets];
+        value_block *next;
+    };
+
+    //
+    // struct registry
+    //
+    // The names, in the order declared, and the list of live threads' blocks. It is created on
+    // first use (metrics are declared by static constructors in any order) and never destroyed,
+    // since threads may still end after the static destructors have run.
+    //
+    struct registry {
+        std::mutex  lock;
+        const char *counter_names[max_counters];
+        const char *histogram_names[max_histograms];
+        int         counter_count;
+        int         histogram_count;
+        value_block retired;
+        value_block *threads;
+    };
+
+    // This thread's block, or zero before its first update.
+    static thread_local value_block *current_block = 0;
+
+    // =true once this thread's block has been given back. The thread is ending, and updates made
+    // after that (by the destructors of other thread_local objects) are ignored rather than
+    // starting a block that nothing would ever give back.
+    //
+    static thread_local bool thread_exiting = false;
+
+    //---------------------------------------------------------
+    //           Internally Linked Support Functions
+    //---------------------------------------------------------
+
+    //
+    // the_registry
+    //
+    // The registry is value initialized, so every count starts at zero.
+    //
+    static registry &the_registry()
+    {
+        static registry *the_one = new registry();
+        return *the_one;
+    }
+
+
+    //
+    // bump
+    //
+    // Only the owning thread writes a block, so this doesn't need to be atomic as a whole.
+    //
+    inline void bump(std::atomic<unsigned long long> &value, unsigned long long amount)
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+
+    //
+    // fold
+    //
+    // Adds one block's values into another. The caller holds the registry lock.
+    //
+    static void fold(value_block &target, const value_block &source)
+    {
+        for (int i = 0; i < max_counters; ++i)
+            bump(target.counters[i], source.counters[i].load(std::memory_order_relaxed));
+
+        for (int i = 0; i < max_histograms; ++i) {
+            bump(target.totals[i], source.totals[i].load(std::memory_order_relaxed));
+            for (int j = 0; j < histogram_buckets; ++j)
+                bump(target.buckets[i][j], source.buckets[i][j].load(std::memory_order_relaxed));
+        }
+    }
+
+
+    //
+    // struct block_owner
+    //
+    // Gives a thread's block back when the thread ends.
+    //
+    struct block_owner {
+        value_block *block;
+
+       ~block_owner()
+        {
+            if (block == 0) return;
+            registry &the_one = the_registry();
+            std::lock_guard<std::mutex> guard(the_one.lock);
+
+            fold(the_one.retired, *block);
+            for (value_block **link = &the_one.threads; *link != 0; link = &(*link)->next) {
+                if (*link == block) {
+                    *link = block->next;
+                    break;
+                }
+            }
+            delete block;
+            current_block  = 0;
+            thread_exiting = true;
+        }
+    };
+
+
+    //
+    // my_block
+    //
+    static value_block &my_block()
+    {
+        if (current_block != 0) return *current_block;
+
+        static thread_local block_owner owner;
+        value_block *fresh = new value_block();
+
+        registry &the_one = the_registry();
+        std::lock_guard<std::mutex> guard(the_one.lock);
+        fresh->next     = the_one.threads;
+        the_one.threads = fresh;
+        owner.block     = fresh;
+        current_block   = fresh;
+        return *fresh;
+    }
+
+
+    //
+    // declare
+    //
+    // Returns the index of the named metric in the given table, adding it if necessary.
+    //
+    static int declare(const char **names, int &count, int limit, const char *name)
+    {
+        std::lock_guard<std::mutex> guard(the_registry().lock);
+
+        for (int i = 0; i < count; ++i) {
+            if (std::strcmp(names[i], name) == 0) return i;
+        }
+        if (count == limit) return -1;
+        names[count] = name;
+        return count++;
+    }
+
+
+    //
+    // bucket_of
+    //
+    // Returns the position of the highest bit that is set, capped at the last bucket.
+    //
+    static int bucket_of(unsigned long long value)
+    {
+        int bucket = 0;
+        for (int shift = 32; shift != 0; shift /= 2) {
+            if ((value >> shift) != 0) {
+                value  >>= shift;
+                bucket  += shift;
+            }
+        }
+        return (bucket < histogram_buckets) ? bucket : histogram_buckets - 1;
+    }
+
+
+    //
+    // monotonic_time
+    //
+    static unsigned long long monotonic_time()
+    {
+        return static_cast<unsigned long long>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+
+    //
+    // write_jsonString
+    //
+    static void write_jsonString(std::ostream &output, const std::string &text)
+    {
+        output << '"';
+        for (std::string::const_iterator p = text.begin(); p != text.end(); ++p) {
+            if (*p == '"' || *p == '\\') output << '\\';
+            output << *p;
+        }
+        output << '"';
+    }
+
+    //--------------------------------------
+    //           Metric Functions
+    //--------------------------------------
+
+    //
+    // metric_counter::metric_counter
+    //
+    metric_counter::metric_counter(const char *name)
+    {
+        registry &the_one = the_registry();
+        index = declare(the_one.counter_names, the_one.counter_count, max_counters, name);
+    }
+
+
+    //
+    // metric_counter::add
+    //
+    void metric_counter::add(unsigned long long amount)
+    {
+        if (index < 0 || thread_exiting) return;
+        bump(my_block().counters[index], amount);
+    }
+
+
+    //
+    // metric_histogram::metric_histogram
+    //
+    metric_histogram::metric_histogram(const char *name)
+    {
+        registry &the_one = the_registry();
+        index = declare(the_one.histogram_names, the_one.histogram_count, max_histograms, name);
+    }
+
+
+    //
+    // metric_histogram::record
+    //
+    void metric_histogram::record(unsigned long long nanoseconds)
+    {
+        if (index < 0 || thread_exiting) return;
+        value_block &block = my_block();
+        bump(block.totals[index], nanoseconds);
+        bump(block.buckets[index][bucket_of(nanoseconds)], 1);
+    }
+
+
+    //
+    // metric_timer::metric_timer
+    //
+    metric_timer::metric_timer(metric_histogram &target) :
+        histogram(target), start(monotonic_time())
+    { }
+
+
+    //
+    // metric_timer::~metric_timer
+    //
+    metric_timer::~metric_timer()
+    {
+        histogram.record(monotonic_time() - start);
+    }
+
+
+    //
+    // metrics_snapshot::histogram::percentile
+    //
+    // The answer is the top of the bucket that holds the sample at that rank.
+    //
+    unsigned long long metrics_snapshot::histogram::percentile(double fraction) const
+    {
+        if (count == 0) return 0;
+
+        unsigned long long rank = static_cast<unsigned long long>(fraction * count + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > count) rank = count;
+
+        unsigned long long seen = 0;
+        for (int i = 0; i < histogram_buckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) return 2ULL << i;
+        }
+        return 2ULL << (histogram_buckets - 1);
+    }
+
+    //--------------------------------------
+    //           Public Functions
+    //--------------------------------------
+
+    //
+    // collect_metrics
+    //
+    void collect_metrics(metrics_snapshot &snapshot)
+    {
+        registry &the_one = the_registry();
+        std::lock_guard<std::mutex> guard(the_one.lock);
+
+        value_block *sum = new value_block();
+        fold(*sum, the_one.retired);
+        for (value_block *block = the_one.threads; block != 0; block = block->next) {
+            fold(*sum, *block);
+        }
+
+        snapshot.counters.resize(the_one.counter_count);
+        for (int i = 0; i < the_one.counter_count; ++i) {
+            snapshot.counters[i].name  = the_one.counter_names[i];
+            snapshot.counters[i].value = sum->counters[i].load(std::memory_order_relaxed);
+        }
+
+        snapshot.histograms.resize(the_one.histogram_count);
+        for (int i = 0; i < the_one.histogram_count; ++i) {
+            metrics_snapshot::histogram &result = snapshot.histograms[i];
+            result.name  = the_one.histogram_names[i];
+            result.total = sum->totals[i].load(std::memory_order_relaxed);
+            result.count = 0;
+            for (int j = 0; j < histogram_buckets; ++j) {
+                result.buckets[j] = sum->buckets[i][j].load(std::memory_order_relaxed);
+                result.count += result.buckets[j];
+            }
+        }
+        delete sum;
+    }
+
+
+    //
+    // format_metrics
+    //
+    void format_metrics(const metrics_snapshot &snapshot, std::vector<std::string> &lines)
+    {
+        char buffer[160];
+
+        for (std::size_t i = 0; i < snapshot.counters.size(); ++i) {
+            std::sprintf(buffer, " = %llu", snapshot.counters[i].value);
+            lines.push_back(snapshot.counters[i].name + buffer);
+        }
+
+        for (std::size_t i = 0; i < snapshot.histograms.size(); ++i) {
+            const metrics_snapshot::histogram &h = snapshot.histograms[i];
+            double mean = (h.count == 0) ? 0.0 : static_cast<double>(h.total) / h.count;
+            std::sprintf(buffer,
+                ": n=%llu mean=%.1fus p50<%.1fus p90<%.1fus p99<%.1fus",
+                h.count,
+                mean / 1000.0,
+                h.percentile(0.50) / 1000.0,
+                h.percentile(0.90) / 1000.0,
+                h.percentile(0.99) / 1000.0);
+            lines.push_back(h.name + buffer);
+        }
+    }
+
+
+    //
+    // write_metricsJSON
+    //
+    // Trailing empty buckets are left out of each histogram's bucket list.
+    //
+    void write_metricsJSON(const metrics_snapshot &snapshot, std::ostream &output)
+    {
+        output << "{\n\"counters\":{";
+        for (std::size_t i = 0; i < snapshot.counters.size(); ++i) {
+            output << (i == 0 ? "\n" : ",\n");
+            write_jsonString(output, snapshot.counters[i].name);
+            output << ':' << snapshot.counters[i].value;
+        }
+
+        output << "\n},\n\"histograms\":{";
+        for (std::size_t i = 0; i < snapshot.histograms.size(); ++i) {
+            const metrics_snapshot::histogram &h = snapshot.histograms[i];
+            output << (i == 0 ? "\n" : ",\n");
+            write_jsonString(output, h.name);
+            output << ":{\"count\":" << h.count
+                   << ",\"total_ns\":" << h.total
+                   << ",\"p50_ns\":"   << h.percentile(0.50)
+                   << ",\"p90_ns\":"   << h.percentile(0.90)
+                   << ",\"p99_ns\":"   << h.percentile(0.99)
+                   << ",\"buckets\":[";
+
+            int used = histogram_buckets;
+            while (used > 0 && h.buckets[used - 1] == 0) --used;
+            for (int j = 0; j < used; ++j) {
+                output << (j == 0 ? "" : ",") << h.buckets[j];
+            }
+            output << "]}";
+        }
+        output << "\n}\n}\n";
+    }
+}
@@ -0,0 +1,116 @@
+/*! \file    metrics.hpp
+    \brief   Interface to a registry of counters and latency histograms.
+    \author  Peter C. Chapin <PChapin@vtc.vsc.edu>
+
+Subsystems declare their metrics as objects at namespace scope, each with a name such as
+"history.lookups". The same name may be declared in several files; they all refer to the same
+metric. Updating a metric takes no locks and touches no memory shared with other threads: each
+thread has its own block of values, and the blocks are only added together when someone asks for
+a snapshot. When a thread ends its values are folded into a block of totals, so nothing counted
+is ever lost.
+
+Histograms record durations in nanoseconds into fixed buckets by powers of two. Bucket i holds
+the values from 2^i up to (but not including) 2^(i+1); bucket zero also holds zero. This is
+coarse, but it needs no configuration, costs one bit scan per sample, and is good enough to tell
+a microsecond from a millisecond.
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace spica {
+
+    // The most metrics of each kind. Metrics declared after the table is full are ignored.
+    const int max_counters   = 128;
+    const int max_histograms = 32;
+
+    // Bucket 47 starts at about 39 hours; anything longer is counted there too.
+    const int histogram_buckets = 48;
+
+    //
+    // class metric_counter
+    //
+    // A count of events or of quantities such as bytes. The name must be a string literal (or
+    // otherwise live forever) because only the pointer is kept.
+    //
+    class metric_counter {
+    public:
+        explicit metric_counter(const char *name);
+        void add(unsigned long long amount = 1);
+
+    private:
+        int index;  // Negative if the table was full.
+    };
+
+    //
+    // class metric_histogram
+    //
+    class metric_histogram {
+    public:
+        explicit metric_histogram(const char *name);
+        void record(unsigned long long nanoseconds);
+
+    private:
+        int index;
+    };
+
+    //
+    // class metric_timer
+    //
+    // Records the time from its construction to its destruction in a histogram.
+    //
+    class metric_timer {
+    public:
+        explicit metric_timer(metric_histogram &target);
+       ~metric_timer();
+
+    private:
+        metric_histogram  &histogram;
+        unsigned long long start;
+
+        // Timers can't be copied. Each one is recorded once.
+        metric_timer(const metric_timer &);
+        metric_timer &operator=(const metric_timer &);
+    };
+
+    //
+    // struct metrics_snapshot
+    //
+    // The totals over all threads at one moment. Metrics are in the order they were declared.
+    //
+    struct metrics_snapshot {
+        struct counter {
+            std::string        name;
+            unsigned long long value;
+        };
+
+        struct histogram {
+            std::string        name;
+            unsigned long long count;
+            unsigned long long total;  // Sum of all samples, in nanoseconds.
+            unsigned long long buckets[histogram_buckets];
+
+            // Returns an upper bound on the given fraction (0.0 to 1.0) of the samples.
+            unsigned long long percentile(double fraction) const;
+        };
+
+        std::vector<counter>   counters;
+        std::vector<histogram> histograms;
+    };
+
+    // Adds up every thread's values.
+    void collect_metrics(metrics_snapshot &snapshot);
+
+    // Formats a snapshot as lines of text for display or logging. Times are in microseconds.
+    void format_metrics(const metrics_snapshot &snapshot, std::vector<std::string> &lines);
+
+    // Writes a snapshot as a JSON object. Times are in nanoseconds.
+    void write_metricsJSON(const metrics_snapshot &snapshot, std::ostream &output);
+}
+
+#endif
@@ -0,0 +1,522 @@
+/****************************************************************************
+FILE          : mime.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the MIME parser and transfer decoders.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cctype>
+#include <cstring>
+
+using namespace std;
+
+#include "mime.hpp"
+
+//
+// Lower_Trimmed
+//
+// Returns a copy of Text without surrounding white space and in lower case.
+//
+static string Lower_Trimmed(const string &Text)
+  {
+    string::size_type First = 0;
+    string::size_type Last  = Text.size();
+    while (First < Last && isspace(static_cast<unsigned char>(Text[First])))    First++;
+    while (Last > First && isspace(static_cast<unsigned char>(Text[Last - 1]))) Last--;
+
+    string Result;
+    for (string::size_type i = First; i < Last; i++) {
+      Result += static_cast<char>(tolower(static_cast<unsigned char>(Text[i])));
+    }
+    return Result;
+  }
+
+
+//
+// Mime_MediaType
+//
+string Mime_MediaType(const string &Content_Type)
+  {
+    string Result = Lower_Trimmed(Content_Type.substr(0, Content_Type.find(';')));
+    if (Result.empty()) Result = "text/plain";
+    return Result;
+  }
+
+
+//
+// Mime_Parameter
+//
+// Parameters follow the media type (or disposition) as a list of name=value pairs separated
+//   by semicolons. A value is either a token or a quoted string. RFC 2231 continuations
+//   and character sets are not supported.
+//
+string Mime_Parameter(const string &Value, const char *Name)
+  {
+    string::size_type Stepper = Value.find(';');
+    while (Stepper != string::npos && Stepper < Value.size()) {
+      Stepper++;
+      while (Stepper < Value.size() && isspace(static_cast<unsigned char>(Value[Stepper]))) Stepper++;
+
+      string::size_type Equals = Value.find_first_of("=;", Stepper);
+      if (Equals == string::npos || Value[Equals] == ';') {
+        Stepper = Equals;
+        continue;
+      }
+      bool Wanted = (Lower_Trimmed(Value.substr(Stepper, Equals - Stepper)) == Lower_Trimmed(Name));
+
+      string Result;
+      Stepper = Equals + 1;
+      while (Stepper < Value.size() && isspace(static_cast<unsigned char>(Value[Stepper]))) Stepper++;
+      if (Stepper < Value.size() && Value[Stepper] == '"') {
+        for (Stepper++; Stepper < Value.size() && Value[Stepper] != '"'; Stepper++) {
+          if (Value[Stepper] == '\\' && Stepper + 1 < Value.size()) Stepper++;
+          Result += Value[Stepper];
+        }
+        Stepper = Value.find(';', Stepper);
+      }
+      else {
+        string::size_type End = Value.find(';', Stepper);
+        Result  = Value.substr(Stepper, (End == string::npos) ? string::npos : End - Stepper);
+        Stepper = End;
+        while (!Result.empty() && isspace(static_cast<unsigned char>(Result[Result.size() - 1]))) {
+          Result.erase(Result.size() - 1);
+        }
+      }
+      if (Wanted) return Result;
+    }
+    return string();
+  }
+
+
+//
+// Describe_Part
+//
+// Fills in the type information of a part whose headers have already been parsed.
+//
+static void Describe_Part(Mime_Part &Part)
+  {
+    string Content_Type = Part.Headers.Value("Content-Type");
+
+    Part.Media_Type = Mime_MediaType(Content_Type);
+    Part.Encoding   = Lower_Trimmed(Part.Headers.Value("Content-Transfer-Encoding"));
+    if (Part.Encoding.empty()) Part.Encoding = "7bit";
+
+    Part.File_Name = Mime_Parameter(Part.Headers.Value("Content-Disposition"), "filename");
+    if (Part.File_Name.empty()) Part.File_Name = Mime_Parameter(Content_Type, "name");
+  }
+
+
+//
+// Mime_Reader::Single_Part
+//
+void Mime_Reader::Single_Part(
+  const Header_Block &Message_Headers, const char *Body, const char *End, Mime_Part &Part)
+  {
+    Part.Headers     = Message_Headers;
+    Part.Content     = Body;
+    Part.Content_End = End;
+    Part.Depth       = 0;
+    Describe_Part(Part);
+  }
+
+
+//
+// Mime_Reader::Open
+//
+bool Mime_Reader::Open(const Header_Block &Message_Headers, const char *Body, const char *End)
+  {
+    Levels.clear();
+    Position = Body;
+    Limit    = End;
+
+    string Content_Type = Message_Headers.Value("Content-Type");
+    if (Mime_MediaType(Content_Type).compare(0, 10, "multipart/") != 0) return false;
+
+    string Boundary = Mime_Parameter(Content_Type, "boundary");
+    if (Boundary.empty()) return false;
+
+    Level Outer;
+    Outer.Delimiter = "--" + Boundary;
+    Outer.Started   = false;
+    Outer.Finished  = false;
+    Levels.push_back(Outer);
+    return true;
+  }
+
+
+//
+// Mime_Reader::Find_Delimiter
+//
+// Looks for the next line, at or after Start, that is a delimiter of any open multipart.
+//   Inner multiparts are checked first since their boundaries may extend an outer one.
+//   Returns the start of the delimiter line (or null) and sets After to the start of the
+//   following line. Only one pass is made over the content no matter how deeply the
+//   multiparts are nested.
+//
+const char *Mime_Reader::Find_Delimiter(const char *Start, const char *&After, bool &Closing, int &Which)
+  {
+    const char *Line = Start;
+    while (Line < Limit) {
+      const char *Newline   = static_cast<const char *>(memchr(Line, '\n', Limit - Line));
+      const char *Line_Stop = (Newline == 0) ? Limit : Newline;
+
+      if (Line_Stop - Line >= 2 && Line[0] == '-' && Line[1] == '-') {
+        for (int i = static_cast<int>(Levels.size()) - 1; i >= 0; i--) {
+          const string &Delimiter = Levels[i].Delimiter;
+          size_t        Length    = Delimiter.size();
+          if (static_cast<size_t>(Line_Stop - Line) < Length) continue;
+          if (memcmp(Line, Delimiter.data(), Length) != 0) continue;
+
+          // The delimiter may be followed by "--" and then only white space.
+          const char *Rest = Line + Length;
+          bool Is_Closing  = (Line_Stop - Rest >= 2 && Rest[0] == '-' && Rest[1] == '-');
+          if (Is_Closing) Rest += 2;
+          while (Rest < Line_Stop && isspace(static_cast<unsigned char>(*Rest))) Rest++;
+          if (Rest != Line_Stop) continue;
+
+          After   = (Newline == 0) ? Limit : Newline + 1;
+          Closing = Is_Closing;
+          Which   = i;
+          return Line;
+        }
+      }
+      if (Newline == 0) break;
+      Line = Newline + 1;
+    }
+    return 0;
+  }
+
+
+//
+// Mime_Reader::Next_Part
+//
+// Position is always at the start of a line. Each multipart level begins in its preamble
+//   and ends in its epilogue, both of which are skipped. A delimiter belonging to an outer
+//   level closes any inner levels that were left open by a malformed message.
+//
+bool Mime_Reader::Next_Part(Mime_Part &Part)
+  {
+    while (!Levels.empty()) {
+      const char *After;
+      bool        Closing;
+      int         Which;
+
+      // Skip a preamble or an epilogue.
+      if (!Levels.back().Started || Levels.back().Finished) {
+        if (Levels.back().Finished) Levels.pop_back();
+        if (Levels.empty()) break;
+
+        if (Find_Delimiter(Position, After, Closing, Which) == 0) break;
+        Levels.resize(Which + 1);
+        Levels.back().Started  = true;
+        Levels.back().Finished = Closing;
+        Position = After;
+        continue;
+      }
+
+      // Position is at the start of a part. Read its headers first; a nested multipart is
+      //   entered without looking for its end.
+      //
+      Part.Headers.Parse(Position, Limit);
+      Describe_Part(Part);
+
+      string Boundary = Mime_Parameter(Part.Headers.Value("Content-Type"), "boundary");
+      if (Part.Media_Type.compare(0, 10, "multipart/") == 0 && !Boundary.empty()) {
+        Level Inner;
+        Inner.Delimiter = "--" + Boundary;
+        Inner.Started   = false;
+        Inner.Finished  = false;
+        Levels.push_back(Inner);
+        Position = Part.Headers.Body();
+        continue;
+      }
+
+      // The line break before a delimiter belongs to the delimiter, not the content.
+      const char *Delimiter = Find_Delimiter(Position, After, Closing, Which);
+      const char *Part_End  = (Delimiter == 0) ? Limit : Delimiter;
+      if (Delimiter != 0) {
+        if (Part_End > Position && Part_End[-1] == '\n') Part_End--;
+        if (Part_End > Position && Part_End[-1] == '\r') Part_End--;
+      }
+
+      Part.Content     = (Part.Headers.Body() < Part_End) ? Part.Headers.Body() : Part_End;
+      Part.Content_End = Part_End;
+      Part.Depth       = static_cast<int>(Levels.size());
+
+      if (Delimiter == 0) {
+        Levels.clear();
+        Position = Limit;
+      }
+      else {
+        Levels.resize(Which + 1);
+        Levels.back().Finished = Closing;
+        Position = After;
+      }
+      return true;
+    }
+
+    Levels.clear();
+    return false;
+  }
+
+
+// ============================
+// Transfer Decoding
+// ============================
+
+// Values of base64 characters. Characters that are not part of the alphabet (line breaks,
+//   for example) have the high bit set and '=' has the value Base64_Pad.
+//
+static const unsigned char Base64_Pad    = 0x40;
+static const unsigned char Base64_Ignore = 0x80;
+
+struct Base64_Table {
+  unsigned char Value[256];
+
+  Base64_Table()
+    {
+      static const char Alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+      memset(Value, Base64_Ignore, sizeof(Value));
+      for (int i = 0; i < 64; i++) Value[static_cast<unsigned char>(Alphabet[i])] = static_cast<unsigned char>(i);
+      Value[static_cast<unsigned char>('=')] = Base64_Pad;
+    }
+};
+
+//
+// Base64_Values
+//
+// The table is built on first use. Notices are decoded on the prefetch thread as well as the
+//   user interface thread; the initialization of a local static is thread safe.
+//
+static const unsigned char *Base64_Values()
+  {
+    static const Base64_Table Table;
+    return Table.Value;
+  }
+
+
+//
+// Hex_Value
+//
+static int Hex_Value(char Digit)
+  {
+    if (Digit >= '0' && Digit <= '9') return Digit - '0';
+    if (Digit >= 'A' && Digit <= 'F') return Digit - 'A' + 10;
+    if (Digit >= 'a' && Digit <= 'f') return Digit - 'a' + 10;
+    return -1;
+  }
+
+
+//
+// Transfer_Decoder::Transfer_Decoder
+//
+// Anything other than base64 and quoted printable (7bit, 8bit, binary, or something
+//   unknown) is passed through unchanged.
+//
+Transfer_Decoder::Transfer_Decoder(const string &Encoding) :
+  Method(Identity), Bits(0), Bit_Count(0)
+  {
+    string Name = Lower_Trimmed(Encoding);
+    if      (Name == "base64")           Method = Base64;
+    else if (Name == "quoted-printable") Method = Quoted_Printable;
+  }
+
+
+//
+// Transfer_Decoder::Decode
+//
+void Transfer_Decoder::Decode(const char *Begin, const char *End, string &Output)
+  {
+    switch (Method) {
+      case Identity:         Output.append(Begin, End);               break;
+      case Base64:           Decode_Base64(Begin, End, Output);          break;
+      case Quoted_Printable: Decode_QuotedPrintable(Begin, End, Output); break;
+    }
+  }
+
+
+//
+// Transfer_Decoder::Finish
+//
+void Transfer_Decoder::Finish(string &Output)
+  {
+    if (Method == Base64) {
+      if (Bit_Count == 2) Output += static_cast<char>(Bits >> 4);
+      if (Bit_Count == 3) {
+        Output += static_cast<char>(Bits >> 10);
+        Output += static_cast<char>(Bits >> 2);
+      }
+    }
+    Output.append(Pending);
+    Bits      = 0;
+    Bit_Count = 0;
+    Pending.clear();
+  }
+
+
+//
+// Transfer_Decoder::Decode_Base64
+//
+// The fast path decodes four characters at a time. The four table values are combined so
+//   that a single test tells whether any of them is a line break, padding, or junk; only
+//   then is the slow path, which takes one character at a time, used. Base64 lines are
+//   normally 76 characters, so most of the work is done by the fast path. The output is
+//   written through a pointer into space reserved ahead of time.
+//
+void Transfer_Decoder::Decode_Base64(const char *Begin, const char *End, string &Output)
+  {
+    size_t Start = Output.size();
+    Output.resize(Start + (End - Begin) / 4 * 3 + 3);
+    char *Out = &Output[0] + Start;
+
+    const unsigned char *Base64_Value = Base64_Values();
+    const unsigned char *Stepper      = reinterpret_cast<const unsigned char *>(Begin);
+    const unsigned char *Limit   = reinterpret_cast<const unsigned char *>(End);
+
+    while (Stepper < Limit) {
+      if (Bit_Count == 0) {
+        while (Limit - Stepper >= 4) {
+          unsigned long A = Base64_Value[Stepper[0]];
+          unsigned long B = Base64_Value[Stepper[1]];
+          unsigned long C = Base64_Value[Stepper[2]];
+          unsigned long D = Base64_Value[Stepper[3]];
+          if (((A | B | C | D) & (Base64_Pad | Base64_Ignore)) != 0) break;
+
+          unsigned long Group = (A << 18) | (B << 12) | (C << 6) | D;
+          Out[0] = static_cast<char>(Group >> 16);
+          Out[1] = static_cast<char>(Group >>  8);
+          Out[2] = static_cast<char>(Group);
+          Out     += 3;
+          Stepper += 4;
+        }
+        if (Stepper == Limit) break;
+      }
+
+      unsigned char Value = Base64_Value[*Stepper++];
+      if (Value < 64) {
+        Bits = (Bits << 6) | Value;
+        if (++Bit_Count == 4) {
+          Out[0] = static_cast<char>(Bits >> 16);
+          Out[1] = static_cast<char>(Bits >>  8);
+          Out[2] = static_cast<char>(Bits);
+          Out      += 3;
+          Bits      = 0;
+          Bit_Count = 0;
+        }
+      }
+      else if (Value == Base64_Pad) {
+        // Padding ends a group early. Further padding characters are ignored.
+        if (Bit_Count == 2) *Out++ = static_cast<char>(Bits >> 4);
+        if (Bit_Count == 3) {
+          Out[0] = static_cast<char>(Bits >> 10);
+          Out[1] = static_cast<char>(Bits >> 2);
+          Out += 2;
+        }
+        Bits      = 0;
+        Bit_Count = 0;
+      }
+    }
+    Output.resize(Out - &Output[0]);
+  }
+
+
+//
+// Run_QuotedPrintable
+//
+// Decodes as much of [Begin, End) as possible and returns a pointer to an escape that is
+//   cut off by the end of the text (or End). Text between escapes is copied in bulk; memchr
+//   finds the next '=' a word (or vector) at a time.
+//
+static const char *Run_QuotedPrintable(const char *Begin, const char *End, string &Output)
+  {
+    const char *Stepper = Begin;
+    while (Stepper < End) {
+      const char *Escape = static_cast<const char *>(memchr(Stepper, '=', End - Stepper));
+      if (Escape == 0) {
+        Output.append(Stepper, End);
+        return End;
+      }
+      Output.append(Stepper, Escape);
+
+      // A soft line break is '=' at the end of a line, possibly followed by white space.
+      const char *Next = Escape + 1;
+      while (Next < End && (*Next == ' ' || *Next == '\t')) Next++;
+      if (Next == End || (*Next == '\r' && Next + 1 == End)) return Escape;
+      if (*Next == '\n' || *Next == '\r') {
+        Stepper = Next + 1;
+        if (*Next == '\r' && *Stepper == '\n') Stepper++;
+        continue;
+      }
+
+      // Otherwise it should be a hexadecimal escape. Malformed escapes are kept as is.
+      if (Next != Escape + 1) {
+        Output.append(Escape, Next);
+        Stepper = Next;
+        continue;
+      }
+      if (End - Escape < 3) return Escape;
+
+      int High = Hex_Value(Escape[1]);
+      int Low  = Hex_Value(Escape[2]);
+      if (High >= 0 && Low >= 0) {
+        Output += static_cast<char>(High * 16 + Low);
+        Stepper = Escape + 3;
+      }
+      else {
+        Output += '=';
+        Stepper = Escape + 1;
+      }
+    }
+    return End;
+  }
+
+
+//
+// Transfer_Decoder::Decode_QuotedPrintable
+//
+// An escape that was cut off at the end of the previous piece is completed first, one
+//   character at a time (it never needs more than a few).
+//
+void Transfer_Decoder::Decode_QuotedPrintable(const char *Begin, const char *End, string &Output)
+  {
+    while (!Pending.empty() && Begin < End) {
+      string Held;
+      Held.swap(Pending);
+      Held += *Begin++;
+
+      const char *Held_End = Held.data() + Held.size();
+      Pending.assign(Run_QuotedPrintable(Held.data(), Held_End, Output), Held_End);
+    }
+    if (!Pending.empty()) return;
+
+    Pending.assign(Run_QuotedPrintable(Begin, End, Output), End);
+  }
@@ -0,0 +1,128 @@
+/****************************************************************************
+FILE          : mime.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the MIME parser and transfer decoders.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+These classes take apart MIME notices (RFC 2045 and 2046) in place. A
+Mime_Reader walks a multipart body one part at a time, finding each
+boundary with a single forward scan, and nested multiparts are entered as
+they are met. A Mime_Part only records where its headers and content are
+in the caller's buffer (typically a Mapped_File) along with its type and
+transfer encoding; nothing is copied or decoded until the caller asks.
+That way a notice with a large attachment can be listed quickly and the
+attachment is only decoded if somebody wants it.
+
+The Transfer_Decoder handles base64 and quoted-printable. It can be fed
+the content in pieces of any size and keeps whatever partial group is left
+over between calls.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef MIME_H
+#define MIME_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "header.hpp"
+
+std::string Mime_MediaType(const std::string &Content_Type);
+  // Returns the "type/subtype" part of a Content-Type value in lower case. An empty value
+  //   gives "text/plain", the RFC 2045 default.
+
+std::string Mime_Parameter(const std::string &Value, const char *Name);
+  // Returns the value of the named parameter (case insensitive) in a structured header
+  //   value such as Content-Type or Content-Disposition. Quotes are removed.
+
+struct Mime_Part {
+  Header_Block Headers;       // Points into the caller's buffer.
+  const char  *Content;       // Encoded content, after the part's headers.
+  const char  *Content_End;
+  std::string  Media_Type;    // Lower case "type/subtype".
+  std::string  Encoding;      // Lower case Content-Transfer-Encoding ("7bit" if none).
+  std::string  File_Name;     // From Content-Disposition or Content-Type, if given.
+  int          Depth;         // Nesting level; parts of the outermost multipart are 1.
+
+  bool Is_Text() const { return Media_Type.compare(0, 5, "text/") == 0; }
+  std::size_t Encoded_Size() const { return static_cast<std::size_t>(Content_End - Content); }
+};
+
+class Mime_Reader {
+  public:
+    Mime_Reader() : Position(0), Limit(0) { }
+
+    bool Open(const Header_Block &Message_Headers, const char *Body, const char *End);
+      // Prepares to read the parts of a message body. Returns false if the message is not
+      //   multipart. In that case the body is a single part; see Single_Part().
+
+    bool Next_Part(Mime_Part &Part);
+      // Finds the next leaf part (multipart containers are entered, not returned). Returns
+      //   false when there are no more parts.
+
+    static void Single_Part(
+      const Header_Block &Message_Headers, const char *Body, const char *End, Mime_Part &Part);
+      // Describes a body that is not multipart as one part.
+
+  private:
+    struct Level {
+      std::string Delimiter;      // "--" followed by the boundary.
+      bool        Started;        // =true once the preamble has been skipped.
+      bool        Finished;       // =true after the closing delimiter has been seen.
+    };
+
+    std::vector<Level> Levels;    // Multiparts that are currently open, outermost first.
+    const char        *Position;  // Start of the next unread line.
+    const char        *Limit;
+
+    const char *Find_Delimiter(const char *Start, const char *&After, bool &Closing, int &Which);
+};
+
+class Transfer_Decoder {
+  public:
+    explicit Transfer_Decoder(const std::string &Encoding);
+
+    void Decode(const char *Begin, const char *End, std::string &Output);
+      // Decodes the next piece of content and appends the result to Output.
+
+    void Finish(std::string &Output);
+      // Flushes anything held back at the end of the content.
+
+  private:
+    enum Kind { Identity, Base64, Quoted_Printable };
+
+    Kind          Method;
+    unsigned long Bits;           // Base64: accumulated bits.
+    int           Bit_Count;      // Base64: number of sextets in Bits.
+    std::string   Pending;        // Quoted printable: an incomplete escape or line end.
+
+    void Decode_Base64(const char *Begin, const char *End, std::string &Output);
+    void Decode_QuotedPrintable(const char *Begin, const char *End, std::string &Output);
+};
+
+#endif
@@ -0,0 +1,216 @@
+/****************************************************************************
+FILE          : nbdir.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the portable noticeboard directory scanner.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cctype>
+#include <cstring>
+
+#if eOPSYS == eWIN32
+#include <windows.h>
+#undef min
+#undef max
+#elif eOPSYS == ePOSIX
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+#include "nbdir.hpp"
+
+//
+// Is_NoticeName
+//
+// A file is a notice file iff its name ends with the given extension (in any case). Notices
+//   on the board are *.CNB and unread mail is *.CNM.
+//
+static bool Is_NoticeName(const char *Name, const char *Extension)
+  {
+    size_t Length = strlen(Name);
+    size_t Wanted = strlen(Extension);
+    if (Length < Wanted) return false;
+
+    const char *Tail = Name + Length - Wanted;
+    for (size_t i = 0; i < Wanted; i++) {
+      if (toupper(static_cast<unsigned char>(Tail[i])) != toupper(static_cast<unsigned char>(Extension[i])))
+        return false;
+    }
+    return true;
+  }
+
+
+//
+// Join_Path
+//
+string Join_Path(const string &Directory, const string &Name)
+  {
+    string Result(Directory);
+    if (!Result.empty() && Result[Result.size() - 1] != '/' && Result[Result.size() - 1] != Path_Separator)
+      Result += Path_Separator;
+    Result += Name;
+    return Result;
+  }
+
+
+//
+// Scan_Topic
+//
+bool Scan_Topic(
+  const string        &Topic_Path,
+  vector<string>      *Subtopics,
+  vector<Notice_File> *Notices,
+  const char          *Extension)
+  {
+    #if eOPSYS == eWIN32
+    WIN32_FIND_DATA Scan_Information;
+    HANDLE          Search_Handle;
+
+    Search_Handle = FindFirstFile(Join_Path(Topic_Path, "*.*").c_str(), &Scan_Information);
+    if (Search_Handle == INVALID_HANDLE_VALUE) return false;
+
+    do {
+      const char *Name = Scan_Information.cFileName;
+
+      if (Scan_Information.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        if (strcmp(Name, ".") == 0 || strcmp(Name, "..") == 0) continue;
+        if (Subtopics != 0) Subtopics->push_back(Join_Path(Topic_Path, Name));
+      }
+      else if (Notices != 0 && Is_NoticeName(Name, Extension)) {
+        // File times are in 100ns units.
+        unsigned long long Time =
+          (static_cast<unsigned long long>(Scan_Information.ftLastWriteTime.dwHighDateTime) << 32) |
+          Scan_Information.ftLastWriteTime.dwLowDateTime;
+
+        Notice_File File;
+        File.Path     = Join_Path(Topic_Path, Name);
+        File.Modified = static_cast<long long>(Time / 10000000);
+        File.Size     = (static_cast<long long>(Scan_Information.nFileSizeHigh) << 32) | Scan_Information.nFileSizeLow;
+        Notices->push_back(File);
+      }
+    } while (FindNextFile(Search_Handle, &Scan_Information));
+
+    FindClose(Search_Handle);
+    return true;
+
+    #elif eOPSYS == ePOSIX
+    DIR *Directory = opendir(Topic_Path.c_str());
+    if (Directory == 0) return false;
+
+    struct dirent *Entry;
+    while ((Entry = readdir(Directory)) != 0) {
+      const char *Name = Entry->d_name;
+      if (strcmp(Name, ".") == 0 || strcmp(Name, "..") == 0) continue;
+
+      string      Entity_Name(Join_Path(Topic_Path, Name));
+      struct stat Information;
+      if (stat(Entity_Name.c_str(), &Information) == -1) continue;
+
+      if (S_ISDIR(Information.st_mode)) {
+        if (Subtopics != 0) Subtopics->push_back(Entity_Name);
+      }
+      else if (Notices != 0 && S_ISREG(Information.st_mode) && Is_NoticeName(Name, Extension)) {
+        Notice_File File;
+        File.Path     = Entity_Name;
+        File.Modified = static_cast<long long>(Information.st_mtime);
+        File.Size     = static_cast<long long>(Information.st_size);
+        Notices->push_back(File);
+      }
+    }
+    closedir(Directory);
+    return true;
+
+    #else
+    #error Scan_Topic not implemented for this operating system!
+    #endif
+  }
+
+
+//
+// Path_Information
+//
+bool Path_Information(const string &Path, long long &Modified, long long &Size)
+  {
+    #if eOPSYS == eWIN32
+    WIN32_FILE_ATTRIBUTE_DATA Information;
+    if (!GetFileAttributesEx(Path.c_str(), GetFileExInfoStandard, &Information)) return false;
+
+    // File times are in 100ns units since 1601.
+    unsigned long long Time =
+      (static_cast<unsigned long long>(Information.ftLastWriteTime.dwHighDateTime) << 32) |
+      Information.ftLastWriteTime.dwLowDateTime;
+    Modified = (static_cast<long long>(Time) - 116444736000000000LL) * 100;
+    Size     = (static_cast<long long>(Information.nFileSizeHigh) << 32) | Information.nFileSizeLow;
+    return true;
+
+    #elif eOPSYS == ePOSIX
+    struct stat Information;
+    if (stat(Path.c_str(), &Information) == -1) return false;
+
+    Modified = static_cast<long long>(Information.st_mtim.tv_sec) * 1000000000LL + Information.st_mtim.tv_nsec;
+    Size     = static_cast<long long>(Information.st_size);
+    return true;
+
+    #else
+    #error Path_Information not implemented for this operating system!
+    #endif
+  }
+
+
+//
+// Walk_Noticeboard
+//
+// An explicit stack is used instead of recursion. Noticeboard trees aren't deep but there
+//   is no reason to depend on that.
+//
+void Walk_Noticeboard(const string &Root, Topic_Visitor &Visitor)
+  {
+    vector<string> Pending;
+    Pending.push_back(Root);
+
+    while (!Pending.empty()) {
+      string Topic_Path;
+      Topic_Path.swap(Pending.back());
+      Pending.pop_back();
+
+      vector<string>      Subtopics;
+      vector<Notice_File> Notices;
+      if (!Scan_Topic(Topic_Path, &Subtopics, &Notices)) continue;
+
+      Visitor.Visit(Topic_Path, Notices);
+
+      // Push in reverse so that the subtopics are visited in directory order.
+      for (vector<string>::reverse_iterator Stepper = Subtopics.rbegin(); Stepper != Subtopics.rend(); Stepper++) {
+        Pending.push_back(*Stepper);
+      }
+    }
+  }
@@ -0,0 +1,86 @@
+/****************************************************************************
+FILE          : nbdir.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the portable noticeboard directory scanner.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+These functions list the contents of a topic directory (its subtopic
+directories and its *.CNB notice files) and walk an entire noticeboard tree.
+They work on both Win32 and POSIX systems and use only standard strings, so
+they can be used by the console tools and from worker threads.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef NBDIR_H
+#define NBDIR_H
+
+#include <string>
+#include <vector>
+
+#include "environ.hpp"
+
+#if eOPSYS == eWIN32
+const char Path_Separator = '\\';
+#else
+const char Path_Separator = '/';
+#endif
+
+struct Notice_File {
+  std::string Path;      // Full path to the notice.
+  long long   Modified;  // Last modification time (seconds; only useful for comparison).
+  long long   Size;      // Size in bytes.
+};
+
+bool Scan_Topic(
+  const std::string        &Topic_Path,
+  std::vector<std::string> *Subtopics,
+  std::vector<Notice_File> *Notices,
+  const char               *Extension = ".CNB"
+);
+  // Lists the given topic directory. Either output pointer may be null if that
+  //   information isn't wanted. Only files with the given extension are listed as
+  //   notices. Returns false if the directory can't be read.
+
+bool Path_Information(const std::string &Path, long long &Modified, long long &Size);
+  // Looks up the modification time (in nanoseconds since 1970, to whatever precision the
+  //   file system keeps) and size of a file or directory. Returns false if it doesn't
+  //   exist. Only the directory itself is examined, not its contents.
+
+class Topic_Visitor {
+  public:
+    virtual ~Topic_Visitor() { }
+    virtual void Visit(const std::string &Topic_Path, const std::vector<Notice_File> &Notices) = 0;
+};
+
+void Walk_Noticeboard(const std::string &Root, Topic_Visitor &Visitor);
+  // Visits every topic in the tree rooted at Root (including Root itself) in depth first
+  //   order.
+
+std::string Join_Path(const std::string &Directory, const std::string &Name);
+  // Appends a name to a directory path, adding a separator if needed.
+
+#endif
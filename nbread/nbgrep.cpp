@@ -0,0 +1,445 @@
+/****************************************************************************
+FILE          : nbgrep.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Regular expression search of the noticeboards.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+This console program searches every notice under a noticeboard root for
+lines matching a regular expression (ECMAScript syntax, as std::regex
+understands it). Matching lines are printed as they are found in the form
+
+  topic/notice.cnb:line:text
+
+Usage:
+
+  nbgrep [-i] [-l] [-H | -B] [-j threads] pattern root
+
+  -i   Ignore case.
+  -l   Only list the notices that match.
+  -H   Only search the headers.
+  -B   Only search the bodies.
+  -j   Number of worker threads (the default depends on the hardware).
+
+Notices are memory mapped and searched by a pool of worker threads while
+the directory tree is still being walked. When the pattern contains a
+literal string that every match must include, the file is first scanned
+for that string with memchr and the regular expression is only run on the
+lines where it occurs. Build with, for example:
+
+  g++ -O2 -pthread -o nbgrep nbgrep.cpp header.cpp mapfile.cpp nbdir.cpp
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include "header.hpp"
+#include "mapfile.hpp"
+#include "nbdir.hpp"
+
+enum Search_Region { Whole_Notice, Headers_Only, Body_Only };
+
+struct Search_Options {
+  regex         Pattern;
+  string        Literal;      // Must appear in every matching line (may be empty).
+  bool          Ignore_Case;
+  bool          List_Only;
+  Search_Region Region;
+};
+
+//
+// Escape_End
+//
+// Given the index of the character after a backslash, returns the index of the last
+//   character of the escape sequence. Most escapes are one character, but \xHH, \uHHHH,
+//   \cX and back references (\1, \12, ...) are longer.
+//
+static size_t Escape_End(const string &Pattern, size_t i)
+  {
+    size_t Extra = 0;
+
+    switch (Pattern[i]) {
+    case 'x': Extra = 2; break;
+    case 'u': Extra = 4; break;
+    case 'c': Extra = 1; break;
+    default:
+      if (isdigit(static_cast<unsigned char>(Pattern[i]))) {
+        while (i + 1 < Pattern.size() && isdigit(static_cast<unsigned char>(Pattern[i + 1]))) i++;
+      }
+      break;
+    }
+    i += Extra;
+    return (i < Pattern.size()) ? i : Pattern.size() - 1;
+  }
+
+
+//
+// Required_Literal
+//
+// Returns the longest run of literal characters that any match of the pattern must
+//   contain. This is conservative: it gives up on alternation at the top level and ignores
+//   everything inside groups and bracket expressions. A character followed by a quantifier
+//   that allows zero repetitions is not part of the run.
+//
+static string Required_Literal(const string &Pattern)
+  {
+    string Best;
+    string Current;
+    int    Depth = 0;
+
+    for (size_t i = 0; i < Pattern.size(); i++) {
+      char Ch = Pattern[i];
+
+      if (Ch == '\\' && i + 1 < Pattern.size()) {
+        char Next = Pattern[++i];
+
+        // Escaped punctuation is literal; escapes like \d and \b are not. Neither are the
+        //   characters that make up a longer escape such as \x41, so all of it is skipped.
+        //
+        bool Is_Literal = !isalnum(static_cast<unsigned char>(Next));
+        if (!Is_Literal) i = Escape_End(Pattern, i);
+        if (Depth > 0) continue;
+
+        if (!Is_Literal) {
+          if (Current.size() > Best.size()) Best = Current;
+          Current.clear();
+          continue;
+        }
+        Ch = Next;
+      }
+      else if (Ch == '|' && Depth == 0) {
+        return string();
+      }
+      else if (Ch == '(') {
+        Depth++;
+        if (Current.size() > Best.size()) Best = Current;
+        Current.clear();
+        continue;
+      }
+      else if (Ch == ')') {
+        if (Depth > 0) Depth--;
+        continue;
+      }
+      else if (Ch == '[') {
+        // Skip the bracket expression. A ']' right after '[' or '[^' is literal.
+        size_t j = i + 1;
+        if (j < Pattern.size() && Pattern[j] == '^') j++;
+        if (j < Pattern.size() && Pattern[j] == ']') j++;
+        while (j < Pattern.size() && Pattern[j] != ']') {
+          if (Pattern[j] == '\\') j++;
+          j++;
+        }
+        i = j;
+        if (Depth == 0) {
+          if (Current.size() > Best.size()) Best = Current;
+          Current.clear();
+        }
+        continue;
+      }
+      else if (strchr(".^$*+?{}", Ch) != 0) {
+        if (Depth > 0) continue;
+
+        // The previous character might not be there at all.
+        if ((Ch == '*' || Ch == '?' || Ch == '{') && !Current.empty()) Current.erase(Current.size() - 1);
+        if (Current.size() > Best.size()) Best = Current;
+        Current.clear();
+
+        // Skip a counted repetition.
+        if (Ch == '{') {
+          while (i < Pattern.size() && Pattern[i] != '}') i++;
+        }
+        continue;
+      }
+
+      if (Depth == 0) Current += Ch;
+    }
+
+    // A character followed by a quantifier was dropped above; the final run is complete.
+    if (Current.size() > Best.size()) Best = Current;
+    return Best;
+  }
+
+
+//
+// Find_Literal
+//
+// Returns the next occurrence of the literal in [Stepper, End) or null. The first
+//   character is found with memchr (once for each case when ignoring case).
+//
+static const char *Find_Literal(const char *Stepper, const char *End, const string &Literal, bool Ignore_Case)
+  {
+    size_t Length = Literal.size();
+    if (static_cast<size_t>(End - Stepper) < Length) return 0;
+
+    const char *Last  = End - Length + 1;
+    char        Lower = static_cast<char>(tolower(static_cast<unsigned char>(Literal[0])));
+    char        Upper = static_cast<char>(toupper(static_cast<unsigned char>(Literal[0])));
+
+    while (Stepper < Last) {
+      const char *Candidate;
+      if (!Ignore_Case || Lower == Upper) {
+        Candidate = static_cast<const char *>(memchr(Stepper, Literal[0], Last - Stepper));
+      }
+      else {
+        const char *L = static_cast<const char *>(memchr(Stepper, Lower, Last - Stepper));
+        const char *U = static_cast<const char *>(memchr(Stepper, Upper, (L == 0 ? Last : L) - Stepper));
+        Candidate = (U != 0) ? U : L;
+      }
+      if (Candidate == 0) return 0;
+
+      size_t i = 1;
+      if (Ignore_Case) {
+        while (i < Length &&
+               tolower(static_cast<unsigned char>(Candidate[i])) == tolower(static_cast<unsigned char>(Literal[i]))) i++;
+      }
+      else {
+        if (memcmp(Candidate + 1, Literal.data() + 1, Length - 1) == 0) i = Length;
+      }
+      if (i == Length) return Candidate;
+      Stepper = Candidate + 1;
+    }
+    return 0;
+  }
+
+
+//
+// Search_Notice
+//
+// Appends the output for one notice to Output. Returns the number of matching lines.
+//
+static int Search_Notice(const string &Path, const Search_Options &Options, string &Output)
+  {
+    Mapped_File Text;
+    if (!Text.Open(Path.c_str()) || Text.Length() == 0) return 0;
+
+    const char *Begin = Text.Begin();
+    const char *End   = Text.End();
+    if (Options.Region != Whole_Notice) {
+      Header_Block Headers;
+      const char *Body = Headers.Parse(Begin, End);
+      if (Options.Region == Headers_Only) End   = Body;
+      else                                Begin = Body;
+    }
+
+    int         Matches      = 0;
+    const char *Counted      = Text.Begin();  // Lines have been counted up to here.
+    int         Counted_Line = 1;
+    const char *Stepper      = Begin;
+
+    while (Stepper < End) {
+
+      // Find the next line that could match.
+      const char *Line_Start = Stepper;
+      if (!Options.Literal.empty()) {
+        const char *Hit = Find_Literal(Stepper, End, Options.Literal, Options.Ignore_Case);
+        if (Hit == 0) break;
+        Line_Start = Hit;
+        while (Line_Start > Stepper && Line_Start[-1] != '\n') Line_Start--;
+      }
+      const char *Line_End = static_cast<const char *>(memchr(Line_Start, '\n', End - Line_Start));
+      if (Line_End == 0) Line_End = End;
+      Stepper = (Line_End == End) ? End : Line_End + 1;
+
+      const char *Trimmed = Line_End;
+      if (Trimmed > Line_Start && Trimmed[-1] == '\r') Trimmed--;
+      if (!regex_search(Line_Start, Trimmed, Options.Pattern)) continue;
+
+      Matches++;
+      if (Options.List_Only) {
+        Output += Path;
+        Output += '\n';
+        break;
+      }
+
+      // Line numbers are only worked out for the lines that match.
+      while (Counted < Line_Start) {
+        const char *Newline = static_cast<const char *>(memchr(Counted, '\n', Line_Start - Counted));
+        if (Newline == 0) break;
+        Counted_Line++;
+        Counted = Newline + 1;
+      }
+
+      char Number[16];
+      sprintf(Number, ":%d:", Counted_Line);
+      Output += Path;
+      Output += Number;
+      Output.append(Line_Start, Trimmed);
+      Output += '\n';
+    }
+    return Matches;
+  }
+
+
+//
+// class Work_Queue
+//
+// The directory walk feeds notice paths to the worker threads through this queue.
+//
+class Work_Queue {
+  public:
+    Work_Queue() : Closed(false) { }
+
+    void Push(const string &Path)
+      {
+        lock_guard<mutex> Guard(Lock);
+        Pending.push_back(Path);
+        Ready.notify_one();
+      }
+
+    void Close()
+      {
+        lock_guard<mutex> Guard(Lock);
+        Closed = true;
+        Ready.notify_all();
+      }
+
+    // Returns false when the queue is closed and empty.
+    bool Pop(string &Path)
+      {
+        unique_lock<mutex> Guard(Lock);
+        while (Pending.empty() && !Closed) Ready.wait(Guard);
+        if (Pending.empty()) return false;
+        Path.swap(Pending.front());
+        Pending.pop_front();
+        return true;
+      }
+
+  private:
+    mutex              Lock;
+    condition_variable Ready;
+    deque<string>      Pending;
+    bool               Closed;
+};
+
+
+//
+// class Queue_Feeder
+//
+class Queue_Feeder : public Topic_Visitor {
+  public:
+    explicit Queue_Feeder(Work_Queue &Q) : Queue(Q) { }
+
+    virtual void Visit(const string &, const vector<Notice_File> &Notices)
+      {
+        for (size_t i = 0; i < Notices.size(); i++) Queue.Push(Notices[i].Path);
+      }
+
+  private:
+    Work_Queue &Queue;
+};
+
+
+static mutex        Output_Lock;
+static atomic<long> Total_Matches(0);
+
+//
+// Worker
+//
+// Each notice's output is written in one piece so that lines from different notices are
+//   never interleaved.
+//
+static void Worker(Work_Queue *Queue, const Search_Options *Options)
+  {
+    string Path;
+    string Output;
+    while (Queue->Pop(Path)) {
+      Output.clear();
+      int Count = Search_Notice(Path, *Options, Output);
+      if (Count == 0) continue;
+
+      Total_Matches += Count;
+      lock_guard<mutex> Guard(Output_Lock);
+      fwrite(Output.data(), 1, Output.size(), stdout);
+    }
+  }
+
+
+//
+// Main Program
+//
+int main(int argc, char **argv)
+  {
+    Search_Options Options;
+    Options.Ignore_Case = false;
+    Options.List_Only   = false;
+    Options.Region      = Whole_Notice;
+    int Thread_Count    = static_cast<int>(thread::hardware_concurrency());
+
+    int Argument = 1;
+    for (; Argument < argc && argv[Argument][0] == '-'; Argument++) {
+      const char *Flag = argv[Argument];
+      if      (strcmp(Flag, "-i") == 0) Options.Ignore_Case = true;
+      else if (strcmp(Flag, "-l") == 0) Options.List_Only   = true;
+      else if (strcmp(Flag, "-H") == 0) Options.Region      = Headers_Only;
+      else if (strcmp(Flag, "-B") == 0) Options.Region      = Body_Only;
+      else if (strcmp(Flag, "-j") == 0 && Argument + 1 < argc) Thread_Count = atoi(argv[++Argument]);
+      else break;
+    }
+    if (argc - Argument != 2) {
+      fprintf(stderr, "Usage: nbgrep [-i] [-l] [-H | -B] [-j threads] pattern root\n");
+      return 2;
+    }
+    if (Thread_Count < 1) Thread_Count = 1;
+
+    try {
+      regex::flag_type Flags = regex::ECMAScript | regex::optimize;
+      if (Options.Ignore_Case) Flags |= regex::icase;
+      Options.Pattern.assign(argv[Argument], Flags);
+    }
+    catch (regex_error &Error) {
+      fprintf(stderr, "Bad pattern: %s\n", Error.what());
+      return 2;
+    }
+    Options.Literal = Required_Literal(argv[Argument]);
+
+    Work_Queue     Queue;
+    vector<thread> Workers;
+    for (int i = 0; i < Thread_Count; i++) {
+      Workers.push_back(thread(Worker, &Queue, &Options));
+    }
+
+    Queue_Feeder Feeder(Queue);
+    Walk_Noticeboard(argv[Argument + 1], Feeder);
+    Queue.Close();
+
+    for (size_t i = 0; i < Workers.size(); i++) Workers[i].join();
+    return Total_Matches > 0 ? 0 : 1;
+  }
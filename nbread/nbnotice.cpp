@@ -36,85 +36,34 @@ Please send comments or bug reports to
 ****************************************************************************/
 
 #include "environ.hpp"
-#include <fstream>
 #include <windows.h>
 
 using namespace std;
 
+#include "bcache.hpp"
+#include "global.hpp"
 #include "history.hpp"
+#include "metrics.hpp"
 #include "nbobject.hpp"
 #include "str.hpp"
 #include "windebug.hpp"
 
-//
-// The definition of the static objects in class NB_Notice.
-//
-const int NB_Notice::Num_Objects = 3;
+static spica::metric_histogram Notice_Redraws("notice.redraw");
 
 //
-// Process_Summary
+// NB_Notice::NB_Notice
 //
-void NB_Notice::Process_Summary()
-  {
-    Tracer(4, "Processing a notice to extract its summary.");
-
-    Subject = "UNKNOWN Subject";
-    From    = "UNKNOWN Poster";
-    Date    = "UNKNOWN Date";
-
-    ifstream Posting(Notice_Path);
-
-    // If we can't open the posting file for some strange reason, let the
-    //   user know by sending back a message as the notice summary.
-    //
-    if (!Posting) {
-      Subject = "Unable to open notice: ";
-      Subject.append(Notice_Path);
-      return;
-    }
-
-    int         Objects_Filled = 0;
-    spica::String Line;
-
-    while ((Objects_Filled < Num_Objects) && Posting) {
-      Posting >> Line;
-      spica::String First_Word = Line.word(1);
-
-      if (First_Word == static_cast<spica::String>("Subject:")) {
-        Subject = Line.subword(2);
-        Objects_Filled++;
-      }
-      else if (First_Word == static_cast<spica::String>("From:")) {
-        From = Line.subword(2);
-        Objects_Filled++;
-      }
-      else if (First_Word == static_cast<spica::String>("Date:")) {
-        Date = Line.subword(2);
-        Objects_Filled++;
-      }
-    }
-
-    // Clean up the "From" string a bit.
-    int Angle_Bracket = From.pos('<');
-    spica::String Clean_Name = From.substr(1, Angle_Bracket - 1);
-    Clean_Name = Clean_Name.strip();
-    Clean_Name = Clean_Name.strip('B', '"');
-    From       = Clean_Name;
-
-    // Clean up the "Date" string a bit. The format right now is:
-    // Fri, 1 May 1998 16:29:35 EST5EDT
-    //
-    Raw_Date = Date;
-    spica::String Clean_Date = Date.word(3);
-    Clean_Date.append(" ");
-    Clean_Date.append(Date.word(2));
-    Clean_Date.append(", ");
-    spica::String Raw_Time = Date.word(5);
-    Clean_Date.append(Raw_Time.substr(1, 5));
-    Date = Clean_Date;
-
-    Processed = true;
-  }
+// The summary table already knows everything about the notice that we need until it is
+//   drawn. Only the subject is copied (for the window title).
+//
+NB_Notice::NB_Notice(NB_Topic *Topic, int Row) :
+  Notice_Path (Topic->Summaries().Path(Row)),
+  Owner       (Topic),
+  Table_Row   (Row),
+  Subject     (Topic->Summaries().Subject(Row)),
+  Scroll      (0),
+  HOffset     (0)
+  { }
 
 
 //
@@ -122,46 +71,10 @@ void NB_Notice::Process_Summary()
 //
 spica::String &NB_Notice::Description()
   {
-    if (!Processed) Process_Summary();
     return Subject;
   }
 
 
-//
-// NB_Notice::Poster_Name
-//
-spica::String &NB_Notice::Poster_Name()
-  {
-    if (!Processed) Process_Summary();
-    return From;
-  }
-
-
-//
-// NB_Notice::Date_String
-//
-spica::String &NB_Notice::Date_String()
-  {
-    if (!Processed) Process_Summary();
-    return Date;
-  }
-
-
-//
-// NB_Notice::RawDate_String
-//
-// This function is a copy of the entire date string that was stored in
-//   the notice file. It is used during the date comparisons that are done
-//   when notices are sorted by date. The Date_String() function returns
-//   an abbreviated date (more suitable for display).
-//
-spica::String &NB_Notice::RawDate_String()
-  {
-    if (!Processed) Process_Summary();
-    return Raw_Date;
-  }
-
-
 //
 // NB_Notice::Mark_AsRead
 //
@@ -170,7 +83,11 @@ spica::String &NB_Notice::RawDate_String()
 //
 void NB_Notice::Mark_AsRead(History *History_Database)
   {
+    // Only the first marking changes the topic's unread count.
+    if (History_Database->Has_Read(Notice_Path)) return;
+
     History_Database->Mark_Read(Notice_Path);
+    Owner->Notice_Read(Table_Row);
   }
 
 
@@ -192,6 +109,8 @@ bool NB_Notice::Is_Read(History *History_Database)
 void NB_Notice::Redraw(
   const HWND &Window_Handle, const HDC &Context_Handle)
   {
+    spica::metric_timer Timer(Notice_Redraws);
+
     RECT       The_Rectangle;
     TEXTMETRIC Text_Metrics;
     int        Char_Height;
@@ -211,54 +130,50 @@ void NB_Notice::Redraw(
     unsigned Page_Height = The_Rectangle.bottom/Char_Height;
     unsigned Page_Width  = The_Rectangle.right/Char_Width;
 
-    // If we dont' have the text of the message yet, we need to get it.
-    if (!Have_Text) {
-      ifstream Posting(Notice_Path);
-      Longest_Line = 0;
-
-      // If we can't open the notice file, I guess there is no text!
-      if (!Posting) {
-        Notice_Text.erase(Notice_Text.begin(), Notice_Text.end());
-        Have_Text = true;
-        return;
-      }
-
-      spica::String Line;
-      while (Posting >> Line) {
-        Notice_Text.push_back(Line);
-        if (Line.length() > Longest_Line) Longest_Line = Line.length();
-      }
-      Have_Text = true;
-    }
-	
-    // Adjust position appropriately.
-    if (Position < 0) Position = 0;
-    if (Notice_Text.size() <= Page_Height) Position = 0;
-    else {
-      if (Position > static_cast<int>(Notice_Text.size() - Page_Height)) Position = Notice_Text.size() - Page_Height;
-    }
+    // Get the text of the message from the cache. It is loaded again if it was evicted
+    //   since the last redraw. If we can't open the notice file, I guess there is no text!
+    //
+    shared_ptr<const Notice_Body> Body(Body_Cache::Instance().Fetch(Notice_Path));
+    unsigned Line_Count = Body->Line_Count();
 
-    // Adjust hoffset appropriately.
+    // Lay the text out for the current window. Only the rows near the top of the window
+    //   are worked out; the rest of the body is left alone until it is scrolled into view.
+    //
+    Layout.Attach(Body);
+    Layout.Set_Format(Tab_Width, Wrap_Lines ? Page_Width : 0);
+    Layout.Move(Top, Scroll);
+    Layout.Clamp(Top, Page_Height);
+    Scroll = 0;
+
+    // Adjust hoffset appropriately. The expanded width is only known for rows that have
+    //   been displayed, so the range can grow as the notice is scrolled.
+    //
+    int Longest_Line = Wrap_Lines ? 0 : Layout.Widest();
     if (HOffset < 0) HOffset = 0;
-    if (Longest_Line <= Page_Width)  HOffset = 0;
+    if (static_cast<unsigned>(Longest_Line) <= Page_Width) HOffset = 0;
     else {
       if (HOffset > static_cast<int>(Longest_Line - Page_Width)) HOffset = Longest_Line - Page_Width;
     }
 
-    // Now update the entire window.
-    for (unsigned Row = 0; Row < Notice_Text.size() && Row < Page_Height; Row++) {
-      const char *Start_Position;
-      spica::String &This_Line = Notice_Text[Row+Position];
+    // Now update the entire window. Only the visible rows are touched.
+    string        Row_Text;
+    Layout_Anchor Row_Position = Top;
+    for (unsigned Row = 0; Row < Page_Height && Row_Position.Line < static_cast<int>(Line_Count); Row++) {
+      int Length = Layout.Row_Text(Row_Position.Line, Row_Position.Subrow, Row_Text);
+      if (Length > HOffset) {
+        TextOut(Context_Handle, 0, Row * Char_Height, Row_Text.data() + HOffset, Length - HOffset);
+      }
 
-      if (This_Line.length() < HOffset) continue;
-      Start_Position = static_cast<const char *>(This_Line) + HOffset;
-      TextOut(Context_Handle, 0, Row * Char_Height, Start_Position, strlen(Start_Position));
+      // Stop after the last row.
+      Layout_Anchor Previous = Row_Position;
+      Layout.Move(Row_Position, 1);
+      if (Row_Position.Line == Previous.Line && Row_Position.Subrow == Previous.Subrow) break;
     }
 
     // Redraw the scroll bars.
-    SetScrollRange(Window_Handle, SB_VERT, 0, Notice_Text.size(), FALSE);
+    SetScrollRange(Window_Handle, SB_VERT, 0, Line_Count, FALSE);
     SetScrollRange(Window_Handle, SB_HORZ, 0, Longest_Line, FALSE);
-    SetScrollPos(Window_Handle, SB_VERT, Position, TRUE);
+    SetScrollPos(Window_Handle, SB_VERT, Top.Line, TRUE);
     SetScrollPos(Window_Handle, SB_HORZ, HOffset, TRUE);
   }
 
@@ -298,14 +213,20 @@ void NB_Notice::VScroll(const HWND &Notice_Window, const WPARAM &wParam, const i
     GetClientRect(Notice_Window, &The_Rectangle);
     Page = The_Rectangle.bottom/Char_Height;
 
-    // The value of position is "corrected" in the Redraw() function.
+    // The movement is applied (and corrected) in the Redraw() function, which knows how
+    //   the lines are wrapped. The scroll bar itself counts lines, not rows.
+    //
     switch (LOWORD(wParam)) {
 
-      case SB_LINEUP       : Position -= 1;    break;
-      case SB_LINEDOWN     : Position += 1;    break;
-      case SB_PAGEUP       : Position -= Page; break;
-      case SB_PAGEDOWN     : Position += Page; break;
-      case SB_THUMBPOSITION: Position = HIWORD(wParam); break;
+      case SB_LINEUP       : Scroll -= 1;    break;
+      case SB_LINEDOWN     : Scroll += 1;    break;
+      case SB_PAGEUP       : Scroll -= Page; break;
+      case SB_PAGEDOWN     : Scroll += Page; break;
+      case SB_THUMBPOSITION:
+        Top.Line   = HIWORD(wParam);
+        Top.Subrow = 0;
+        Scroll     = 0;
+        break;
     }
     InvalidateRect(Notice_Window, 0, TRUE);
   }
@@ -34,19 +34,30 @@ Please send comments or bug reports to
 
 #include <iomanip>
 #include <cstdlib>
+#include <string>
 #include <strstream>
+#include <vector>
 
 using namespace std;
 
 #include <windows.h>
 
+#include "config.hpp"
 #include "history.hpp"
 #include "str.hpp"
+#include "unread.hpp"
 
 LRESULT CALLBACK Notify_Procedure(HWND, UINT, WPARAM, LPARAM);
 
 const char * const MAILBOX_DIRECTORY = "F:\\PMAIL";
-  // The location for unread mail (assumed to be the same for all users).
+  // The default location for unread mail (assumed to be the same for all users).
+
+// The notifier reads the same configuration file as the reader.
+#ifdef ON_NETWORK
+#define MASTER_CONFIGPATH "s:\\nb\\nbread.cfg"
+#else
+#define MASTER_CONFIGPATH "c:\\home\\prog\\nbread\\nbread.cfg"
+#endif
 
 const char * const Notify_ClassName = "NBNotification_Class";
   // Used in two places, defined only here.
@@ -55,92 +66,6 @@ char *Results;
   // This holds the full text to be displayed in the window.
 
 
-//
-// Scan_Mail_Directory
-//
-// The following function looks for unread mail in the given directory. It returns
-//   a count of such notices.
-//
-static int Scan_Mail_Directory(const spica::String &Mail_Directory)
-  {
-    spica::String   WildCard_Name;
-    WIN32_FIND_DATA Scan_Information;
-    HANDLE          Search_Handle;
-    int             Counter = 0;
-
-    // Scan for the mail files. For now, assume a file is a mail file iff it
-    //   matches *.CNM.
-    //
-    WildCard_Name = Mail_Directory;
-    WildCard_Name.append("\\*.CNM");
-
-    Search_Handle = FindFirstFile(static_cast<const char *>(WildCard_Name), &Scan_Information);
-    if (Search_Handle == INVALID_HANDLE_VALUE) return 0;
-
-    // Process the first file and then the rest.
-    do {
-      spica::String Entity_Name(Mail_Directory);
-      Entity_Name.append("\\");
-      Entity_Name.append(Scan_Information.cFileName);
-
-      // Let's verify that this is a regular file first...
-      if ((Scan_Information.dwFileAttributes &  FILE_ATTRIBUTE_ARCHIVE) ||
-          (Scan_Information.dwFileAttributes == 0 )) {
-        Counter++;
-      }
-    } while (FindNextFile(Search_Handle, &Scan_Information));
-
-    // Close down the search handle.
-    FindClose(Search_Handle);
-
-    return Counter;
-  }
-
-
-//
-// Scan_Directory
-//
-// The following function looks for unread notices in the given directory. It returns
-//   a count of such notices.
-//
-static int Scan_Directory(const spica::String &Notice_Directory, const History &History_Database)
-  {
-    spica::String   WildCard_Name;
-    WIN32_FIND_DATA Scan_Information;
-    HANDLE          Search_Handle;
-    int             Counter = 0;
-
-    // Scan for the notice files. For now, assume a file is a notice file iff it
-    //   matches *.CNB.
-    //
-    WildCard_Name = Notice_Directory;
-    WildCard_Name.append("\\*.CNB");
-
-    Search_Handle = FindFirstFile(static_cast<const char *>(WildCard_Name), &Scan_Information);
-    if (Search_Handle == INVALID_HANDLE_VALUE) return 0;
-
-    // Process the first file and then the rest.
-    do {
-      spica::String Entity_Name(Notice_Directory);
-      Entity_Name.append("\\");
-      Entity_Name.append(Scan_Information.cFileName);
-
-      // Let's verify that this is a regular file first...
-      if ((Scan_Information.dwFileAttributes &  FILE_ATTRIBUTE_ARCHIVE) ||
-          (Scan_Information.dwFileAttributes == 0 )) {
-
-        // Have we read this one?
-        if (!History_Database.Has_Read(Entity_Name)) Counter++;
-      }
-    } while (FindNextFile(Search_Handle, &Scan_Information));
-
-    // Close down the search handle.
-    FindClose(Search_Handle);
-
-    return Counter;
-  }
-
-
 //
 // Display_Results
 //
@@ -226,63 +151,43 @@ int WINAPI WinMain(
   )
   {
     try {
-      // Change class History so that its constructor takes the name of the history file.
-      const History History_Database;
-
-      // Don't bother wasting time writing out the (unchanged) history database to
-      //   disk during destruction.
+      // The topics to check come from the configuration. The noticeboard root can also
+      //   come from the environment, as it always has.
       //
-      History_Database.Inhibit_Write();
-
-      // Now scan the desired noticeboards looking for unread messages.
-      char *Raw_Environment = getenv("NB");
-      if (Raw_Environment == 0) return 0;
-
-      spica::String Notice_Root(Raw_Environment);
-      spica::String Notice_Directory;
-      spica::String Mail_Directory;
+      spica::register_parameter("Mailbox_Directory", MAILBOX_DIRECTORY, false);
+      spica::read_config_files(MASTER_CONFIGPATH);
+
+      string  Notice_Root;
+      string *Configured_Root = spica::lookup_parameter("Noticeboard_Root");
+      char   *Raw_Environment = getenv("NB");
+      if      (Raw_Environment != 0) Notice_Root = Raw_Environment;
+      else if (Configured_Root != 0) Notice_Root = *Configured_Root;
+      else return 0;
+
+      // The history is only read if some directory has changed since the last check. The
+      //   history is never written back; nbnotify doesn't change it.
+      //
+      History_Source       History_Database(History::Default_FileName(), Notice_Root);
+      Unread_Cache         Cache;
+      vector<Notify_Topic> Topics;
+      vector<Unread_Count> Counts;
+
+      string *Cache_File = spica::lookup_parameter("Unread_Cache");
+      if (Cache_File != 0) Cache.Load(Cache_File->c_str());
+      Notify_Configuration(Notice_Root, Topics);
+      Count_Unread(Topics, History_Database, Counts, (Cache_File != 0) ? &Cache : 0);
+      if (Cache_File != 0) Cache.Save(Cache_File->c_str());
+
+      // Now scan the results looking for unread messages.
       ostrstream Formatter;
-
-      Mail_Directory = MAILBOX_DIRECTORY;
-      int Unread_Email = Scan_Mail_Directory(Mail_Directory);
-
-      Notice_Directory = Notice_Root;
-      Notice_Directory.append("\\everyone");
-      int Unread_Count1 = Scan_Directory(Notice_Directory, History_Database);
-
-      Notice_Directory = Notice_Root;
-      Notice_Directory.append("\\lstfnd");
-      int Unread_Count2 = Scan_Directory(Notice_Directory, History_Database);
-
-      Notice_Directory = Notice_Root;
-      Notice_Directory.append("\\meetings");
-      int Unread_Count3 = Scan_Directory(Notice_Directory, History_Database);
-
-      Notice_Directory = Notice_Root;
-      Notice_Directory.append("\\rides");
-      int Unread_Count4 = Scan_Directory(Notice_Directory, History_Database);
-
-      Notice_Directory = Notice_Root;
-      Notice_Directory.append("\\classifi");
-      int Unread_Count5 = Scan_Directory(Notice_Directory, History_Database);
-
-      if (Unread_Email  == 0 && Unread_Count1 == 0 &&
-          Unread_Count2 == 0 && Unread_Count3 == 0 &&
-          Unread_Count4 == 0 && Unread_Count5 == 0)
-        return 0;
-
-      if (Unread_Email != 0)
-        Formatter << setw(3) << Unread_Email  << " UNREAD: " << "E-Mail Messages" << "\n" << "\n";
-      if (Unread_Count1 != 0)
-        Formatter << setw(3) << Unread_Count1 << " UNREAD: " << "Announcements for Everyone" << "\n";
-      if (Unread_Count2 != 0)
-        Formatter << setw(3) << Unread_Count2 << " UNREAD: " << "Lost and Found" << "\n";
-      if (Unread_Count3 != 0)
-        Formatter << setw(3) << Unread_Count3 << " UNREAD: " << "Meetings" << "\n";
-      if (Unread_Count4 != 0)
-        Formatter << setw(3) << Unread_Count4 << " UNREAD: " << "Rides" << "\n";
-      if (Unread_Count5 != 0)
-        Formatter << setw(3) << Unread_Count5 << " UNREAD: " << "Classifieds" << "\n";
+      bool       Any_Unread = false;
+      for (size_t i = 0; i < Topics.size(); i++) {
+        if (Counts[i].Unread == 0) continue;
+        Any_Unread = true;
+        Formatter << setw(3) << Counts[i].Unread << " UNREAD: " << Topics[i].Title.c_str() << "\n";
+        if (Topics[i].Mailbox) Formatter << "\n";
+      }
+      if (!Any_Unread) return 0;
 
       Formatter << ends;
 
@@ -0,0 +1,665 @@
+/****************************************************************************
+FILE          : nbnotifyd.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Resident unread notice notifier.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+This program stays resident and keeps the unread counts of the configured
+topics (see unread.hpp) in memory. The topic directories are watched with
+inotify, so notices that are posted or removed are accounted for as they
+happen, and the user's history file is watched so that notices read in
+nbread are discounted when it saves the history. Nothing is rescanned to
+answer a question.
+
+Questions are asked over a Unix domain socket. A client connects, sends
+one line, and reads the answer until the connection closes:
+
+  count    The total number of unread notices.
+  topics   One line per topic: unread count, total, name, and title.
+  json     The same information as a JSON object.
+
+The same program asks the questions when given -q, which is convenient in
+shell prompts:
+
+  nbnotifyd [-c config] [-r root] [-f history] [-s socket]
+  nbnotifyd [-s socket] -q [count | topics | json]
+
+The options are as for nbunread. If the history is written by nbread on
+Windows, History_Root must be set (see unread.hpp). The socket defaults to
+Notify_Socket or $XDG_RUNTIME_DIR/nbnotifyd.sock (or
+/tmp/nbnotifyd-<uid>.sock). This program requires Linux. Build with, for
+example:
+
+  g++ -O2 -pthread -o nbnotifyd nbnotifyd.cpp unread.cpp nbdir.cpp history.cpp str.cpp config.cpp metrics.cpp
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#if eOPSYS != ePOSIX
+#error nbnotifyd requires Linux (inotify and Unix domain sockets)!
+#endif
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+#include "config.hpp"
+#include "history.hpp"
+#include "nbdir.hpp"
+#include "unread.hpp"
+
+// Set by the signal handler to stop the main loop.
+static volatile sig_atomic_t Stop_Requested = 0;
+
+static void Request_Stop(int)
+  {
+    Stop_Requested = 1;
+  }
+
+
+//
+// Has_Extension
+//
+// Returns true if Name ends with Extension, ignoring case.
+//
+static bool Has_Extension(const char *Name, const char *Extension)
+  {
+    size_t Length = strlen(Name);
+    size_t Wanted = strlen(Extension);
+    return Length >= Wanted && strcasecmp(Name + Length - Wanted, Extension) == 0;
+  }
+
+
+//
+// class Notifier
+//
+// The notifier owns the inotify instance and the state of every topic. Everything happens
+//   on one thread, so the History (and its spica::Strings) is safe to use. The history is
+//   consulted through a History_Source so that History_Root maps nbread's paths onto the
+//   noticeboard root as this machine sees it (see unread.hpp).
+//
+class Notifier {
+  public:
+    Notifier(const vector<Notify_Topic> &Topics, const string &Root, const string &History_File);
+   ~Notifier();
+
+    bool Start();
+      // Sets up the watches and does the initial scan. Returns false if inotify isn't
+      //   available.
+
+    int Descriptor() const { return Events; }
+
+    void Handle_Events();
+      // Reads and applies whatever events are pending.
+
+    void Retry_Missing();
+      // Tries again to watch topics whose directories didn't exist.
+
+    string Answer(const string &Command) const;
+
+  private:
+    struct Topic_State {
+      Notify_Topic                   Topic;
+      int                            Watch;     // -1 if the directory isn't being watched.
+      unordered_map<string, bool>    Notices;   // File name -> has been read.
+      int                            Unread;
+    };
+
+    vector<Topic_State>   States;
+    unordered_map<int, int> By_Watch;           // Watch descriptor -> index into States.
+    string                Notice_Root;
+    string                History_Path;
+    string                History_Directory;
+    string                History_Name;
+    int                   History_Watch;
+    History_Source       *Read_Notices;
+    int                   Events;               // The inotify descriptor.
+
+    void Load_History();
+    void Watch_Topic(int Index);
+    void Rescan(int Index);
+    void Recount(int Index);
+    void Notice_Added(int Index, const char *Name);
+    void Notice_Removed(int Index, const char *Name);
+
+    // Notifiers can't be copied. They own the inotify descriptor.
+    Notifier(const Notifier &);
+    Notifier &operator=(const Notifier &);
+};
+
+
+//
+// Notifier::Notifier
+//
+Notifier::Notifier(const vector<Notify_Topic> &Topics, const string &Root, const string &History_File) :
+  Notice_Root(Root), History_Path(History_File), History_Watch(-1), Read_Notices(0), Events(-1)
+  {
+    for (size_t i = 0; i < Topics.size(); i++) {
+      Topic_State State;
+      State.Topic  = Topics[i];
+      State.Watch  = -1;
+      State.Unread = 0;
+      States.push_back(State);
+    }
+
+    string::size_type Slash = History_Path.rfind('/');
+    History_Directory = (Slash == string::npos) ? "." : History_Path.substr(0, Slash + 1);
+    History_Name      = (Slash == string::npos) ? History_Path : History_Path.substr(Slash + 1);
+  }
+
+
+//
+// Notifier::~Notifier
+//
+Notifier::~Notifier()
+  {
+    if (Events != -1) close(Events);
+    delete Read_Notices;
+  }
+
+
+//
+// Notifier::Start
+//
+// The history file is replaced (not modified in place) by some editors, so its directory
+//   is watched rather than the file itself.
+//
+bool Notifier::Start()
+  {
+    Events = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (Events == -1) return false;
+
+    History_Watch = inotify_add_watch(
+      Events, History_Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+    Load_History();
+
+    for (size_t i = 0; i < States.size(); i++) Watch_Topic(static_cast<int>(i));
+    return true;
+  }
+
+
+//
+// Notifier::Load_History
+//
+void Notifier::Load_History()
+  {
+    delete Read_Notices;
+    Read_Notices = new History_Source(History_Path, Notice_Root);
+  }
+
+
+//
+// Notifier::Watch_Topic
+//
+// The watch is added before the directory is listed so that nothing that happens in
+//   between is missed. An event for a notice that the listing already found is harmless.
+//
+void Notifier::Watch_Topic(int Index)
+  {
+    Topic_State &State = States[Index];
+    State.Watch = inotify_add_watch(
+      Events,
+      State.Topic.Path.c_str(),
+      IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+    if (State.Watch == -1) return;
+
+    By_Watch[State.Watch] = Index;
+    Rescan(Index);
+  }
+
+
+//
+// Notifier::Retry_Missing
+//
+void Notifier::Retry_Missing()
+  {
+    for (size_t i = 0; i < States.size(); i++) {
+      if (States[i].Watch == -1) Watch_Topic(static_cast<int>(i));
+    }
+  }
+
+
+//
+// Notifier::Rescan
+//
+void Notifier::Rescan(int Index)
+  {
+    Topic_State &State = States[Index];
+    vector<Notice_File> Listing;
+
+    State.Notices.clear();
+    Scan_Topic(State.Topic.Path, 0, &Listing, State.Topic.Mailbox ? ".CNM" : ".CNB");
+    for (vector<Notice_File>::iterator Stepper = Listing.begin(); Stepper != Listing.end(); Stepper++) {
+      string::size_type Slash = Stepper->Path.rfind(Path_Separator);
+      State.Notices[Stepper->Path.substr(Slash + 1)] = false;
+    }
+    Recount(Index);
+  }
+
+
+//
+// Notifier::Recount
+//
+// Rechecks every notice in a topic against the history. Mail is always unread.
+//
+void Notifier::Recount(int Index)
+  {
+    Topic_State &State = States[Index];
+
+    State.Unread = 0;
+    for (unordered_map<string, bool>::iterator Stepper = State.Notices.begin(); Stepper != State.Notices.end(); Stepper++) {
+      Stepper->second = !State.Topic.Mailbox &&
+        Read_Notices->Has_Read(Join_Path(State.Topic.Path, Stepper->first));
+      if (!Stepper->second) State.Unread++;
+    }
+  }
+
+
+//
+// Notifier::Notice_Added
+//
+void Notifier::Notice_Added(int Index, const char *Name)
+  {
+    Topic_State &State = States[Index];
+    if (!Has_Extension(Name, State.Topic.Mailbox ? ".CNM" : ".CNB")) return;
+    if (State.Notices.find(Name) != State.Notices.end()) return;
+
+    bool Read = !State.Topic.Mailbox && Read_Notices->Has_Read(Join_Path(State.Topic.Path, Name));
+    State.Notices[Name] = Read;
+    if (!Read) State.Unread++;
+  }
+
+
+//
+// Notifier::Notice_Removed
+//
+void Notifier::Notice_Removed(int Index, const char *Name)
+  {
+    Topic_State &State = States[Index];
+    unordered_map<string, bool>::iterator Found = State.Notices.find(Name);
+    if (Found == State.Notices.end()) return;
+
+    if (!Found->second) State.Unread--;
+    State.Notices.erase(Found);
+  }
+
+
+//
+// Notifier::Handle_Events
+//
+// A change to the history is applied once after the whole batch of events, since saving
+//   the history produces several events. If the kernel's queue overflowed, events were
+//   lost and every topic is listed again.
+//
+void Notifier::Handle_Events()
+  {
+    char Buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool History_Changed = false;
+    bool Overflowed      = false;
+
+    for (;;) {
+      ssize_t Count = read(Events, Buffer, sizeof(Buffer));
+      if (Count <= 0) break;
+
+      for (char *Stepper = Buffer; Stepper < Buffer + Count; ) {
+        const struct inotify_event *Event = reinterpret_cast<const struct inotify_event *>(Stepper);
+        Stepper += sizeof(struct inotify_event) + Event->len;
+        const char *Name = (Event->len > 0) ? Event->name : "";
+
+        if (Event->mask & IN_Q_OVERFLOW) {
+          Overflowed = true;
+          continue;
+        }
+        if (Event->wd == History_Watch) {
+          if (History_Name == Name) History_Changed = true;
+          if (Event->wd != -1 && By_Watch.find(Event->wd) == By_Watch.end()) continue;
+        }
+
+        unordered_map<int, int>::iterator Found = By_Watch.find(Event->wd);
+        if (Found == By_Watch.end()) continue;
+        int Index = Found->second;
+
+        if (Event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+          // The directory itself is gone. Try again later.
+          if (!(Event->mask & IN_IGNORED)) inotify_rm_watch(Events, Event->wd);
+          By_Watch.erase(Found);
+          States[Index].Watch = -1;
+          States[Index].Notices.clear();
+          States[Index].Unread = 0;
+        }
+        else if (Event->mask & (IN_CREATE | IN_MOVED_TO)) Notice_Added(Index, Name);
+        else if (Event->mask & (IN_DELETE | IN_MOVED_FROM)) Notice_Removed(Index, Name);
+      }
+    }
+
+    if (History_Changed) Load_History();
+    for (size_t i = 0; i < States.size(); i++) {
+      if (States[i].Watch == -1) continue;
+      if (Overflowed) Rescan(static_cast<int>(i));
+      else if (History_Changed) Recount(static_cast<int>(i));
+    }
+  }
+
+
+//
+// Notifier::Answer
+//
+string Notifier::Answer(const string &Command) const
+  {
+    int Total_Unread = 0;
+    for (size_t i = 0; i < States.size(); i++) Total_Unread += States[i].Unread;
+
+    char   Number[64];
+    string Result;
+    if (Command == "count" || Command.empty()) {
+      sprintf(Number, "%d\n", Total_Unread);
+      Result = Number;
+    }
+    else if (Command == "topics") {
+      for (size_t i = 0; i < States.size(); i++) {
+        sprintf(Number, "%d %d ", States[i].Unread, static_cast<int>(States[i].Notices.size()));
+        Result += Number;
+        Result += States[i].Topic.Name + " " + States[i].Topic.Title + "\n";
+      }
+    }
+    else if (Command == "json") {
+      sprintf(Number, "{\"unread\": %d, \"topics\": [", Total_Unread);
+      Result = Number;
+      for (size_t i = 0; i < States.size(); i++) {
+        if (i != 0) Result += ",";
+        Result += "\n  {\"name\": " + JSON_String(States[i].Topic.Name);
+        Result += ", \"title\": " + JSON_String(States[i].Topic.Title);
+        sprintf(Number, ", \"readable\": %s, \"total\": %d, \"unread\": %d}",
+          (States[i].Watch != -1) ? "true" : "false",
+          static_cast<int>(States[i].Notices.size()),
+          States[i].Unread);
+        Result += Number;
+      }
+      Result += "\n]}\n";
+    }
+    else {
+      Result = "error: unknown command\n";
+    }
+    return Result;
+  }
+
+
+//
+// Make_Address
+//
+static bool Make_Address(const string &Path, struct sockaddr_un &Address)
+  {
+    memset(&Address, 0, sizeof(Address));
+    Address.sun_family = AF_UNIX;
+    if (Path.size() >= sizeof(Address.sun_path)) return false;
+    strcpy(Address.sun_path, Path.c_str());
+    return true;
+  }
+
+
+//
+// Ask
+//
+// Sends one command to a running notifier and copies the answer to the standard output.
+//
+static int Ask(const string &Socket_Path, const string &Command)
+  {
+    struct sockaddr_un Address;
+    if (!Make_Address(Socket_Path, Address)) return 2;
+
+    int Connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (Connection == -1 || connect(Connection, reinterpret_cast<struct sockaddr *>(&Address), sizeof(Address)) == -1) {
+      fprintf(stderr, "Can't connect to the notifier at %s: %s\n", Socket_Path.c_str(), strerror(errno));
+      if (Connection != -1) close(Connection);
+      return 2;
+    }
+
+    string Line = Command + "\n";
+    if (write(Connection, Line.data(), Line.size()) != static_cast<ssize_t>(Line.size())) {
+      close(Connection);
+      return 2;
+    }
+    shutdown(Connection, SHUT_WR);
+
+    char    Buffer[4096];
+    ssize_t Count;
+    while ((Count = read(Connection, Buffer, sizeof(Buffer))) > 0) {
+      fwrite(Buffer, 1, Count, stdout);
+    }
+    close(Connection);
+    return 0;
+  }
+
+
+//
+// Serve
+//
+// The main loop. Clients are expected to send their command at once; one that hasn't
+//   finished its line within a few seconds is dropped so it can't hold a slot forever.
+//   Answers are small and go out with a single write.
+//
+static int Serve(Notifier &The_Notifier, const string &Socket_Path)
+  {
+    const int Retry_Interval = 60 * 1000;
+      // How often to look for topic directories that were missing (milliseconds).
+
+    const int Client_Timeout = 5;
+      // Seconds a client has to send its command.
+
+    struct sockaddr_un Address;
+    if (!Make_Address(Socket_Path, Address)) {
+      fprintf(stderr, "The socket path is too long: %s\n", Socket_Path.c_str());
+      return 2;
+    }
+
+    // If a notifier already answers on the socket, leave it alone. A socket file that
+    //   refuses connections was left behind by a notifier that died, and is removed.
+    //
+    int Probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (Probe == -1) return 2;
+    if (connect(Probe, reinterpret_cast<struct sockaddr *>(&Address), sizeof(Address)) == 0) {
+      fprintf(stderr, "A notifier is already running on %s\n", Socket_Path.c_str());
+      close(Probe);
+      return 2;
+    }
+    if (errno == ECONNREFUSED) unlink(Socket_Path.c_str());
+    close(Probe);
+
+    int Listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (Listener == -1) return 2;
+    if (bind(Listener, reinterpret_cast<struct sockaddr *>(&Address), sizeof(Address)) == -1 ||
+        listen(Listener, 64) == -1) {
+      fprintf(stderr, "Can't listen on %s: %s\n", Socket_Path.c_str(), strerror(errno));
+      close(Listener);
+      return 2;
+    }
+
+    struct Client {
+      int    Connection;
+      string Request;
+      time_t Arrived;
+    };
+    vector<Client> Clients;
+
+    signal(SIGINT,  Request_Stop);
+    signal(SIGTERM, Request_Stop);
+    signal(SIGPIPE, SIG_IGN);
+
+    time_t Last_Retry = time(0);
+    while (!Stop_Requested) {
+      vector<struct pollfd> Waiting(2 + Clients.size());
+      Waiting[0].fd     = The_Notifier.Descriptor();
+      Waiting[0].events = POLLIN;
+      Waiting[1].fd     = Listener;
+      Waiting[1].events = POLLIN;
+      for (size_t i = 0; i < Clients.size(); i++) {
+        Waiting[2 + i].fd     = Clients[i].Connection;
+        Waiting[2 + i].events = POLLIN;
+      }
+
+      int Ready = poll(&Waiting[0], Waiting.size(), Clients.empty() ? Retry_Interval : 1000);
+      if (Ready == -1 && errno != EINTR) break;
+
+      if (Ready > 0 && (Waiting[0].revents & POLLIN)) The_Notifier.Handle_Events();
+
+      if (Ready > 0 && (Waiting[1].revents & POLLIN)) {
+        int Connection;
+        while ((Connection = accept4(Listener, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+          Client New_Client = { Connection, string(), time(0) };
+          Clients.push_back(New_Client);
+        }
+      }
+
+      // Answer the clients whose requests are complete. The new ones (past the end of
+      //   Waiting) are looked at on the next pass.
+      //
+      time_t Now = time(0);
+      for (size_t i = Clients.size(); i-- > 0; ) {
+        bool Finished = false;
+        if (2 + i < Waiting.size() && (Waiting[2 + i].revents & (POLLIN | POLLHUP | POLLERR))) {
+          char    Buffer[256];
+          ssize_t Count = read(Clients[i].Connection, Buffer, sizeof(Buffer));
+          if (Count > 0) Clients[i].Request.append(Buffer, Count);
+          Finished = (Count <= 0 || Clients[i].Request.find('\n') != string::npos);
+        }
+        if (Finished) {
+          string Command = Clients[i].Request.substr(0, Clients[i].Request.find_first_of("\r\n"));
+          string Reply   = The_Notifier.Answer(Command);
+          ssize_t Ignored = write(Clients[i].Connection, Reply.data(), Reply.size());
+          (void)Ignored;
+        }
+        if (Finished || Now - Clients[i].Arrived > Client_Timeout) {
+          close(Clients[i].Connection);
+          Clients.erase(Clients.begin() + i);
+        }
+      }
+
+      if (Now - Last_Retry >= Retry_Interval / 1000) {
+        The_Notifier.Retry_Missing();
+        Last_Retry = Now;
+      }
+    }
+
+    for (size_t i = 0; i < Clients.size(); i++) close(Clients[i].Connection);
+    close(Listener);
+    unlink(Socket_Path.c_str());
+    return 0;
+  }
+
+
+//
+// Main Program
+//
+int main(int argc, char **argv)
+  {
+    const char *Config_Name  = "/etc/nbread.cfg";
+    const char *Root         = 0;
+    const char *History_Name = 0;
+    const char *Socket_Name  = 0;
+    const char *Question     = 0;
+
+    int Argument = 1;
+    while (Argument < argc) {
+      if (strcmp(argv[Argument], "-q") == 0) {
+        Question = (Argument + 1 < argc) ? argv[Argument + 1] : "count";
+        Argument += 2;
+        continue;
+      }
+      if (Argument + 1 == argc || argv[Argument][0] != '-' || strlen(argv[Argument]) != 2) {
+        fprintf(stderr, "Usage: nbnotifyd [-c config] [-r root] [-f history] [-s socket]\n");
+        fprintf(stderr, "       nbnotifyd [-s socket] -q [count | topics | json]\n");
+        return 2;
+      }
+      const char *Value = argv[Argument + 1];
+      switch (argv[Argument][1]) {
+        case 'c': Config_Name  = Value; break;
+        case 'r': Root         = Value; break;
+        case 'f': History_Name = Value; break;
+        case 's': Socket_Name  = Value; break;
+        default:
+          fprintf(stderr, "Unknown option: %s\n", argv[Argument]);
+          return 2;
+      }
+      Argument += 2;
+    }
+
+    spica::read_config_files(Config_Name);
+
+    string Socket_Path;
+    if (Socket_Name != 0) Socket_Path = Socket_Name;
+    else if (spica::lookup_parameter("Notify_Socket") != 0) Socket_Path = *spica::lookup_parameter("Notify_Socket");
+    else if (getenv("XDG_RUNTIME_DIR") != 0) Socket_Path = string(getenv("XDG_RUNTIME_DIR")) + "/nbnotifyd.sock";
+    else {
+      char Default_Name[64];
+      sprintf(Default_Name, "/tmp/nbnotifyd-%u.sock", static_cast<unsigned>(getuid()));
+      Socket_Path = Default_Name;
+    }
+
+    if (Question != 0) return Ask(Socket_Path, Question);
+
+    // Work out where everything is, as nbunread does.
+    string Notice_Root;
+    if (Root != 0) Notice_Root = Root;
+    else if (getenv("NB") != 0) Notice_Root = getenv("NB");
+    else if (spica::lookup_parameter("Noticeboard_Root") != 0) Notice_Root = *spica::lookup_parameter("Noticeboard_Root");
+    else {
+      fprintf(stderr, "The noticeboard root is not known (use -r).\n");
+      return 2;
+    }
+
+    string History_File;
+    if (History_Name != 0) History_File = History_Name;
+    else if (spica::lookup_parameter("History_File") != 0) History_File = *spica::lookup_parameter("History_File");
+    else if (getenv("HOME") != 0) History_File = string(getenv("HOME")) + "/.nbread.hst";
+    else History_File = ".nbread.hst";
+
+    vector<Notify_Topic> Topics;
+    Notify_Configuration(Notice_Root, Topics);
+
+    Notifier The_Notifier(Topics, Notice_Root, History_File);
+    if (!The_Notifier.Start()) {
+      fprintf(stderr, "Can't start inotify: %s\n", strerror(errno));
+      return 2;
+    }
+    return Serve(The_Notifier, Socket_Path);
+  }
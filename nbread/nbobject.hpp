@@ -54,7 +54,11 @@ using namespace std;
 
 #include "history.hpp"
 #include "idinfo.hpp"
+#include "layout.hpp"
+#include "nbthread.hpp"
+#include "ntable.hpp"
 #include "str.hpp"
+#include "summary.hpp"
 
 //
 // class NB_Object
@@ -87,6 +91,9 @@ class TObject_List : public vector<NB_Topic *> {
     ~TObject_List();
 };
 
+// The entries in an NObject_List parallel the rows of a topic's Notice_Table. Notice
+//   objects are only created when a notice is opened so most entries are null.
+//
 class NObject_List : public vector<NB_Notice *> {
   public:
     ~NObject_List();
@@ -104,11 +111,12 @@ class NB_Topic : public NB_Object {
 
     virtual spica::String &Description();
 
-    void Populate_SubtopicLV(HWND);
+    void Populate_SubtopicLV(HWND, History *History_Database);
       // Fills a list view control with the necessary subtopic information.
 
     void Populate_NoticeLV(HWND, History *History_Database);
-      // Fills a list view control with the necessary notice information.
+      // Fills a list view control with the necessary notice information. If Threaded_View
+      //   is set the notices are arranged in conversation threads instead of by date.
 
     NB_Topic *Lookup_Subtopic(HWND);
       // Looks up a subtopic given list view double click information.
@@ -122,7 +130,24 @@ class NB_Topic : public NB_Object {
 
     void Mark_All(History *);
       // This function will mark all notices in the current topic as read.
-    
+
+    void Add_Notice(const char *Path, History *);
+      // Adds a newly posted notice to this topic and marks it as read.
+
+    void Refresh(History *);
+      // Rescans the topic directory for notices (and subtopics) that have appeared or
+      //   vanished since the directory was last read. Existing notices are kept.
+
+    int Notice_Count();
+    int Unread_Count(History *);
+      // Number of notices (and unread notices) directly in this topic.
+
+    void Notice_Read(int Row);
+      // Called by a notice in this topic when it is first marked as read.
+
+    const Notice_Table &Summaries() const { return Notices; }
+      // Read-only access to the summary table (rows may not have summaries yet).
+
   private:
     spica::String  Description_String; // Caches the description.
     bool         Description_Valid;  // =true when the cached description is valid.
@@ -131,34 +156,51 @@ class NB_Topic : public NB_Object {
     TObject_List Sub_Topics;         // This list is just for NB_Topic objects.
     NB_Topic    *Parent;             // Points at this topic's parent or NULL if no parent.
     spica::String  Parent_Name;        // The (modified) name of the parent.
-    NObject_List Topic_Contents;     // This list is for everything else.
+    Notice_Table Notices;            // Summary information for every notice, one row each.
+    NObject_List Topic_Contents;     // Notice objects for opened notices, indexed by row.
+    Thread_Forest Threads;           // Conversation threads over the rows with summaries.
     bool         Contents_Valid;     // =true when the both lists above are valid.
 
+    // Counters. Notice_Total is valid when Contents_Valid is true; Unread_Total is valid
+    //   when Unread_Valid is true. The subtree totals include this topic's own counts once
+    //   they are valid and are rolled up into every ancestor as they change.
+    //
+    int          Notice_Total;       // Number of notices in the table.
+    int          Unread_Total;       // Number of those notices not yet read.
+    bool         Unread_Valid;       // =true when Unread_Total agrees with the history.
+    int          Subtree_Notices;    // Notices in this topic and all counted subtopics.
+    int          Subtree_Unread;     // Unread notices in this topic and all counted subtopics.
+
     void Read_Directory();
-      // Scan the directory into Sub_Topics and Topic_Contents.
+      // Scan the directory into Sub_Topics and Notices.
+
+    void Load_Summaries();
+      // Fills in the summary of every row that doesn't have one yet.
+
+    void Install_Summary(int Row, const Notice_Summary &);
+      // Cleans up the raw headers of one notice and stores them in the table.
+
+    void Roll_Up(int Notice_Delta, int Unread_Delta);
+      // Applies a change in counts to this topic's subtree totals and those of all its
+      //   ancestors. This is O(depth).
 };
 
 
 //
 // class NB_Notice
 //
-// This class defines a notice.
+// This class defines a notice. Notice objects only exist for notices that have been
+//   opened; the summary information for all notices is kept in the topic's Notice_Table.
+//   The text of the notice is held by the Body_Cache, not by the notice object.
 //
 class NB_Notice : public NB_Object {
+  friend class NB_Topic;
+
   public:
-    NB_Notice(const char *Path) :
-        Processed  (false),
-        Have_Text  (false),
-        Notice_Path(Path),
-        Position   (0),
-        HOffset    (0)
-        { }
+    NB_Notice(NB_Topic *Topic, int Row);
 
     virtual spica::String &Description();
-    virtual spica::String &Poster_Name();
-    virtual spica::String &Date_String();
-    virtual spica::String &RawDate_String();
-      // Summary information for notices.
+      // Returns the notice's subject.
 
     virtual void Mark_AsRead(History *);
       // Causes this notice to mark itself as read in the history database.
@@ -167,34 +209,21 @@ class NB_Notice : public NB_Object {
       // Returns true if this notice has been read (as known by the given
       //   history database).
 
+    const spica::String &Path() const { return Notice_Path; }
+
     virtual void Redraw(const HWND &, const HDC &);
     virtual void VScroll(const HWND &, const WPARAM &, const int &);
     virtual void HScroll(const HWND &, const WPARAM &, const int &);
         
   private:
     spica::String         Notice_Path;
-    vector<spica::String> Notice_Text;
-    bool                Processed; // True after we have processed the summary information
-    bool                Have_Text; // True after we have read the notice text (also means we have summary)
-    int                 Position;  // Line number of top line in window. Zero based.
+    NB_Topic           *Owner;     // The topic containing this notice.
+    int                 Table_Row; // This notice's row in the owner's Notice_Table.
+    spica::String         Subject;   // Copied from the table when the notice is opened.
+    Text_Layout         Layout;    // Display rows of the body.
+    Layout_Anchor       Top;       // Display row at the top of the window.
+    int                 Scroll;    // Rows to move Top by at the next redraw.
     int                 HOffset;   // Column number of left edge. Zero based.
-    int                 Longest_Line;  // The length of the longest line in the notice.
-
-    // Following variables contain the information that the summary currently contains.
-    //   Eventually, priority and other options will be added. If objects are added to
-    //   these, also increment the value of Num_Objects. That is used as a cheap
-    //   optimization flag.  If the number of objects filled is equal to Num_Objects,
-    //   then we are done and can stop reading the file (skipping long posts, etc).
-    //
-    spica::String From;
-    spica::String Subject;
-    spica::String Date;
-    spica::String Raw_Date;  // This object is filled when 'Date' is filled.
-    static const int Num_Objects;
-
-    void Process_Summary();
-      // This function fills in the summary information above and sets Processed
-      //   to "true."
 };
 
 #endif
@@ -0,0 +1,152 @@
+/****************************************************************************
+FILE          : nbody.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the Notice_Body class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+#include "nbody.hpp"
+
+//
+// Notice_Body::Load
+//
+// The newline search uses memchr, which the run time library implements a word (or
+//   vector) at a time, rather than examining each character in a loop of our own. A final
+//   line without a newline is still a line.
+//
+bool Notice_Body::Load(const char *Path)
+  {
+    Line_Start.clear();
+    Longest = 0;
+    Decoded.clear();
+    Parts.clear();
+    View_Begin = View_End = 0;
+    if (!Text.Open(Path)) return false;
+    Header.Parse(Text.Begin(), Text.End());
+
+    View_Begin = Text.Begin();
+    View_End   = Text.End();
+    if (Decode_Mime()) {
+      View_Begin = Decoded.data();
+      View_End   = Decoded.data() + Decoded.size();
+    }
+
+    const char *Base    = View_Begin;
+    const char *Stepper = Base;
+    const char *Limit   = View_End;
+
+    while (Stepper < Limit) {
+      const char *End  = static_cast<const char *>(memchr(Stepper, '\n', Limit - Stepper));
+      const char *Next = (End == 0) ? Limit : End + 1;
+      if (End == 0) End = Limit;
+      if (End > Stepper && End[-1] == '\r') End--;
+
+      Line_Start.push_back(static_cast<unsigned>(Stepper - Base));
+      if (End - Stepper > Longest) Longest = static_cast<int>(End - Stepper);
+      Stepper = Next;
+    }
+    return true;
+  }
+
+
+//
+// Notice_Body::Line
+//
+// The end of a line is found from the start of the next one, so the terminator (and any
+//   carriage return before it) has to be trimmed off here.
+//
+const char *Notice_Body::Line(int Index, int &Length) const
+  {
+    const char *Start = View_Begin + Line_Start[Index];
+    const char *End   = (Index + 1 < Line_Count()) ? View_Begin + Line_Start[Index + 1] : View_End;
+
+    if (End > Start && End[-1] == '\n') End--;
+    if (End > Start && End[-1] == '\r') End--;
+    Length = static_cast<int>(End - Start);
+    return Start;
+  }
+
+
+//
+// Notice_Body::Decode_Mime
+//
+// Returns false if the notice can be displayed straight from the mapping. That is the
+//   case for plain text in 7bit or 8bit, which is what nbread itself posts. Otherwise the
+//   display text is built in Decoded: the headers as they are, followed by each plain text
+//   part decoded and a description of each of the other parts.
+//
+bool Notice_Body::Decode_Mime()
+  {
+    if (!Header.Is_Complete()) return false;
+
+    Mime_Reader Reader;
+    Mime_Part   Part;
+    bool Multipart = Reader.Open(Header, Header.Body(), Text.End());
+    if (!Multipart) {
+      Mime_Reader::Single_Part(Header, Header.Body(), Text.End(), Part);
+      if (Part.Is_Text() && Part.Encoding != "base64" && Part.Encoding != "quoted-printable") return false;
+    }
+
+    Decoded.assign(Text.Begin(), Header.Body());
+    bool More = Multipart ? Reader.Next_Part(Part) : true;
+    while (More) {
+      string Disposition = Mime_MediaType(Part.Headers.Value("Content-Disposition"));
+
+      if (Part.Media_Type == "text/plain" && Disposition != "attachment") {
+        Transfer_Decoder Decoder(Part.Encoding);
+        Decoder.Decode(Part.Content, Part.Content_End, Decoded);
+        Decoder.Finish(Decoded);
+        if (!Decoded.empty() && Decoded[Decoded.size() - 1] != '\n') Decoded += '\n';
+      }
+      else {
+        char Size_Text[64];
+        size_t Size = Part.Encoded_Size();
+        if (Part.Encoding == "base64") Size = Size / 4 * 3;
+        sprintf(Size_Text, (Size < 10240) ? "%lu bytes" : "%lu KB",
+          static_cast<unsigned long>((Size < 10240) ? Size : Size / 1024));
+
+        Decoded += "\n[Attachment ";
+        Decoded += Part.File_Name.empty() ? "(unnamed)" : Part.File_Name;
+        Decoded += ": ";
+        Decoded += Part.Media_Type;
+        Decoded += ", about ";
+        Decoded += Size_Text;
+        Decoded += "]\n\n";
+        Parts.push_back(Part);
+      }
+      More = Multipart && Reader.Next_Part(Part);
+    }
+    return true;
+  }
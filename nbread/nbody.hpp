@@ -0,0 +1,97 @@
+/****************************************************************************
+FILE          : nbody.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the Notice_Body class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+A Notice_Body is the text of a notice, mapped into memory, together with an
+index of where each line starts. Lines are located with a single pass over
+the mapping when the body is loaded; after that any line can be found in
+constant time without copying the text.
+
+MIME notices that need decoding (multipart, base64, or quoted printable)
+are the exception. Their headers and decoded text parts are copied into a
+display buffer, and every other part is shown as a one line description.
+Attachments are located but not decoded.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef NBODY_H
+#define NBODY_H
+
+#include <string>
+#include <vector>
+
+#include "header.hpp"
+#include "mapfile.hpp"
+#include "mime.hpp"
+
+class Notice_Body {
+  public:
+    Notice_Body() : View_Begin(0), View_End(0), Longest(0) { }
+
+    bool Load(const char *Path);
+      // Maps the notice file and indexes its lines. Returns false if the file can't be
+      //   opened (the body is then empty).
+
+    int Line_Count() const { return static_cast<int>(Line_Start.size()); }
+
+    int Longest_Line() const { return Longest; }
+      // The length of the longest line, not counting line terminators.
+
+    const char *Line(int Index, int &Length) const;
+      // Returns a pointer to the start of the given line (zero based) and sets Length to
+      //   its length without the terminator. The text is NOT null terminated.
+
+    std::size_t Size() const { return Text.Length() + Decoded.size(); }
+
+    const std::vector<Mime_Part> &Attachments() const { return Parts; }
+      // The parts of a MIME notice that are not displayed as text. Their content points
+      //   into the mapping and has not been decoded.
+
+    const Header_Block &Headers() const { return Header; }
+      // The notice's header fields. They point into the mapping, so they are valid as long
+      //   as the body is.
+
+  private:
+    Mapped_File           Text;
+    Header_Block          Header;
+    std::string           Decoded;     // Display text of a MIME notice (otherwise empty).
+    const char           *View_Begin;  // The text being displayed: the mapping or Decoded.
+    const char           *View_End;
+    std::vector<Mime_Part> Parts;
+    std::vector<unsigned> Line_Start;  // Offset of each line's first character.
+    int                   Longest;
+
+    bool Decode_Mime();
+
+    // Notice_Bodies can't be copied because Mapped_Files can't be.
+    Notice_Body(const Notice_Body &);
+    Notice_Body &operator=(const Notice_Body &);
+};
+
+#endif
@@ -32,14 +32,19 @@ Please send comments or bug reports to
 
 #include "environ.hpp"
 
+#include <limits.h>
 #include <stdlib.h>
+#include <fstream>
 #include <windows.h>
 #include <commctrl.h>
 
+#include "bcache.hpp"
 #include "config.hpp"
 #include "dialog.hpp"
 #include "global.hpp"
 #include "history.hpp"
+#include "logwrite.hpp"
+#include "metrics.hpp"
 #include "nbread.rh"
 #include "nbobject.hpp"
 #include "str.hpp"
@@ -73,9 +78,6 @@ const char * const Frame_ClassName  = "NBread_Frame";
 const char * const Topic_ClassName  = "NBread_Topic";
 const char * const Notice_ClassName = "NBread_Notice";
 
-// This points at the History object being used to manage read notices.
-static History *History_Database = 0;
-
 // This holds the handle to the image list. I apparently can't pass this
 // from the frame procedure to the WM_CREATE case of the topic procedure
 // via CreateMDIWindow(). Casts of HIMAGELIST to LPARAM and back
@@ -83,6 +85,15 @@ static History *History_Database = 0;
 //
 static HIMAGELIST Image_Handle;
 
+// The settings that are read again whenever the configuration files change. They are
+// resolved once so that rereading them doesn't search the name table.
+//
+static const spica::parameter_handle Trace_Level_Handle   = spica::resolve_parameter("Trace_Level");
+static const spica::parameter_handle Trace_File_Handle    = spica::resolve_parameter("Trace_File");
+static const spica::parameter_handle Threaded_View_Handle = spica::resolve_parameter("Threaded_View");
+static const spica::parameter_handle Wrap_Lines_Handle    = spica::resolve_parameter("Wrap_Lines");
+static const spica::parameter_handle Tab_Width_Handle     = spica::resolve_parameter("Tab_Width");
+
 //------------------------------------------------
 //           Internally Linked Functions
 //------------------------------------------------
@@ -116,6 +127,63 @@ static bool Get_Username(char *Buffer)
   }
 
 
+//
+// Apply_Tunables
+//
+// This function applies the settings that can be changed while the
+// program is running. It is called after the configuration files are
+// read and again whenever they are found to have changed. A setting
+// that has been removed from the files goes back to its default: the
+// defaults of the view settings are registered by Check_Configuration.
+//
+static void Apply_Tunables()
+  {
+    // The notice body cache reads its budget (Notice_Cache_Size) from the
+    // configuration snapshot itself.
+
+    // Traces deeper than this level are discarded (see the debug levels in
+    // notes.txt). Everything is kept unless the level is configured.
+    string *Trace_Level = spica::lookup_parameter(Trace_Level_Handle);
+    spica::set_traceThreshold(Trace_Level != 0 ? atoi(Trace_Level->c_str()) : INT_MAX);
+
+    // Timing spans are recorded if there is somewhere to save them.
+    spica::set_traceSpans(spica::lookup_parameter(Trace_File_Handle) != 0);
+
+    // Notices are listed by date unless the threaded view is asked for. These
+    // take effect in the windows opened afterwards.
+    string *Threading = spica::lookup_parameter(Threaded_View_Handle);
+    if (Threading != 0) Threaded_View = (*Threading == "yes" || *Threading == "true");
+
+    // Options for the notice window.
+    string *Wrapping = spica::lookup_parameter(Wrap_Lines_Handle);
+    if (Wrapping != 0) Wrap_Lines = (*Wrapping == "yes" || *Wrapping == "true");
+
+    string *Tab_Stops = spica::lookup_parameter(Tab_Width_Handle);
+    if (Tab_Stops != 0 && atoi(Tab_Stops->c_str()) > 0) Tab_Width = atoi(Tab_Stops->c_str());
+  }
+
+
+//
+// Show_Metrics
+//
+// This function writes the current totals of the metrics into the debug
+// window (and so into its log file, if it has one).
+//
+static void Show_Metrics()
+  {
+    spica::metrics_snapshot Snapshot;
+    vector<string>          Lines;
+
+    spica::collect_metrics(Snapshot);
+    spica::format_metrics(Snapshot, Lines);
+    for (vector<string>::iterator Stepper = Lines.begin(); Stepper != Lines.end(); Stepper++) {
+      spica::Win32::debugstream Message;
+      Message << "METRIC " << *Stepper;
+      Message.say(0);
+    }
+  }
+
+
 //
 // Check_Configuration
 //
@@ -126,9 +194,17 @@ static bool Get_Username(char *Buffer)
 //
 static void Check_Configuration()
   {
+    // Defaults for the settings Apply_Tunables() looks at, so that one
+    // taken out of the files while the program runs reverts to these.
+    spica::register_parameter("Threaded_View", "no", false);
+    spica::register_parameter("Wrap_Lines",    "no", false);
+    spica::register_parameter("Tab_Width",     "8",  false);
+
     // Read the configuration files.
     spica::read_config_files(MASTER_CONFIGPATH);
 
+    Apply_Tunables();
+
     // Do we have the required configuration items?
     string *Name    = spica::lookup_parameter("Full_Name");
     string *Address = spica::lookup_parameter("Email_Address");
@@ -283,7 +359,7 @@ static HWND Create_SubtopicLV(HINSTANCE Instance, HWND Topic_Window)
 
     Col.mask     = LVCF_FMT | LVCF_WIDTH | LVCF_TEXT | LVCF_SUBITEM;
     Col.fmt      = LVCFMT_LEFT;
-    Col.cx       = Topic_Rect.right;
+    Col.cx       = 3*Topic_Rect.right/5;
     Col.pszText  = "Subtopics";
     Col.iSubItem = 0;
 
@@ -292,6 +368,26 @@ static HWND Create_SubtopicLV(HINSTANCE Instance, HWND Topic_Window)
     if (Err == -1)
       throw spica::Win32::API_Error("Can't insert 'Topic' column into the subtopic listview");
 
+    Col.mask     = LVCF_FMT | LVCF_WIDTH | LVCF_TEXT | LVCF_SUBITEM;
+    Col.fmt      = LVCFMT_RIGHT;
+    Col.cx       = Topic_Rect.right/5;
+    Col.pszText  = "Notices";
+    Col.iSubItem = 1;
+
+    Err = ListView_InsertColumn(List_Window, 1, &Col);
+    if (Err == -1)
+      throw spica::Win32::API_Error("Can't insert 'Notices' column into the subtopic listview");
+
+    Col.mask     = LVCF_FMT | LVCF_WIDTH | LVCF_TEXT | LVCF_SUBITEM;
+    Col.fmt      = LVCFMT_RIGHT;
+    Col.cx       = Topic_Rect.right/5;
+    Col.pszText  = "Unread";
+    Col.iSubItem = 2;
+
+    Err = ListView_InsertColumn(List_Window, 2, &Col);
+    if (Err == -1)
+      throw spica::Win32::API_Error("Can't insert 'Unread' column into the subtopic listview");
+
     Tracer(3, "Finished creating the subtopic listview.");
     return List_Window;
   }
@@ -418,6 +514,9 @@ int WINAPI WinMain(
       Global::Set_CommandLine(Command_Line);
       Global::Set_CommandShow(Command_Show);
 
+      // If the program crashes, get the debug log onto the disk first.
+      spica::install_crashHandler();
+
       // These strings are initialized here to be sure the "Big String Lock"
       // has been initialized before these Strings are constructed. Also for
       // the destructor (actually these strings are currently not destoryed.
@@ -493,6 +592,21 @@ int WINAPI WinMain(
         }
       }
 
+      // Save the timing spans in the Chrome trace format.
+      string *Trace_File = spica::lookup_parameter(Trace_File_Handle);
+      if (Trace_File != 0) {
+        ofstream Output(Trace_File->c_str());
+        if (Output) spica::export_chromeTrace(Output);
+      }
+
+      // Save the metrics as JSON.
+      string *Metrics_File = spica::lookup_parameter("Metrics_File");
+      if (Metrics_File != 0) {
+        spica::metrics_snapshot Snapshot;
+        spica::collect_metrics(Snapshot);
+        ofstream Output(Metrics_File->c_str());
+        if (Output) spica::write_metricsJSON(Snapshot, Output);
+      }
     }
     catch (spica::Win32::API_Error We) {
       spica::Win32::notifystream Error_Message;
@@ -568,6 +682,10 @@ LRESULT CALLBACK Frame_Procedure(
             CLIENTCREATESTRUCT Client_Create;
             RECT               Frame_Rect;
 
+            // Show the initial state of the menu options.
+            CheckMenuItem(GetMenu(Frame_Window), MENU_THREADED, Threaded_View ? MF_CHECKED : MF_UNCHECKED);
+            CheckMenuItem(GetMenu(Frame_Window), MENU_WRAPLINES, Wrap_Lines ? MF_CHECKED : MF_UNCHECKED);
+
             Client_Create.hWindowMenu  = 0;
             Client_Create.idFirstChild = 100;
 
@@ -625,6 +743,9 @@ LRESULT CALLBACK Frame_Procedure(
                 Tracer(2, "Selected 'Topic|Post' menu item.");
 
                 DialogBox(Global::Get_Instance(), MAKEINTRESOURCE(POST_DIALOG), Frame_Window, Post_Dialog);
+
+                // The new notice (if any) is now part of the current topic. Show it.
+                SendMessage(Topic_Window, WM_USER + 1, 0, 0);
               }
               return 0;
 
@@ -641,18 +762,41 @@ LRESULT CALLBACK Frame_Procedure(
               }
               return 0;
 
+            case MENU_THREADED: {
+                Tracer(2, "Selected 'Topic|Threaded View' menu item.");
+                Threaded_View = !Threaded_View;
+                CheckMenuItem(GetMenu(Frame_Window), MENU_THREADED, Threaded_View ? MF_CHECKED : MF_UNCHECKED);
+                SendMessage(Topic_Window, WM_USER + 1, 0, 0);
+              }
+              return 0;
+
             case MENU_FOLLOWUP: {
                 Tracer(2, "Selected 'Notice|Followup' menu item.");
                 MessageBox(Frame_Window, "Not Implemented", "Sorry", MB_ICONEXCLAMATION);
               }
               return 0;
 
+            case MENU_WRAPLINES: {
+                Tracer(2, "Selected 'Notice|Wrap Lines' menu item.");
+                Wrap_Lines = !Wrap_Lines;
+                CheckMenuItem(GetMenu(Frame_Window), MENU_WRAPLINES, Wrap_Lines ? MF_CHECKED : MF_UNCHECKED);
+                RedrawWindow(Client_Window, 0, 0, RDW_INVALIDATE | RDW_ERASE | RDW_ALLCHILDREN);
+              }
+              return 0;
+
             case MENU_DEBUG: {
                 Tracer(2, "Selected 'Debug' menu item.");
                 spica::Win32::create_debugWindow();
               }
               return 0;
 
+            case MENU_METRICS: {
+                Tracer(2, "Selected 'Metrics' menu item.");
+                spica::Win32::create_debugWindow();
+                Show_Metrics();
+              }
+              return 0;
+
             case MENU_TILE: {
                 Tracer(2, "Selected 'Window|Tile' menu item.");
                 SendMessage(Client_Window, WM_MDITILE, 0, 0);
@@ -688,6 +832,16 @@ LRESULT CALLBACK Frame_Procedure(
           }
           break;
 
+        // The user has come back to the program. If the configuration
+        // files were edited in the meantime, pick up the new settings.
+        //
+        case WM_ACTIVATEAPP:
+          if (wParam && spica::reload_config_files()) {
+            Tracer(2, "Configuration files changed. Applying new settings.");
+            Apply_Tunables();
+          }
+          break;
+
         // The user is trying to close the application (or shut down Windows).
         case WM_QUERYENDSESSION:
         case WM_CLOSE:
@@ -775,7 +929,7 @@ LRESULT CALLBACK Topic_Procedure(
             Tracer(2, "Processing WM_CREATE for the topic window.");
             SubtopicLV_Handle = Create_SubtopicLV(Global::Get_Instance(), Topic_Window);
             NoticeLV_Handle   = Create_NoticeLV(Global::Get_Instance(), Topic_Window);
-            Current_Topic->Populate_SubtopicLV(SubtopicLV_Handle);
+            Current_Topic->Populate_SubtopicLV(SubtopicLV_Handle, History_Database);
             Current_Topic->Populate_NoticeLV(NoticeLV_Handle, History_Database);
 
             spica::String Title = "Topic: ";
@@ -826,6 +980,21 @@ LRESULT CALLBACK Topic_Procedure(
           Check_All(NoticeLV_Handle);
           return 0;
 
+        // This message is sent to us (by the frame window) when the contents of the current
+        // topic have changed, for example after a notice has been posted.
+        //
+        case WM_USER + 1: {
+            ListView_DeleteAllItems(SubtopicLV_Handle);
+            ListView_DeleteAllItems(NoticeLV_Handle);
+            Current_Topic->Populate_SubtopicLV(SubtopicLV_Handle, History_Database);
+            Current_Topic->Populate_NoticeLV(NoticeLV_Handle, History_Database);
+
+            spica::String Title = "Topic: ";
+            Title.append(Current_Topic->Description());
+            SetWindowText(Topic_Window, Title);
+          }
+          return 0;
+
         // This message is sent to us by the child list view controls.
         case WM_NOTIFY: {
             int          ID  = wParam;
@@ -844,7 +1013,8 @@ LRESULT CALLBACK Topic_Procedure(
                     if (New_Topic != 0) {
                       ListView_DeleteAllItems(SubtopicLV_Handle);
                       ListView_DeleteAllItems(NoticeLV_Handle);
-                      New_Topic->Populate_SubtopicLV(SubtopicLV_Handle);
+                      New_Topic->Refresh(History_Database);
+                      New_Topic->Populate_SubtopicLV(SubtopicLV_Handle, History_Database);
                       New_Topic->Populate_NoticeLV(NoticeLV_Handle, History_Database);
                       Current_Topic = New_Topic;
 
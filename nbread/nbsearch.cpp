@@ -0,0 +1,226 @@
+/****************************************************************************
+FILE          : nbsearch.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Full text search of the noticeboards.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+This console program maintains a full text index of every notice under a
+noticeboard root and answers queries against it. See ftindex.hpp for the
+query syntax.
+
+Usage:
+
+  nbsearch [-i index] -r root update    Index new and changed notices.
+  nbsearch [-i index] -r root rebuild   Index everything from scratch.
+  nbsearch [-i index] query ...         List the notices matching a query.
+
+The index file defaults to nbsearch.idx in the current directory. Build with
+the program's own modules, for example:
+
+  g++ -O2 -o nbsearch nbsearch.cpp ftindex.cpp header.cpp mapfile.cpp nbdir.cpp
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "ftindex.hpp"
+#include "header.hpp"
+#include "mapfile.hpp"
+#include "nbdir.hpp"
+
+//
+// class Notice_Collector
+//
+// Gathers every notice in the tree so that they can be compared with the index.
+//
+class Notice_Collector : public Topic_Visitor {
+  public:
+    vector<Notice_File> All_Notices;
+
+    virtual void Visit(const string &, const vector<Notice_File> &Notices)
+      {
+        All_Notices.insert(All_Notices.end(), Notices.begin(), Notices.end());
+      }
+};
+
+
+//
+// Index_Notice
+//
+// Adds one notice to the index. Returns false if the notice can't be read.
+//
+static bool Index_Notice(Fulltext_Index &Index, const Notice_File &Notice)
+  {
+    Mapped_File Text;
+    if (!Text.Open(Notice.Path.c_str())) return false;
+
+    Header_Block Headers;
+    const char *Body = Headers.Parse(Text.Begin(), Text.End());
+
+    Index.Add_Document(
+      Notice.Path,
+      Notice.Modified,
+      Headers.Value("Subject").c_str(),
+      Headers.Value("From").c_str(),
+      Body,
+      Text.End() - Body);
+    return true;
+  }
+
+
+//
+// Update_Index
+//
+static int Update_Index(const char *Index_Name, const char *Root, bool Rebuild)
+  {
+    Fulltext_Index Index;
+    if (!Rebuild && !Index.Load(Index_Name)) {
+      fprintf(stderr, "Can't load %s; building a new index.\n", Index_Name);
+    }
+
+    Notice_Collector Collector;
+    Walk_Noticeboard(Root, Collector);
+
+    // Notices that are still present (and unchanged) are marked as seen.
+    vector<bool> Seen(Index.Document_Count(), false);
+    int Added   = 0;
+    int Removed = 0;
+
+    for (size_t i = 0; i < Collector.All_Notices.size(); i++) {
+      const Notice_File &Notice = Collector.All_Notices[i];
+      int Number = Index.Find_Document(Notice.Path);
+      if (Number >= 0) {
+        if (Index.Document_Modified(Number) == Notice.Modified) {
+          Seen[Number] = true;
+          continue;
+        }
+        Index.Remove_Document(Number);
+        Removed++;
+      }
+      if (Index_Notice(Index, Notice)) Added++;
+    }
+
+    for (size_t Number = 0; Number < Seen.size(); Number++) {
+      if (!Seen[Number] && !Index.Is_Deleted(static_cast<int>(Number))) {
+        Index.Remove_Document(static_cast<int>(Number));
+        Removed++;
+      }
+    }
+
+    if (!Index.Save(Index_Name)) {
+      fprintf(stderr, "Can't write %s\n", Index_Name);
+      return 1;
+    }
+    printf("%d notices indexed, %d removed, %d in the index.\n",
+      Added, Removed, static_cast<int>(Collector.All_Notices.size()));
+    return 0;
+  }
+
+
+//
+// Run_Query
+//
+static int Run_Query(const char *Index_Name, const string &Query)
+  {
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+
+    Fulltext_Index Index;
+    if (!Index.Load(Index_Name)) {
+      fprintf(stderr, "Can't load %s\n", Index_Name);
+      return 1;
+    }
+
+    vector<int> Results;
+    string      Error;
+    if (!Index.Search(Query, Results, Error)) {
+      fprintf(stderr, "%s\n", Error.c_str());
+      return 1;
+    }
+
+    for (size_t i = 0; i < Results.size(); i++) {
+      printf("%s\n", Index.Document_Path(Results[i]).c_str());
+    }
+
+    long long Elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - Start).count();
+    fprintf(stderr, "%d notices (%lld ms)\n", static_cast<int>(Results.size()), Elapsed);
+    return Results.empty() ? 1 : 0;
+  }
+
+
+//
+// Main Program
+//
+int main(int argc, char **argv)
+  {
+    const char *Index_Name = "nbsearch.idx";
+    const char *Root       = 0;
+
+    int Argument = 1;
+    while (Argument < argc && argv[Argument][0] == '-' && argv[Argument][1] != '\0') {
+      if (Argument + 1 < argc && strcmp(argv[Argument], "-i") == 0) {
+        Index_Name = argv[Argument + 1];
+        Argument += 2;
+      }
+      else if (Argument + 1 < argc && strcmp(argv[Argument], "-r") == 0) {
+        Root = argv[Argument + 1];
+        Argument += 2;
+      }
+      else break;
+    }
+
+    if (Argument == argc) {
+      fprintf(stderr, "Usage: nbsearch [-i index] -r root update | rebuild\n");
+      fprintf(stderr, "       nbsearch [-i index] query ...\n");
+      return 2;
+    }
+
+    bool Update  = (strcmp(argv[Argument], "update" ) == 0);
+    bool Rebuild = (strcmp(argv[Argument], "rebuild") == 0);
+    if ((Update || Rebuild) && Argument + 1 == argc) {
+      if (Root == 0) {
+        fprintf(stderr, "The noticeboard root (-r) is required.\n");
+        return 2;
+      }
+      return Update_Index(Index_Name, Root, Rebuild);
+    }
+
+    // Everything else is the query.
+    string Query;
+    for (; Argument < argc; Argument++) {
+      if (!Query.empty()) Query += ' ';
+      Query += argv[Argument];
+    }
+    return Run_Query(Index_Name, Query);
+  }
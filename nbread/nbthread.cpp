@@ -0,0 +1,390 @@
+/****************************************************************************
+FILE          : nbthread.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the notice threading engine.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace std;
+
+#include "nbthread.hpp"
+
+//
+// Is_Prefix
+//
+// Returns true if the word at Subject (of the given length) is "Re", "Fw" or "Fwd" in any
+//   mixture of cases.
+//
+static bool Is_Prefix(const char *Subject, size_t Length)
+  {
+    static const char *const Prefixes[] = { "re", "fw", "fwd" };
+
+    for (size_t i = 0; i < sizeof(Prefixes) / sizeof(Prefixes[0]); i++) {
+      if (strlen(Prefixes[i]) != Length) continue;
+
+      size_t k = 0;
+      while (k < Length && tolower(static_cast<unsigned char>(Subject[k])) == Prefixes[i][k]) k++;
+      if (k == Length) return true;
+    }
+    return false;
+  }
+
+
+//
+// Base_Subject
+//
+// Removes any number of reply and forward prefixes ("Re:", "RE[2]:", "Fwd:") and folds the
+//   rest to lower case. Returns true if a prefix was removed.
+//
+static bool Base_Subject(const char *Subject, string &Result)
+  {
+    bool Is_Reply = false;
+
+    while (true) {
+      while (*Subject == ' ' || *Subject == '\t') Subject++;
+
+      const char *p = Subject;
+      while (isalpha(static_cast<unsigned char>(*p))) p++;
+      size_t Length = p - Subject;
+      if (!Is_Prefix(Subject, Length)) break;
+
+      // Allow a reply count such as "Re[2]:".
+      if (*p == '[') {
+        while (isdigit(static_cast<unsigned char>(*++p))) ;
+        if (*p != ']') break;
+        p++;
+      }
+      if (*p != ':') break;
+
+      Subject  = p + 1;
+      Is_Reply = true;
+    }
+
+    Result.clear();
+    for (; *Subject != '\0'; Subject++) {
+      Result += static_cast<char>(tolower(static_cast<unsigned char>(*Subject)));
+    }
+    while (!Result.empty() && isspace(static_cast<unsigned char>(Result[Result.size() - 1]))) {
+      Result.erase(Result.size() - 1);
+    }
+    return Is_Reply;
+  }
+
+
+//
+// Thread_Forest::Clear
+//
+void Thread_Forest::Clear()
+  {
+    Containers.clear();
+    By_ID.clear();
+    Display_Order.clear();
+    Order_Valid = false;
+  }
+
+
+//
+// Thread_Forest::Renumber
+//
+// The containers of deleted notices become placeholders. They keep their places in the
+//   threads so that replies to a deleted notice stay where they were.
+//
+void Thread_Forest::Renumber(const vector<int> &New_Rows)
+  {
+    for (vector<Container>::iterator Stepper = Containers.begin(); Stepper != Containers.end(); Stepper++) {
+      if (Stepper->Row == -1) continue;
+      Stepper->Row = (Stepper->Row < static_cast<int>(New_Rows.size())) ? New_Rows[Stepper->Row] : -1;
+    }
+    Order_Valid = false;
+  }
+
+
+//
+// Thread_Forest::New_Container
+//
+int Thread_Forest::New_Container()
+  {
+    Container Empty;
+    Empty.Row          = -1;
+    Empty.Parent       = -1;
+    Empty.First_Child  = -1;
+    Empty.Next_Sibling = -1;
+    Empty.Date         = 0;
+    Empty.Is_Reply     = false;
+    Containers.push_back(Empty);
+    return static_cast<int>(Containers.size()) - 1;
+  }
+
+
+//
+// Thread_Forest::Find_Container
+//
+// Returns the container for a message identifier, creating a placeholder if necessary.
+//
+int Thread_Forest::Find_Container(const string &ID)
+  {
+    unordered_map<string, int>::iterator Found = By_ID.find(ID);
+    if (Found != By_ID.end()) return Found->second;
+
+    int Index = New_Container();
+    By_ID[ID] = Index;
+    return Index;
+  }
+
+
+//
+// Thread_Forest::Is_Ancestor
+//
+// Returns true if Ancestor is Container or one of its ancestors.
+//
+bool Thread_Forest::Is_Ancestor(int Ancestor, int Container) const
+  {
+    while (Container != -1) {
+      if (Container == Ancestor) return true;
+      Container = Containers[Container].Parent;
+    }
+    return false;
+  }
+
+
+//
+// Thread_Forest::Set_Parent
+//
+// Moves Child under Parent (or makes it a root if Parent is -1). The caller makes sure
+//   this doesn't create a loop.
+//
+void Thread_Forest::Set_Parent(int Child, int Parent)
+  {
+    int Old_Parent = Containers[Child].Parent;
+    if (Old_Parent == Parent) return;
+
+    if (Old_Parent != -1) {
+      int *Link = &Containers[Old_Parent].First_Child;
+      while (*Link != Child) Link = &Containers[*Link].Next_Sibling;
+      *Link = Containers[Child].Next_Sibling;
+    }
+
+    Containers[Child].Parent       = Parent;
+    Containers[Child].Next_Sibling = -1;
+    if (Parent != -1) {
+      Containers[Child].Next_Sibling = Containers[Parent].First_Child;
+      Containers[Parent].First_Child = Child;
+    }
+  }
+
+
+//
+// Thread_Forest::Add
+//
+void Thread_Forest::Add(
+  int         Row,
+  const char *Message_ID,
+  const char *References,
+  const char *Subject,
+  long long   Date)
+  {
+    Order_Valid = false;
+
+    // Find this notice's container. A placeholder made when another notice referred to
+    //   this one is filled in. A duplicate identifier gets a container of its own.
+    //
+    int Self = -1;
+    if (*Message_ID != '\0') {
+      Self = Find_Container(Message_ID);
+      if (Containers[Self].Row != -1) Self = New_Container();
+    }
+    else {
+      Self = New_Container();
+    }
+
+    Containers[Self].Row      = Row;
+    Containers[Self].Date     = Date;
+    Containers[Self].Is_Reply = Base_Subject(Subject, Containers[Self].Subject);
+
+    // Link the references together, oldest first, without disturbing links that are
+    //   already known.
+    //
+    int         Previous = -1;
+    const char *Stepper  = References;
+    while (*Stepper != '\0') {
+      while (*Stepper == ' ') Stepper++;
+      const char *End = Stepper;
+      while (*End != '\0' && *End != ' ') End++;
+      if (End == Stepper) break;
+
+      int Reference = Find_Container(string(Stepper, End));
+      if (Reference != Self && Previous != -1 && Containers[Reference].Parent == -1 &&
+          !Is_Ancestor(Reference, Previous)) {
+        Set_Parent(Reference, Previous);
+      }
+      if (Reference != Self) Previous = Reference;
+      Stepper = End;
+    }
+
+    // This notice's own references are the best information about its parent, so they
+    //   replace any parent that was guessed earlier.
+    //
+    if (Previous != -1 && Is_Ancestor(Self, Previous)) Previous = -1;
+    Set_Parent(Self, Previous);
+  }
+
+
+//
+// Thread_Forest::Visible_Children
+//
+// Placeholders are never displayed. Their children are shown in their place.
+//
+void Thread_Forest::Visible_Children(int Parent, vector<int> &Result) const
+  {
+    for (int Child = Containers[Parent].First_Child; Child != -1; Child = Containers[Child].Next_Sibling) {
+      if (Containers[Child].Row != -1) Result.push_back(Child);
+      else Visible_Children(Child, Result);
+    }
+  }
+
+
+//
+// Thread_Forest::Build_Order
+//
+void Thread_Forest::Build_Order()
+  {
+    int Count = static_cast<int>(Containers.size());
+
+    // Find the notices that start threads and the visible children of every notice.
+    vector<int>          Tops;
+    vector<vector<int> > Children(Count);
+    for (int i = 0; i < Count; i++) {
+      if (Containers[i].Row == -1) {
+        if (Containers[i].Parent == -1) Visible_Children(i, Tops);
+        continue;
+      }
+      if (Containers[i].Parent == -1) Tops.push_back(i);
+      Visible_Children(i, Children[i]);
+    }
+
+    // Group threads by subject. The anchor for a subject is the earliest thread that isn't
+    //   a reply (or the earliest thread if they all are).
+    //
+    unordered_map<string, int> Anchors;
+    for (size_t i = 0; i < Tops.size(); i++) {
+      const Container &Top = Containers[Tops[i]];
+      if (Top.Subject.empty()) continue;
+
+      unordered_map<string, int>::iterator Found = Anchors.find(Top.Subject);
+      if (Found == Anchors.end()) {
+        Anchors[Top.Subject] = Tops[i];
+        continue;
+      }
+      const Container &Anchor = Containers[Found->second];
+      if ((Anchor.Is_Reply && !Top.Is_Reply) ||
+          (Anchor.Is_Reply == Top.Is_Reply && Top.Date < Anchor.Date)) {
+        Found->second = Tops[i];
+      }
+    }
+
+    vector<int> Remaining;
+    for (size_t i = 0; i < Tops.size(); i++) {
+      const Container &Top = Containers[Tops[i]];
+      int Anchor = Top.Subject.empty() ? Tops[i] : Anchors[Top.Subject];
+      if (Anchor != Tops[i] && Top.Is_Reply) Children[Anchor].push_back(Tops[i]);
+      else Remaining.push_back(Tops[i]);
+    }
+
+    // Find the most recent activity in each thread (children are finished before their
+    //   parents in a reversed preorder walk).
+    //
+    vector<int> Preorder;
+    vector<int> Pending(Remaining);
+    while (!Pending.empty()) {
+      int Next = Pending.back();
+      Pending.pop_back();
+      Preorder.push_back(Next);
+      Pending.insert(Pending.end(), Children[Next].begin(), Children[Next].end());
+    }
+    vector<long long> Latest(Count, 0);
+    for (vector<int>::reverse_iterator Stepper = Preorder.rbegin(); Stepper != Preorder.rend(); Stepper++) {
+      int i = *Stepper;
+      Latest[i] = max(Latest[i], Containers[i].Date);
+      for (size_t k = 0; k < Children[i].size(); k++) {
+        Latest[i] = max(Latest[i], Latest[Children[i][k]]);
+      }
+    }
+
+    // Sort the threads newest first and the replies oldest first.
+    struct By_Latest {
+      const vector<long long> *Latest;
+      bool operator()(int Left, int Right) const { return (*Latest)[Left] > (*Latest)[Right]; }
+    };
+    struct By_Date {
+      const vector<Container> *Containers;
+      bool operator()(int Left, int Right) const { return (*Containers)[Left].Date < (*Containers)[Right].Date; }
+    };
+    By_Latest Newest_First = { &Latest };
+    By_Date   Oldest_First = { &Containers };
+    stable_sort(Remaining.begin(), Remaining.end(), Newest_First);
+
+    // Emit the threads in order.
+    Display_Order.clear();
+    vector<pair<int, int> > Stack;
+    for (vector<int>::reverse_iterator Stepper = Remaining.rbegin(); Stepper != Remaining.rend(); Stepper++) {
+      Stack.push_back(make_pair(*Stepper, 0));
+    }
+    while (!Stack.empty()) {
+      int Index = Stack.back().first;
+      int Depth = Stack.back().second;
+      Stack.pop_back();
+
+      Thread_Entry Entry;
+      Entry.Row   = Containers[Index].Row;
+      Entry.Depth = Depth;
+      Display_Order.push_back(Entry);
+
+      vector<int> &Replies = Children[Index];
+      stable_sort(Replies.begin(), Replies.end(), Oldest_First);
+      for (vector<int>::reverse_iterator Stepper = Replies.rbegin(); Stepper != Replies.rend(); Stepper++) {
+        Stack.push_back(make_pair(*Stepper, Depth + 1));
+      }
+    }
+    Order_Valid = true;
+  }
+
+
+//
+// Thread_Forest::Order
+//
+const vector<Thread_Entry> &Thread_Forest::Order()
+  {
+    if (!Order_Valid) Build_Order();
+    return Display_Order;
+  }
@@ -0,0 +1,109 @@
+/****************************************************************************
+FILE          : nbthread.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the notice threading engine.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+A Thread_Forest arranges the notices of a topic into conversation threads.
+It follows the approach of Jamie Zawinski's threading algorithm: each notice
+is linked under the notice named by the last entry of its References (or
+In-Reply-To) header, and the intermediate references are linked to each
+other, with empty placeholders standing in for notices that aren't
+available. Message identifiers are kept in a hash table so adding a notice
+costs time proportional to the length of its references. Threads whose
+root notices have no identifiers in common are then grouped by subject:
+a "Re:" notice whose parent is missing joins the thread started by the
+original notice with the same subject.
+
+Notices can be added one at a time as they arrive. When the topic's rows
+are renumbered (after its directory is read again) the forest is renumbered
+in place, so only new notices have to be added. The display order is
+computed when it is asked for and is remembered until the forest changes.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef NBTHREAD_H
+#define NBTHREAD_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Thread_Entry {
+  int Row;    // The notice's row in the topic's Notice_Table.
+  int Depth;  // Zero for the notices that start threads.
+};
+
+class Thread_Forest {
+  public:
+    Thread_Forest() : Order_Valid(false) { }
+
+    void Clear();
+
+    void Add(
+      int         Row,
+      const char *Message_ID,
+      const char *References,
+      const char *Subject,
+      long long   Date
+    );
+      // Adds a notice to the forest. References lists ancestor identifiers, oldest first,
+      //   separated by spaces. Either may be empty.
+
+    void Renumber(const std::vector<int> &New_Rows);
+      // Moves every notice from row R to row New_Rows[R]. A notice whose new row is -1 (or
+      //   whose row is past the end of New_Rows) is removed.
+
+    const std::vector<Thread_Entry> &Order();
+      // Returns every notice in display order. Threads with the most recent activity come
+      //   first. Replies follow their parent, oldest first.
+
+  private:
+    struct Container {
+      int         Row;           // -1 for a placeholder.
+      int         Parent;        // -1 for a root.
+      int         First_Child;
+      int         Next_Sibling;
+      long long   Date;
+      std::string Subject;       // Subject with any "Re:" prefixes removed, in lower case.
+      bool        Is_Reply;      // =true if the subject had a "Re:" prefix.
+    };
+
+    std::vector<Container>               Containers;
+    std::unordered_map<std::string, int> By_ID;
+    std::vector<Thread_Entry>            Display_Order;
+    bool                                 Order_Valid;
+
+    int  New_Container();
+    int  Find_Container(const std::string &ID);
+    bool Is_Ancestor(int Ancestor, int Container) const;
+    void Set_Parent(int Child, int Parent);
+    void Visible_Children(int Parent, std::vector<int> &Result) const;
+    void Build_Order();
+};
+
+#endif
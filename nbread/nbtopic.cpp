@@ -32,10 +32,14 @@ Please send comments or bug reports to
 
 #include "environ.hpp"
 
+#include <cstdio>
 #include <ctime>
 #include <algorithm>
 #include <iomanip>
+#include <string>
 #include <strstream>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
@@ -45,9 +49,14 @@ using namespace std;
 #undef min
 #undef max
 
+#include "bcache.hpp"
+#include "global.hpp"
 #include "history.hpp"
+#include "metrics.hpp"
 #include "nbobject.hpp"
+#include "rfcdate.hpp"
 #include "str.hpp"
+#include "summary.hpp"
 #include "windebug.hpp"
 #include "winexcept.hpp"
 
@@ -61,8 +70,29 @@ using namespace std;
 //
 static TObject_List *Current_TList = 0;
 
-// Same hack as above, only this time for notices.
-static NObject_List *Current_NList = 0;
+// Same hack as above, only this time for notices. The notice list view is sorted using the
+// date keys in the topic's summary table.
+//
+static const Notice_Table *Current_NTable = 0;
+
+//
+// Path_Key
+//
+// Paths on the noticeboard are case insensitive. This returns the form used to look them up.
+//
+static string Path_Key(const char *Path)
+  {
+    string Key(Path);
+    for (string::iterator Stepper = Key.begin(); Stepper != Key.end(); Stepper++) {
+      *Stepper = static_cast<char>(toupper(static_cast<unsigned char>(*Stepper)));
+    }
+    return Key;
+  }
+
+static spica::metric_histogram Directory_Reads("topic.read_directory");
+static spica::metric_histogram Summary_Loads("topic.load_summaries");
+static spica::metric_counter   Notices_Found("topic.notices_found");
+static spica::metric_counter   Notices_Summarized("topic.notices_summarized");
 
 
 //
@@ -89,80 +119,21 @@ int CALLBACK Subtopic_Compare(LPARAM lParam1, LPARAM lParam2, LPARAM)
   }
 
 
-//
-// Month_Index
-//
-// This function returns an integer representing the month given to it as
-//   a three letter abbreviated name. It doesn't matter if this function
-//   returns indices that are zero based or one based. It is only the
-//   ordering that matters.
-//
-static int Month_Index(const spica::String &Month)
-  {
-    static const char *Names[] = {
-      "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec", 0 };
-
-    const char **p = Names;
-    while (*p != 0) {
-      if (strcmp(*p, Month) == 0) return p - Names;
-      p++;
-    }
-
-    // If we don't recognize the month return the "13th" month. This will force that entry
-    //   to the top of the display (for its year) and make the problem obvious.
-    //
-    return 13;
-  }
-
-
 //
 // Notice_Compare
 //
-// The following function is used by the notice list view to sort items.
+// The following function is used by the notice list view to sort items. Newer notices
+//   sort first.
 //
 int CALLBACK Notice_Compare(LPARAM        , LPARAM        , LPARAM); // CodeWarrior strangeness.
 int CALLBACK Notice_Compare(LPARAM lParam1, LPARAM lParam2, LPARAM)
   {
-    // Convert the LPARAMs into vector indicies.
-    int i1 = static_cast<int>(lParam1);
-    int i2 = static_cast<int>(lParam2);
-
-    // Look up the raw dates.
-    spica::String The_Date1 = (*Current_NList)[i1]->RawDate_String();
-    spica::String The_Date2 = (*Current_NList)[i2]->RawDate_String();
+    // Convert the LPARAMs into table rows.
+    long long Key1 = Current_NTable->Date_Key(static_cast<int>(lParam1));
+    long long Key2 = Current_NTable->Date_Key(static_cast<int>(lParam2));
 
-    // Convert the raw dates into something easier to compare.
-    // Mon, 23 Mar 1998 09:39:31 EST5EDT
-    //
-    int Day1    = atoi(The_Date1.word(2));
-    int Day2    = atoi(The_Date2.word(2));
-    int Month1  = Month_Index(The_Date1.word(3));
-    int Month2  = Month_Index(The_Date2.word(3));
-    int Year1   = atoi(The_Date1.word(4));
-    int Year2   = atoi(The_Date2.word(4));
-
-    spica::String Time1 = The_Date1.word(5);
-    spica::String Time2 = The_Date2.word(5);
-    int Hour1   = atoi(Time1.word(1, ":"));
-    int Hour2   = atoi(Time2.word(1, ":"));
-    int Minute1 = atoi(Time1.word(2, ":"));
-    int Minute2 = atoi(Time2.word(2, ":"));
-
-    // Now order them...
-    if (Year2 >  Year1) return 1;
-    if (Year2 == Year1) {
-      if (Month2 >  Month1) return 1;
-      if (Month2 == Month1) {
-        if (Day2 >  Day1) return 1;
-        if (Day2 == Day1) {
-          if (Hour2 >  Hour1) return 1;
-          if (Hour2 == Hour1) {
-            if (Minute2 >  Minute1) return 1;
-            if (Minute2 == Minute1) return  0;
-          }
-        }
-      }
-    }
+    if (Key2 >  Key1) return  1;
+    if (Key2 == Key1) return  0;
     return -1;
   }
 
@@ -175,7 +146,12 @@ NB_Topic::NB_Topic(const char *Path, NB_Topic *P) :
   Topic_ID         (Path),
   Contents_Valid   (false),
   Description_Valid(false),
-  Parent           (P)
+  Parent           (P),
+  Notice_Total     (0),
+  Unread_Total     (0),
+  Unread_Valid     (false),
+  Subtree_Notices  (0),
+  Subtree_Unread   (0)
   { }
 
 
@@ -185,7 +161,7 @@ NB_Topic::NB_Topic(const char *Path, NB_Topic *P) :
 // This function loads a list view control with information about all the
 //   subtopics in this topic.
 //
-void NB_Topic::Populate_SubtopicLV(HWND List_Window)
+void NB_Topic::Populate_SubtopicLV(HWND List_Window, History *History_Database)
   {
     Tracer(4, "Populating the subtopic list view.");
 
@@ -232,6 +208,23 @@ void NB_Topic::Populate_SubtopicLV(HWND List_Window)
 
       if (ListView_InsertItem(List_Window, &Item) == -1)
         throw spica::Win32::API_Error("Can't insert an item into the subtopic list view");
+
+      // Install the counts as subitems. The list view copies the text so the buffer can
+      //   be reused.
+      //
+      char Count_Buffer[16];
+      Item.mask       = LVIF_TEXT;
+      Item.iSubItem   = 1;
+      sprintf(Count_Buffer, "%d", (*Topic_Stepper)->Notice_Count());
+      Item.pszText    = Count_Buffer;
+      if (ListView_SetItem(List_Window, &Item) == FALSE)
+        throw spica::Win32::API_Error("Can't insert a subitem into the subtopic list view");
+
+      Item.iSubItem   = 2;
+      sprintf(Count_Buffer, "%d", (*Topic_Stepper)->Unread_Count(History_Database));
+      Item.pszText    = Count_Buffer;
+      if (ListView_SetItem(List_Window, &Item) == FALSE)
+        throw spica::Win32::API_Error("Can't insert a subitem into the subtopic list view");
     }
 
     // Now sort it.
@@ -248,42 +241,52 @@ void NB_Topic::Populate_SubtopicLV(HWND List_Window)
 //
 void NB_Topic::Populate_NoticeLV(HWND List_Window, History *History_Database)
   {
+    spica::Trace_Span Span("Populate_NoticeLV");
     Tracer(4, "Populating the notice list view.");
 
-    NObject_List::iterator Notice_Stepper;
-    int                    Index = 0;
-    LV_ITEM                Item;
+    LV_ITEM Item;
 
     if (!Contents_Valid) Read_Directory();
+    Load_Summaries();
+
+    // This also brings the read bits in the table up to date.
+    Unread_Count(History_Database);
 
     // Tell the list view ahead of time how many items we have. This allows it
     //   to allocate memory more efficiently. That is nice.
     //
-    int Item_Count = 0;
-    Item_Count += Sub_Topics.size();
-    ListView_SetItemCount(List_Window, Item_Count);
+    ListView_SetItemCount(List_Window, Notices.Size());
+
+    // In the threaded view the items are inserted in thread order and the list view is not
+    //   sorted afterwards. Replies are indented under the notice they answer.
+    //
+    const vector<Thread_Entry> *Order = Threaded_View ? &Threads.Order() : 0;
+    string Indented;
 
     // For all notices...
-    for (Notice_Stepper = Topic_Contents.begin(); Notice_Stepper != Topic_Contents.end(); Notice_Stepper++) {
+    int Item_Count = (Order == 0) ? Notices.Size() : static_cast<int>(Order->size());
+    for (int Index = 0; Index < Item_Count; Index++) {
+      int Row = (Order == 0) ? Index : (*Order)[Index].Row;
+
       Item.mask     = LVIF_TEXT | LVIF_PARAM | LVIF_IMAGE;
       Item.iItem    = Index;
       Item.iSubItem = 0;
 
-      Item.pszText    = const_cast<char *>(static_cast<const char *>((*Notice_Stepper)->Description()));
-      Item.lParam     = static_cast<LPARAM>(Index);
+      Item.pszText    = const_cast<char *>(Notices.Subject(Row));
+      Item.lParam     = static_cast<LPARAM>(Row);
 
-      // Has this notice been read?
-      if ((*Notice_Stepper)->Is_Read(History_Database)) {
-        // Item.state = (2 << 12) | LVIS_STATEIMAGEMASK;
-        // Item.stateMask = LVIS_STATEIMAGEMASK;
-        Item.iImage = 1;
-      }
-      else {
-        // Item.state = (1 << 12) | LVIS_STATEIMAGEMASK;
-        // Item.stateMask = LVIS_STATEIMAGEMASK;
-        Item.iImage = 0;
+      if (Order != 0 && (*Order)[Index].Depth > 0) {
+        const int Max_Depth = 16;
+          // Deeper replies are not indented any further so their subjects stay visible.
+
+        Indented.assign(2 * min((*Order)[Index].Depth, Max_Depth), ' ');
+        Indented.append(Notices.Subject(Row));
+        Item.pszText = const_cast<char *>(Indented.c_str());
       }
 
+      // Has this notice been read?
+      Item.iImage = Notices.Is_Read(Row) ? 1 : 0;
+
       if (ListView_InsertItem(List_Window, &Item) == -1)
         throw spica::Win32::API_Error("Can't insert an item into the notice list view");
 
@@ -291,21 +294,21 @@ void NB_Topic::Populate_NoticeLV(HWND List_Window, History *History_Database)
       Item.mask       = LVIF_TEXT;
       Item.iItem      = Index;
       Item.iSubItem   = 1;
-      Item.pszText    = const_cast<char *>(static_cast<const char *>((*Notice_Stepper)->Poster_Name()));
+      Item.pszText    = const_cast<char *>(Notices.Poster(Row));
       if (ListView_SetItem(List_Window, &Item) == FALSE)
         throw spica::Win32::API_Error("Can't insert a subitem into the notice list view");
 
       Item.iSubItem   = 2;
-      Item.pszText    = const_cast<char *>(static_cast<const char *>((*Notice_Stepper)->Date_String()));
+      Item.pszText    = const_cast<char *>(Notices.Display_Date(Row));
       if (ListView_SetItem(List_Window, &Item) == FALSE)
         throw spica::Win32::API_Error("Can't insert a subitem into the notice list view");
-
-      Index++;
     }
 
-    // Now sort it.
-    Current_NList = &Topic_Contents;
-    ListView_SortItems(List_Window, Notice_Compare, 0);
+    // Now sort it (unless it is already in thread order).
+    if (Order == 0) {
+      Current_NTable = &Notices;
+      ListView_SortItems(List_Window, Notice_Compare, 0);
+    }
   }
 
 
@@ -391,8 +394,20 @@ NB_Notice *NB_Topic::Lookup_Notice(HWND List_Window)
     Item.iSubItem = 0;
     ListView_GetItem(List_Window, &Item);
 
-    // Return the goods.
-    return Topic_Contents[static_cast<int>(Item.lParam)];
+    // Get the notice after this one (in the current sort order) loading in the background
+    //   so that it is ready if the user steps through the notices.
+    LV_ITEM Next_Item;
+    Next_Item.mask     = LVIF_PARAM;
+    Next_Item.iItem    = Hit_Info.iItem + 1;
+    Next_Item.iSubItem = 0;
+    if (ListView_GetItem(List_Window, &Next_Item)) {
+      Body_Cache::Instance().Prefetch(Notices.Path(static_cast<int>(Next_Item.lParam)));
+    }
+
+    // Return the goods. The notice object is created the first time it is opened.
+    int Row = static_cast<int>(Item.lParam);
+    if (Topic_Contents[Row] == 0) Topic_Contents[Row] = new NB_Notice(this, Row);
+    return Topic_Contents[Row];
   }
 
 
@@ -438,17 +453,314 @@ void NB_Topic::Mark_All(History *The_History)
   {
     Tracer(4, "Marking all notices as read in a topic");
 
-    NObject_List::iterator Stepper;
-    for (Stepper = Topic_Contents.begin(); Stepper != Topic_Contents.end(); Stepper++) {
-      (*Stepper)->Mark_AsRead(The_History);
+    // Go to the history directly so that the counters are adjusted once for the whole
+    //   topic rather than once per notice.
+    //
+    if (!Contents_Valid) Read_Directory();
+    for (int Row = 0; Row < Notices.Size(); Row++) {
+      The_History->Mark_Read(Notices.Path(Row));
+      Notices.Set_Read(Row, true);
     }
+
+    if (Unread_Valid) {
+      Roll_Up(0, -Unread_Total);
+      Unread_Total = 0;
+    }
+  }
+
+
+//
+// NB_Topic::Add_Notice
+//
+// The following function adds a notice that was just posted to this topic. The poster has
+//   obviously read it so it is marked as read in the history as well.
+//
+void NB_Topic::Add_Notice(const char *Path, History *The_History)
+  {
+    Tracer(4, "Adding a newly posted notice to a topic");
+
+    if (!Contents_Valid) Read_Directory();
+
+    // If the directory was read after the notice was written it is already here.
+    int Row = Notices.Find(Path);
+    if (Row == -1) {
+      Row = Notices.Add(Path);
+      Topic_Contents.push_back(0);
+      Notice_Total++;
+
+      // It counts as unread until it is marked below.
+      if (Unread_Valid) Unread_Total++;
+      Roll_Up(1, Unread_Valid ? 1 : 0);
+    }
+
+    if (!The_History->Has_Read(Path)) {
+      The_History->Mark_Read(Path);
+      Notice_Read(Row);
+    }
+  }
+
+
+//
+// NB_Topic::Refresh
+//
+// This function brings a topic that has already been read up to date with its directory.
+//   Notice objects that still exist are kept (along with their cached summaries). Notices
+//   that vanished are dropped and new ones are added. The counters are adjusted by the
+//   difference so nothing has to be recounted.
+//
+void NB_Topic::Refresh(History *The_History)
+  {
+    Tracer(4, "Refreshing a topic directory.");
+
+    if (!Contents_Valid) {
+      Read_Directory();
+      return;
+    }
+
+    // Remember what we have now and then let Read_Directory() build fresh lists.
+    TObject_List Old_Topics;
+    NObject_List Old_Notices;
+    Notice_Table Old_Table;
+    Old_Topics.swap(Sub_Topics);
+    Old_Notices.swap(Topic_Contents);
+    Old_Table.Swap(Notices);
+
+    // Read_Directory() rolls the new total into the ancestors. Back the old total out first
+    //   so the tree is not counted twice.
+    //
+    Roll_Up(-Notice_Total, 0);
+    Notice_Total = 0;
+    Read_Directory();
+
+    // Put the old objects back in place of the fresh ones wherever the paths match. This
+    //   preserves subtopic subtrees (and their counts).
+    //
+    unordered_map<string, int> Old_Index;
+    for (int i = 0; i < static_cast<int>(Old_Topics.size()); i++) {
+      Old_Index[Path_Key(Old_Topics[i]->Topic_Path)] = i;
+    }
+    for (TObject_List::iterator New = Sub_Topics.begin(); New != Sub_Topics.end(); New++) {
+      unordered_map<string, int>::iterator Found = Old_Index.find(Path_Key((*New)->Topic_Path));
+      if (Found == Old_Index.end() || Old_Topics[Found->second] == 0) continue;
+      delete *New;
+      *New = Old_Topics[Found->second];
+      Old_Topics[Found->second] = 0;
+    }
+
+    // Carry summaries, read bits, and open notice objects over to the new rows. The old rows
+    //   are looked up through a hash table so that a refresh is linear in the notice count.
+    //   The thread forest is kept; its rows are renumbered afterwards.
+    //
+    vector<int> New_Rows(Old_Table.Size(), -1);
+    Old_Index.clear();
+    for (int Old_Row = 0; Old_Row < Old_Table.Size(); Old_Row++) {
+      Old_Index[Path_Key(Old_Table.Path(Old_Row))] = Old_Row;
+    }
+    for (int Row = 0; Row < Notices.Size(); Row++) {
+      unordered_map<string, int>::iterator Found = Old_Index.find(Path_Key(Notices.Path(Row)));
+      if (Found == Old_Index.end()) {
+        if (Unread_Valid) Notices.Set_Read(Row, The_History->Has_Read(Notices.Path(Row)));
+        continue;
+      }
+      int Old_Row = Found->second;
+      New_Rows[Old_Row] = Row;
+
+      if (Old_Table.Has_Summary(Old_Row)) {
+        Notices.Set_Summary(
+          Row,
+          Old_Table.Subject(Old_Row),
+          Old_Table.Poster(Old_Row),
+          Old_Table.Display_Date(Old_Row),
+          Old_Table.Date_Key(Old_Row));
+        Notices.Set_Threading(Row, Old_Table.Message_ID(Old_Row), Old_Table.References(Old_Row));
+      }
+      Notices.Set_Read(Row, Old_Table.Is_Read(Old_Row));
+      if (Old_Notices[Old_Row] != 0) {
+        Topic_Contents[Row] = Old_Notices[Old_Row];
+        Topic_Contents[Row]->Table_Row = Row;
+        Old_Notices[Old_Row] = 0;
+      }
+    }
+
+    // Rows without summaries were never added to the forest. They are added when their
+    //   summaries are loaded.
+    //
+    Threads.Renumber(New_Rows);
+
+    // Don't leave the notice window pointing at a notice that is about to be deleted.
+    for (NObject_List::iterator Old = Old_Notices.begin(); Old != Old_Notices.end(); Old++) {
+      if (*Old != 0 && *Old == Current_Notice) Current_Notice = 0;
+    }
+
+    // Subtopics that disappeared take their counts with them.
+    for (TObject_List::iterator Old = Old_Topics.begin(); Old != Old_Topics.end(); Old++) {
+      if (*Old != 0) Roll_Up(-(*Old)->Subtree_Notices, -(*Old)->Subtree_Unread);
+    }
+
+    if (Unread_Valid) {
+      int Unread_Now = Notices.Unread_Count();
+      Roll_Up(0, Unread_Now - Unread_Total);
+      Unread_Total = Unread_Now;
+    }
+
+    // Whatever is left in the old lists is deleted by their destructors.
+  }
+
+
+//
+// NB_Topic::Notice_Count
+//
+int NB_Topic::Notice_Count()
+  {
+    if (!Contents_Valid) Read_Directory();
+    return Notice_Total;
+  }
+
+
+//
+// NB_Topic::Unread_Count
+//
+// The first call counts the unread notices by consulting the history. After that the count
+//   is maintained as notices are read, posted, or vanish.
+//
+int NB_Topic::Unread_Count(History *The_History)
+  {
+    if (!Contents_Valid) Read_Directory();
+    if (!Unread_Valid) {
+      Tracer(4, "Counting the unread notices in a topic.");
+
+      for (int Row = 0; Row < Notices.Size(); Row++) {
+        Notices.Set_Read(Row, The_History->Has_Read(Notices.Path(Row)));
+      }
+      Unread_Total = Notices.Unread_Count();
+      Unread_Valid = true;
+      Roll_Up(0, Unread_Total);
+    }
+    return Unread_Total;
+  }
+
+
+//
+// NB_Topic::Notice_Read
+//
+// A notice in this topic has just been marked as read for the first time.
+//
+void NB_Topic::Notice_Read(int Row)
+  {
+    if (!Unread_Valid || Notices.Is_Read(Row)) return;
+    Notices.Set_Read(Row, true);
+    Unread_Total--;
+    Roll_Up(0, -1);
+  }
+
+
+//
+// NB_Topic::Roll_Up
+//
+// The following function adds the given changes to the subtree totals of this topic and all
+//   its ancestors. Cached descriptions along the way are invalidated since they show counts.
+//
+void NB_Topic::Roll_Up(int Notice_Delta, int Unread_Delta)
+  {
+    for (NB_Topic *Stepper = this; Stepper != 0; Stepper = Stepper->Parent) {
+      Stepper->Subtree_Notices  += Notice_Delta;
+      Stepper->Subtree_Unread   += Unread_Delta;
+      Stepper->Description_Valid = false;
+    }
+  }
+
+
+//
+// NB_Topic::Load_Summaries
+//
+// The headers of every notice that doesn't have a summary yet are read as one batch (in
+//   parallel). The results are then cleaned up and stored on this thread.
+//
+void NB_Topic::Load_Summaries()
+  {
+    spica::Trace_Span   Span("Load_Summaries");
+    spica::metric_timer Timer(Summary_Loads);
+    vector<int>            Rows;
+    vector<string>         Paths;
+    vector<Notice_Summary> Results;
+
+    for (int Row = 0; Row < Notices.Size(); Row++) {
+      if (Notices.Has_Summary(Row)) continue;
+      Rows.push_back(Row);
+      Paths.push_back(Notices.Path(Row));
+    }
+    if (Rows.empty()) return;
+
+    Tracer(4, "Processing a batch of notices to extract their summaries.");
+    Read_Summaries(Paths, Results);
+    Notices_Summarized.add(Rows.size());
+
+    for (size_t i = 0; i < Rows.size(); i++) {
+      Install_Summary(Rows[i], Results[i]);
+    }
+  }
+
+
+//
+// NB_Topic::Install_Summary
+//
+// This function cleans up the raw headers of a notice and stores them in its row of the
+//   summary table.
+//
+void NB_Topic::Install_Summary(int Row, const Notice_Summary &Raw)
+  {
+    // If we can't open the posting file for some strange reason, let the
+    //   user know by sending back a message as the notice summary.
+    //
+    if (!Raw.Opened) {
+      spica::String Subject = "Unable to open notice: ";
+      Subject.append(Notices.Path(Row));
+      Notices.Set_Summary(Row, Subject, "UNKNOWN Poster", "UNKNOWN Date", 0);
+      Threads.Add(Row, "", "", "", 0);
+      return;
+    }
+
+    spica::String Subject = Raw.Subject.empty() ? "UNKNOWN Subject" : Raw.Subject.c_str();
+    spica::String From    = Raw.From.empty()    ? "UNKNOWN Poster"  : Raw.From.c_str();
+    spica::String Date    = Raw.Date.empty()    ? "UNKNOWN Date"    : Raw.Date.c_str();
+
+    // Clean up the "From" string a bit.
+    int Angle_Bracket = From.pos('<');
+    spica::String Clean_Name = From.substr(1, Angle_Bracket - 1);
+    Clean_Name = Clean_Name.strip();
+    Clean_Name = Clean_Name.strip('B', '"');
+
+    // Dates are kept as UTC seconds for sorting and shown in local time. If the date
+    //   can't be understood it is shown as is and sorts as the oldest.
+    //
+    static Date_Parser Dates;
+    long long     UTC_Seconds;
+    spica::String Clean_Date = Date;
+    if (Dates.To_UTC(Date, UTC_Seconds)) {
+      static const char *Month_Names[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+      time_t     Raw_Time = static_cast<time_t>(UTC_Seconds);
+      struct tm *Local    = localtime(&Raw_Time);
+      if (Local != 0) {
+        char Buffer[32];
+        sprintf(Buffer, "%s %d, %02d:%02d",
+          Month_Names[Local->tm_mon], Local->tm_mday, Local->tm_hour, Local->tm_min);
+        Clean_Date = Buffer;
+      }
+    }
+
+    Notices.Set_Summary(Row, Subject, Clean_Name, Clean_Date, UTC_Seconds);
+    Notices.Set_Threading(Row, Raw.Message_ID.c_str(), Raw.References.c_str());
+    Threads.Add(Row, Raw.Message_ID.c_str(), Raw.References.c_str(), Subject, UTC_Seconds);
   }
 
 
 //
 // NB_Topic::Description
 //
-// The following function returns a description string for the topic.
+// The following function returns a description string for the topic. If any subtopics have
+//   been counted (they are counted when they are listed or opened) their totals are shown too.
 //
 spica::String &NB_Topic::Description()
   {
@@ -461,8 +773,13 @@ spica::String &NB_Topic::Description()
       if (!Contents_Valid) Read_Directory();
 
       Formatter << Topic_ID.Long_Name()
-                << " (entities = " << (Sub_Topics.size() + Topic_Contents.size()) << ")"
-                << ends;
+                << " (entities = " << (Sub_Topics.size() + Notice_Total);
+      if (Unread_Valid)
+        Formatter << ", unread = " << Unread_Total;
+      if (Subtree_Notices != Notice_Total || Subtree_Unread != (Unread_Valid ? Unread_Total : 0))
+        Formatter << "; with subtopics: notices = " << Subtree_Notices
+                  << ", unread = " << Subtree_Unread;
+      Formatter << ")" << ends;
 
       char  *p = Formatter.str();
       Description_String = p;
@@ -476,10 +793,12 @@ spica::String &NB_Topic::Description()
 //
 // Read_Directory
 //
-// This function scans the directory specified by path and creates the Topic_Contents.
+// This function scans the directory specified by path and creates the summary table rows.
 //
 void NB_Topic::Read_Directory()
   {
+    spica::Trace_Span   Span("Read_Directory");
+    spica::metric_timer Timer(Directory_Reads);
     Tracer(4, "Reading a topic directory.");
 
     spica::String     WildCard_Name;
@@ -540,14 +859,17 @@ void NB_Topic::Read_Directory()
       if ((Scan_Information.dwFileAttributes &  FILE_ATTRIBUTE_ARCHIVE) ||
           (Scan_Information.dwFileAttributes == 0 )) {
 
-        NB_Notice *New_Notice = new NB_Notice(static_cast<const char *>(Entity_Name));
-        Topic_Contents.push_back(New_Notice);
+        Notices.Add(static_cast<const char *>(Entity_Name));
+        Topic_Contents.push_back(0);
       }
     } while (FindNextFile(Search_Handle, &Scan_Information));
 
     // Close down the search handle.
     FindClose(Search_Handle);
 
+    Notice_Total   = Notices.Size();
+    Notices_Found.add(Notice_Total);
+    Roll_Up(Notice_Total, 0);
     Contents_Valid = true;
   }
 
@@ -0,0 +1,168 @@
+/****************************************************************************
+FILE          : nbunread.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Console front end for the unread notice counter.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+This console program prints the number of unread notices in each of the
+topics listed in the configuration (see unread.hpp). It is meant for login
+scripts and the like, so it is quiet when there is nothing to report.
+
+Usage:
+
+  nbunread [-c config] [-r root] [-f history] [-C cache] [-j threads] [-o text | json]
+
+  -c   The configuration file (default /etc/nbread.cfg).
+  -r   The noticeboard root. Otherwise $NB or Noticeboard_Root is used.
+  -f   The history file. Otherwise History_File or $HOME/.nbread.hst is used.
+       If the history was written by nbread on another machine, set
+       History_Root to the noticeboard root as nbread saw it (see unread.hpp).
+  -C   The count cache. Otherwise Unread_Cache or $HOME/.nbread.cnt is used.
+       Give an empty name to do without.
+  -j   Number of directories listed at once (the default depends on the
+       hardware).
+  -o   Output format. Text lists only the topics with unread notices; json
+       describes every topic.
+
+The exit status is 0 if there are unread notices, 1 if there are none, and
+2 if something went wrong. With the cache, directories that haven't changed
+since the last run aren't listed, and if none have changed the history isn't
+even read. Build with, for example:
+
+  g++ -O2 -pthread -o nbunread nbunread.cpp unread.cpp nbdir.cpp history.cpp str.cpp config.cpp metrics.cpp
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "config.hpp"
+#include "history.hpp"
+#include "unread.hpp"
+
+//
+// Main Program
+//
+int main(int argc, char **argv)
+  {
+    const char *Config_Name  = "/etc/nbread.cfg";
+    const char *Root         = 0;
+    const char *History_Name = 0;
+    const char *Cache_Name   = 0;
+    int         Thread_Count = 0;
+    bool        JSON         = false;
+
+    for (int Argument = 1; Argument < argc; Argument += 2) {
+      if (Argument + 1 == argc || argv[Argument][0] != '-' || strlen(argv[Argument]) != 2) {
+        fprintf(stderr, "Usage: nbunread [-c config] [-r root] [-f history] [-C cache] [-j threads] [-o text | json]\n");
+        return 2;
+      }
+      const char *Value = argv[Argument + 1];
+      switch (argv[Argument][1]) {
+        case 'c': Config_Name  = Value; break;
+        case 'r': Root         = Value; break;
+        case 'f': History_Name = Value; break;
+        case 'C': Cache_Name   = Value; break;
+        case 'j': Thread_Count = atoi(Value); break;
+        case 'o':
+          if      (strcmp(Value, "json") == 0) JSON = true;
+          else if (strcmp(Value, "text") == 0) JSON = false;
+          else {
+            fprintf(stderr, "Unknown output format: %s\n", Value);
+            return 2;
+          }
+          break;
+        default:
+          fprintf(stderr, "Unknown option: %s\n", argv[Argument]);
+          return 2;
+      }
+    }
+
+    spica::read_config_files(Config_Name);
+
+    // Work out where everything is.
+    string Notice_Root;
+    if (Root != 0) Notice_Root = Root;
+    else if (getenv("NB") != 0) Notice_Root = getenv("NB");
+    else if (spica::lookup_parameter("Noticeboard_Root") != 0) Notice_Root = *spica::lookup_parameter("Noticeboard_Root");
+    else {
+      fprintf(stderr, "The noticeboard root is not known (use -r).\n");
+      return 2;
+    }
+
+    string History_File;
+    if (History_Name != 0) History_File = History_Name;
+    else if (spica::lookup_parameter("History_File") != 0) History_File = *spica::lookup_parameter("History_File");
+    else if (getenv("HOME") != 0) History_File = string(getenv("HOME")) + "/.nbread.hst";
+    else History_File = ".nbread.hst";
+
+    string Cache_File;
+    if (Cache_Name != 0) Cache_File = Cache_Name;
+    else if (spica::lookup_parameter("Unread_Cache") != 0) Cache_File = *spica::lookup_parameter("Unread_Cache");
+    else if (getenv("HOME") != 0) Cache_File = string(getenv("HOME")) + "/.nbread.cnt";
+
+    History_Source       Read_Notices(History_File, Notice_Root);
+    Unread_Cache         Cache;
+    vector<Notify_Topic> Topics;
+    vector<Unread_Count> Counts;
+
+    if (!Cache_File.empty()) Cache.Load(Cache_File.c_str());
+    Notify_Configuration(Notice_Root, Topics);
+    Count_Unread(Topics, Read_Notices, Counts, Cache_File.empty() ? 0 : &Cache, Thread_Count);
+    if (!Cache_File.empty()) Cache.Save(Cache_File.c_str());
+
+    int Total_Unread = 0;
+    for (size_t i = 0; i < Counts.size(); i++) Total_Unread += Counts[i].Unread;
+
+    if (JSON) {
+      printf("{\"unread\": %d, \"topics\": [", Total_Unread);
+      for (size_t i = 0; i < Topics.size(); i++) {
+        printf("%s\n  {\"name\": %s, \"title\": %s, \"readable\": %s, \"total\": %d, \"unread\": %d}",
+          (i == 0) ? "" : ",",
+          JSON_String(Topics[i].Name).c_str(),
+          JSON_String(Topics[i].Title).c_str(),
+          Counts[i].Readable ? "true" : "false",
+          Counts[i].Total,
+          Counts[i].Unread);
+      }
+      printf("\n]}\n");
+    }
+    else {
+      for (size_t i = 0; i < Topics.size(); i++) {
+        if (Counts[i].Unread == 0) continue;
+        printf("%3d UNREAD: %s\n", Counts[i].Unread, Topics[i].Title.c_str());
+      }
+    }
+    return (Total_Unread > 0) ? 0 : 1;
+  }
@@ -57,7 +57,7 @@ int Display_Message(char *Text, Message *Topic_Index, int Current, int Max)
 
   // Display the status line at the top of the screen.
   ScrClear    (INFO_ROW,  1, 80, 1, INFO_COLOR);
-  ScrPrintText(INFO_ROW,  7, 80 - 7, Msg_Info->Subject_Line);
+  ScrPrintText(INFO_ROW,  7, 80 - 7, "%.*s", Msg_Info->Subject_Line.Length, Msg_Info->Subject_Line.Start);
   ScrPrintText(INFO_ROW, 70, 10, "F1 = HELP");
 
   // Draw the box around the message area.
@@ -71,14 +71,16 @@ int Display_Message(char *Text, Message *Topic_Index, int Current, int Max)
     if (*Temp_Text == '\n') Line_Count++;
 
   // Display the username of the message's author and the size of the message.
-  sprintf (Work_Buffer, " From: %s (%d lines)", Msg_Info->Username, Line_Count);
+  sprintf (Work_Buffer, " From: %.*s (%d lines)",
+    Msg_Info->Username.Length > 40 ? 40 : Msg_Info->Username.Length, Msg_Info->Username.Start, Line_Count);
   Len = strlen(Work_Buffer);
   ScrPrint(BOTTOM_LINE, 3,       1, MESSAGE_COLOR, "");
   ScrPrint(BOTTOM_LINE, 4+(Len), 1, MESSAGE_COLOR, "", MESSAGE_COLOR);
   ScrPrint(BOTTOM_LINE, 4,       Len, BORDER_INFO_COLOR, Work_Buffer);
 
   // Display the date the message was posted.
-  sprintf (Work_Buffer, " Date: %s ", Msg_Info->Date_String);
+  sprintf (Work_Buffer, " Date: %.*s ",
+    Msg_Info->Date_String.Length > 40 ? 40 : Msg_Info->Date_String.Length, Msg_Info->Date_String.Start);
   Len = strlen(Work_Buffer);
   ScrPrint(BOTTOM_LINE, WINDOW_WIDTH-1-Len, 1, MESSAGE_COLOR, "");
   ScrPrint(BOTTOM_LINE, WINDOW_WIDTH,       1, MESSAGE_COLOR, "");
@@ -146,7 +148,7 @@ int Display_Message(char *Text, Message *Topic_Index, int Current, int Max)
 
       case K_CPGDN:
         if (Current < Max)
-          if (Topic_Index[Current+1].Username != NULL) return Current+1;
+          if (Topic_Index[Current+1].Username.Start != NULL) return Current+1;
         break;
 
       case K_DOWN:
@@ -39,9 +39,10 @@ defined on the command line as necessary.
 #define WATCOM      5  // v11.0 assumed.
 #define GCC         6
 
-// Choose your compiler. This file can autodetect Borland C++ and Watcom C/C++.
-//   Any other compiler type must be specified on the compiler's command line.
-//   The default is "VANILLA."
+// Choose your compiler. This file can autodetect Borland C++, Watcom C/C++,
+//   and gcc (or a compiler, such as clang, that presents itself as gcc). Any
+//   other compiler type must be specified on the compiler's command line. The
+//   default is "VANILLA."
 //
 #if defined(__BORLANDC__)
 #if __BORLANDC__ == 0x460       // v4.52
@@ -61,6 +62,10 @@ defined on the command line as necessary.
 #endif
 #endif
 
+#if defined(__GNUC__) && !defined(COMPILER)
+#define COMPILER GCC
+#endif
+
 #if !defined(COMPILER)
 #define COMPILER VANILLA
 #endif
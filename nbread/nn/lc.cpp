@@ -37,12 +37,10 @@ first semester experience evaluation program. Before compiling, you must
 #include "portscr.h"
 #include "position.h"
 #include "sbox.h"
+#include "tindex.h"
 #include "topics.h"
 #include "utility.h"
 
-#define MAX_MESSAGES 250
-  // Maximum number of messages in one topic file.
-
 // Name of the file containing the list of topics.
 #if LC
 #define MASTERTOPIC_FILE "S:\\LC\\STUDENTS.LST"
@@ -64,8 +62,11 @@ first semester experience evaluation program. Before compiling, you must
 #define TEMP_FILE "F:\\FSETMP.$$$"
 #endif
 
-Message Topic_Index[MAX_MESSAGES+1];
-  // Always a NULL message at the end.
+Topic_Indexer Topic_Messages;
+  // The index of the current topic.
+
+Message *Topic_Index;
+  // The current topic's messages. Always a NULL message at the end.
 
 char Username[MAX_DN_CHARS];
   // The name of the invoking user.
@@ -295,107 +296,19 @@ int Choose_Topic(Topic_File *Topic_List, int *Max_Topic, int Topic_Number, int *
 }
 
 
-//
-// Extract_MessageDate
-//
-// The following function takes the Date_String in a Message and figures out
-//   what the computable date is. It installs the result into the same Message
-//   under Posted_On.
-//
-void Extract_MessageDate(Message *The_Message)
-  {
-    char Day_Name[80+1];    // Sun, Mon, etc...
-    char Month_Name[80+1];  // Jan, Feb, etc...
-      // The above are larger than needed to protect against problems if
-      //   a topic administrator accidently edits a date to the incorrect
-      //   format. For example, "Thurs" has been used by accident instead
-      //   of "Thu"
-
-    static const Date Dummy = { 1, 1, 0, 0, 1992 };
-      // Placeholder date/time: January 1, 0 hours 0 minutes (midnight) 1992.
-
-    static const char *Month_Names[] = {
-      "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
-      NULL
-      };
-    const char **Search;
-
-    // Make sure the fields are garbage in case the sscanf()s below
-    //   can't read everything they've been asked to read.
-    The_Message->Posted_On = Dummy;
-
-    // If we have a new style message...
-    if (strchr(The_Message->Date_String, ':') != NULL) {
-      sscanf(The_Message->Date_String, "%s %s %d %d:%d %d", Day_Name, Month_Name,
-        &The_Message->Posted_On.Day,
-        &The_Message->Posted_On.Hour,
-        &The_Message->Posted_On.Minute,
-        &The_Message->Posted_On.Year      // Will be 1992 if no year provided.
-        );
-    }
-    else {
-      // We have an old style message (no hours and minutes).
-      sscanf(The_Message->Date_String, "%s %s %d %d", Day_Name, Month_Name,
-        &The_Message->Posted_On.Day,
-        &The_Message->Posted_On.Year
-        );
-      // Let Hour and Minute be 0, 0 from the Dummy Message_Date object.
-    }
-
-    // Figure out the month number.
-    Search = Month_Names;
-    while (*Search != NULL) {
-      if (strcmp(*Search, Month_Name) == 0) {
-        The_Message->Posted_On.Month = (Search - Month_Names) + 1;
-        break;
-      }
-      Search++;
-    }
-    // Let unknown months be handled as Jan from the Dummy Message_Data object.
-  }
-
-
 //
 // Index_Topics
 //
-// The following function computes an index of the selected topic file.
+// The following function computes an index of the selected topic file. The
+//   messages are left in Topic_Index.
 //
-int Index_Topics(char *File_Name, Message *Topic_Index, int Max_Size)
+int Index_Topics(char *File_Name)
   {
-    int   Count = 0;  /* Zero messages in this topic initially. */
-    int   i;
+    int   Count;
     char *Wait_Message;
     int   Message_Size;
-    FILE *Info;
-    char  Line_Buffer[256+2];
     Simple_Window Teaser;
 
-    // These objects are used for list reversal.
-    Message Temp,
-    *First_Message = Topic_Index,
-    *Last_Message;
-
-    // Erase the current index. This is important because the rest of the
-    //   program depends on the last part of the index being zero. Note
-    //   that only the Username field is significant in this regard. Note
-    //   also that it is assumed that there is a Topic_Index[Max_Size]. This
-    //   insures that even with Max_Size messages, there is a null entry.
-    //   at the end.
-    //
-    //   All fields that have dynamic data associated with them are freed
-    //   and set to NULL (so that a latter free will not screw up.)
-
-    for (i = 0; i <= Max_Size; i++) {
-      free(Topic_Index[i].Username);
-      free(Topic_Index[i].Date_String);
-      free(Topic_Index[i].Subject_Line);
-
-      Topic_Index[i].Username = NULL;
-      Topic_Index[i].Date_String = NULL;
-      Topic_Index[i].Subject_Line = NULL;
-    }
-
     // Tell the user what we're up to.
     Construct_SWin(&Teaser);
 
@@ -404,77 +317,8 @@ int Index_Topics(char *File_Name, Message *Topic_Index, int Max_Size)
     Open_SWin(&Teaser, 12, (80 - Message_Size)/2 + 1, Message_Size + 2, 3, SCR_BRIGHT|SCR_WHITE|SCR_REV_RED, 0);
     Print_SBox(&Teaser.Base_Object, 1, Wait_Message);
 
-    // Open the specified topic file.
-    Info = fopen(File_Name, "rb");
-    if (Info == NULL) return 0;
-
-    // Read every line of the topic file.
-    while (fgets(Line_Buffer, 256+2, Info) != NULL) {
-
-      char *End_Pntr;
-      char *Token;
-
-      // Skip this line if it's not a message header.
-      if (Line_Buffer[0] != '|') continue;
-
-      // Kill the '\n' at the end (if there is one).
-      End_Pntr = strchr(Line_Buffer, '\n');
-      if (End_Pntr != NULL) *End_Pntr = '\0';
-
-      // The check below is unneccessary if the file is opened in text mode.
-      //   Why is it being opened in binary mode, anyway?  --PCHAPIN.
-      //   Because it used to be encrypted! --PCABBE
-      /* Somebody forgot to check for carriage returns .... */
-      /* Kill the '\r' at the end (if there is one). */
-      End_Pntr = strchr(Line_Buffer, '\r');
-      if (End_Pntr != NULL) *End_Pntr = '\0';
-
-      // Break off the username part of the header and store it in the index.
-      Token = strtok(Line_Buffer, "|");
-      Topic_Index->Username = (char *)malloc(strlen(Token) + 1);
-      strcpy(Topic_Index->Username, Token);
-
-      // Break off the date part of the header and store it in the index.
-      Token = strtok(NULL, "|");
-      Topic_Index->Date_String = (char *)malloc(strlen(Token) + 1);
-      strcpy(Topic_Index->Date_String, Token);
-      Extract_MessageDate(Topic_Index);
-
-      // Break off the subject line part of the header and store it in the index.
-      Token = strtok(NULL, "|");
-      Topic_Index->Subject_Line = (char *)malloc(strlen(Token) + 1);
-      strcpy(Topic_Index->Subject_Line, Token);
-
-      // Remember the file position for the start of the line right after the header.
-      Topic_Index->FTell_Position = ftell(Info);
-
-      Count++;
-      Topic_Index++;
-
-      // CHECK FOR EXCESSIVE NUMBER OF MESSAGES HERE!!!
-
-    } // End of while loop that reads entire topic file.
-
-    // Store the file position for EOF in empty slot after the last message.
-    Topic_Index->FTell_Position = ftell(Info)+1;
-
-    fclose(Info);
-
-    /* Here is where we reverse the list of messages */
-    /* i.e. Place the newest message at the top of the list. */
-
-    /* Initialize outer markers */
-    Last_Message = Topic_Index;
-
-    /* Loop to reverse */
-    while ((Last_Message - First_Message) > 0) {
-      Temp = *First_Message;
-      *First_Message = *Last_Message;
-      *Last_Message = Temp;
-      First_Message++;
-      Last_Message--;
-    };
-    /* Done with reversal */
+    Count       = Topic_Messages.Index(File_Name);
+    Topic_Index = Topic_Messages.Messages();
 
     Destroy_SWin(&Teaser);
     return Count;
@@ -541,13 +385,16 @@ void Display_Index(
       Initialize_Row(Row_Buffer);
 
       /* If this row has a message on it... */
-      if (Current < MAX_MESSAGES && Message_List[Current].Username != NULL) {
+      if (Message_List[Current].Username.Start != NULL) {
+        Message *This = &Message_List[Current];
 
         /* Compute the text of the message and put it into the row's image. */
-        sprintf(Row_Text, " %-8s", Message_List[Current].Username);
-        strncat(Row_Text, Message_List[Current].Date_String, 16);
-        strcat (Row_Text, "");
-        strcat (Row_Text, Message_List[Current].Subject_Line);
+        /*   The fields are clipped so that the text fits in Row_Text.       */
+        sprintf(Row_Text, " %-8.*s%.*s%.*s",
+          This->Username.Length     > 20 ? 20 : This->Username.Length,     This->Username.Start,
+          This->Date_String.Length  > 16 ? 16 : This->Date_String.Length,  This->Date_String.Start,
+          This->Subject_Line.Length > 80 ? 80 : This->Subject_Line.Length, This->Subject_Line.Start
+          );
         Spread_String(Row_Text, Row_Buffer);
 
         /* Add 'more' indicators if appropriate. */
@@ -555,7 +402,7 @@ void Display_Index(
           Row_Buffer[0] = '';
           Row_Buffer[1] = ARROW_COLOR;
         }
-        if (Row == BOTTOM_ROW && Message_List[Current + 1].Username != NULL) {
+        if (Row == BOTTOM_ROW && Message_List[Current + 1].Username.Start != NULL) {
           Row_Buffer[0] = '';
           Row_Buffer[1] = ARROW_COLOR;
         }
@@ -565,8 +412,8 @@ void Display_Index(
           Color_Section(Row_Buffer, 1, 79, SELECTED_COLOR);
         }
         else {
-          if ((strcmp(Message_List[Current].Username, "NOTEBOOK") ) &&
-              (strcmp(Message_List[Current].Username, "MODERATR") )    )
+          if (!Span_Is(Message_List[Current].Username, "NOTEBOOK") &&
+              !Span_Is(Message_List[Current].Username, "MODERATR")    )
           {
             Color_Section(Row_Buffer,  1,  8, USER_COLOR);
             Color_Section(Row_Buffer,  9, 16, DATE_COLOR);
@@ -625,7 +472,7 @@ int View(
     char   Line_Buffer[256+2], Out_Buffer[257+2];
     int    Counter;
 
-    if (Message_List[Active].Username == NULL) return Active;
+    if (Message_List[Active].Username.Start == NULL) return Active;
 
     /* Try to open the topic file. Give up if it doesn't work. */
     Info = fopen(The_Topic->File_Name, "rb");
@@ -660,10 +507,13 @@ int View(
     fseek(Info, Message_List[Active].FTell_Position, SEEK_SET);
 
     /* Print a header for this message into the temporary file. */
-    sprintf(Out_Buffer, ">%8s  %s  %s",
-      Message_List[Active].Username,
-      Message_List[Active].Date_String,
-      Message_List[Active].Subject_Line
+    sprintf(Out_Buffer, ">%8.*s  %.*s  %.*s",
+      Message_List[Active].Username.Length     > 20  ? 20  : Message_List[Active].Username.Length,
+      Message_List[Active].Username.Start,
+      Message_List[Active].Date_String.Length  > 40  ? 40  : Message_List[Active].Date_String.Length,
+      Message_List[Active].Date_String.Start,
+      Message_List[Active].Subject_Line.Length > 180 ? 180 : Message_List[Active].Subject_Line.Length,
+      Message_List[Active].Subject_Line.Start
       );
     fprintf(Temp, "%s\n", Out_Buffer);
     fprintf(Temp, ">");
@@ -692,13 +542,13 @@ int View(
     Msg_Text[Index] = '\000';
 
     /* Write footer into temporary file. */
-    fprintf (Temp, ">\n>[-END OF EVALUATION/RESPONSE BY %s-]",Message_List[Active].Username);
+    fprintf (Temp, ">\n>[-END OF EVALUATION/RESPONSE BY %.*s-]",Message_List[Active].Username.Length, Message_List[Active].Username.Start);
 
     fclose(Info);
     fclose(Temp);
 
     /* Display the message. Return message number of next message. */
-    Active = Display_Message(Msg_Text, Message_List, Active, MAX_MESSAGES);
+    Active = Display_Message(Msg_Text, Message_List, Active, Topic_Messages.Count());
     free(Msg_Text);
 
     // Update the topic information to indicate that we've (maybe) read
@@ -1068,7 +918,8 @@ int Select_Message(Topic_File *Topic_List, int Topic_Number, int Max_Topic, int
         case K_INS: {
             int Current_Message = Size - Active_Highlight(&Bar);
             Add(&Topic_List[Topic_Number - 1]);
-            Size = Index_Topics(Topic_List[Topic_Number - 1].File_Name, Topic_Index, MAX_MESSAGES);
+            Size = Index_Topics(Topic_List[Topic_Number - 1].File_Name);
+            Bar.List = Topic_Index;
             Make_Active_Highlight(&Bar, Size - Current_Message);
             ScrClear(1, 1, 80, 25, SCR_WHITE);
           }
@@ -1120,7 +971,7 @@ int main(void)
         int Topic_Tmp;
         do {
           Topic_Tmp = Topic_Number;
-          Topic_Size = Index_Topics(Topic_List[Topic_Number - 1].File_Name, Topic_Index, MAX_MESSAGES);
+          Topic_Size = Index_Topics(Topic_List[Topic_Number - 1].File_Name);
           ScrClear(1,1,80,25,SCR_WHITE);
           Topic_Number = Select_Message(Topic_List, Topic_Number, Num_Topics, Topic_Size);
         } while ((Topic_Tmp != Topic_Number) && (Topic_List[Topic_Number-1].File_Name[0] != '+'));
@@ -4,13 +4,19 @@
 
 #include "topics.h"	  /* For the definition of Date (which should be in another file). */
 
+/* Part of a line in the topic file. The text is not null terminated; it lives */
+/*   in the Topic_Indexer (see tindex.h) until the topic is reindexed.          */
 typedef struct {
-  char  *Username;        /* The name of the user who posted the message.   */
-  char  *Date_String;     /* The date the message was posted.               */
-  Date   Posted_On;       /* The date the message was posted.               */
-  char  *Subject_Line;    /* Subject line as entered by poster.             */
-  long   FTell_Position;  /* Fill offset to start of message in topic file. */
+  const char *Start;      /* First character, or NULL if there is no text.  */
+  int         Length;     /* Number of characters.                          */
+} Text_Span;
+
+typedef struct {
+  Text_Span  Username;        /* The name of the user who posted the message.   */
+  Text_Span  Date_String;     /* The date the message was posted.               */
+  Date       Posted_On;       /* The date the message was posted.               */
+  Text_Span  Subject_Line;    /* Subject line as entered by poster.             */
+  long       FTell_Position;  /* Fill offset to start of message in topic file. */
 } Message;
 
 #endif
-
@@ -37,7 +37,7 @@ int Active_Highlight(Highlight_Positions *This) { return This->Active_Message; }
 void Down_Highlight(Highlight_Positions *This)
   {
     This->Active_Message++;
-    if (This->List[This->Active_Message].Username == NULL) This->Active_Message--;
+    if (This->List[This->Active_Message].Username.Start == NULL) This->Active_Message--;
     if (This->Active_Message == This->Top_Message + This->Page_Size) This->Top_Message++;
   }
 
@@ -54,7 +54,7 @@ void Page_Down_Highlight(Highlight_Positions *This)
 
     /* Find just past the end of the list. */
     Message *End_Pntr = This->List + 1;
-    while (End_Pntr->Username != NULL) End_Pntr++;
+    while (End_Pntr->Username.Start != NULL) End_Pntr++;
 
     Last_Message = End_Pntr - This->List - 1; /* Could be -1 for empty lists. */
     if (Last_Message < 1) Last_Message = 1;
@@ -83,7 +83,7 @@ void End_Highlight(Highlight_Positions *This)
   {
     /* Find just past the end of the list. */
     Message *End_Pntr = This->List + 1;
-    while (End_Pntr->Username != NULL) End_Pntr++;
+    while (End_Pntr->Username.Start != NULL) End_Pntr++;
 
     /* Let the active message be the last one. Handle empty lists correctly. */
     This->Active_Message = End_Pntr - This->List - 1;
@@ -97,7 +97,7 @@ void End_Highlight(Highlight_Positions *This)
 void Make_Active_Highlight(Highlight_Positions *This, int New_Value)
   {
     This->Active_Message = (New_Value < 1) ? 1 : New_Value;
-    if (This->List[This->Active_Message].Username == NULL) End_Highlight(This);
+    if (This->List[This->Active_Message].Username.Start == NULL) End_Highlight(This);
     else if (This->Active_Message <  This->Top_Message) This->Top_Message = This->Active_Message;
     else if (This->Active_Message >= This->Top_Message + This->Page_Size)
       This->Top_Message = This->Active_Message - This->Page_Size + 1;
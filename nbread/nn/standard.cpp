@@ -20,6 +20,7 @@ Please send comments or bug reports to
 ****************************************************************************/
 
 #include "environ.h"
+#include <stdio.h>
 #include <stdlib.h>   // Needed for declarations of memory managment functions.
 #include <string.h>
 #include "standard.h"
@@ -55,6 +56,741 @@ void Memory_Panic()
 
 #endif
 
+//---------------------------------
+//           Pool Allocator
+//---------------------------------
+
+// Small blocks are handed out from pools, one for each size class. A pool
+//   carves its blocks from chunks of Chunk_Size bytes and keeps the blocks
+//   that are freed on a list for reuse; chunks are never given back.
+//   Each thread keeps a short list of free blocks of each class of its own
+//   so that most allocations and frees touch no lock. Blocks move between a
+//   thread's lists and the pools in batches. Larger blocks come straight
+//   from malloc().
+//
+// A chunk starts at a multiple of Chunk_Size with a header recording the
+//   class of its blocks, so the blocks themselves carry nothing and My_Free()
+//   finds the class by rounding the pointer down. Chunks are taken from
+//   malloc() a region at a time and entered in a table of chunk addresses. A
+//   pointer that isn't in a chunk is a large block, which is preceded by a
+//   header recording its size.
+//
+// Only blocks from here may be given to My_Free() and My_Realloc(). A pointer
+//   from another allocator (from strdup(), say) would be taken for a large
+//   block. DEBUG builds put a magic number in front of every block, small
+//   ones too, and check it to catch such mistakes.
+//
+// For each class the number of live blocks and the largest number that
+//   have ever been live at once are counted. Memory_Report() prints them;
+//   in DEBUG builds it does so automatically at exit, where any live blocks
+//   are probably leaks.
+
+// The pools need std::atomic, std::mutex, and thread_local in a program that
+//   is multithreaded. Older compilers, such as Watcom C++ v11.0, have none of
+//   them. A multithreaded program built with one of those gets the My_Malloc()
+//   family as it was before the pools: straight on top of malloc(), which the
+//   compiler's multithreaded library makes safe. There are no counts then.
+//   So does real mode MS-DOS, where neither size_t nor a pointer can hold a
+//   chunk's address.
+//
+#if OS != MSDOS && (!defined(MULTITHREADED) || __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900))
+#define USE_POOLS
+#endif
+
+#ifdef USE_POOLS
+
+#ifdef MULTITHREADED
+#include <atomic>
+#include <mutex>
+#include <new>
+#define THREAD_LOCAL thread_local
+typedef std::atomic<long>   Block_Count;
+typedef std::atomic<size_t> Chunk_Slot;
+#else
+#define THREAD_LOCAL
+typedef long   Block_Count;
+typedef size_t Chunk_Slot;
+#endif
+
+const int    Class_Count   = 20;
+const int    Large_Class   = Class_Count;  // Counts the blocks too big for a pool.
+const size_t Chunk_Size    = 64 * 1024;
+const size_t Region_Size   = 16;  // Chunks taken from malloc() at once.
+const int    Cache_Limit   = 64;  // Free blocks of one class a thread may keep.
+const int    Transfer_Size = 32;  // Blocks moved between a thread and a pool at once.
+
+const unsigned long Header_Magic = 0x4E4E504CUL;
+
+static const size_t Class_Sizes[Class_Count] = {
+    16,  32,  48,  64,  80,  96, 112, 128,
+   160, 192, 224, 256,
+   320, 384, 448, 512,
+   640, 768, 896, 1024
+  };
+
+// The headers are as big as the strictest alignment so that what follows
+//   them is suitably aligned for anything.
+//
+union Chunk_Header {
+  int         Size_Class;
+  long double Alignment;
+};
+
+union Block_Header {
+  struct {
+    unsigned long Magic;
+    size_t        Size;   // Requested size of a large block.
+  } Info;
+  long double Alignment;
+};
+
+// Small blocks only have a header in DEBUG builds.
+#ifdef DEBUG
+const size_t Small_Header = sizeof(Block_Header);
+#else
+const size_t Small_Header = 0;
+#endif
+
+// Free blocks, and spare chunks, are linked through their first word.
+struct Free_Block {
+  Free_Block *Next;
+};
+
+// The table of chunks is an open addressing hash set of their addresses
+//   divided by Chunk_Size, none of which is zero. Entries are only added, and
+//   a table that fills is replaced by a bigger copy that is never freed, so
+//   the table can be searched without the lock. A chunk is entered before any
+//   block in it is handed out.
+//
+struct Chunk_Table {
+  size_t     Size;      // A power of two.
+  size_t     Used;
+  Chunk_Slot Slots[1];  // Really Size of them.
+};
+
+struct Size_Pool {
+  Free_Block *Free_List;
+  char       *Carve_Next;  // The unused part of the newest chunk.
+  char       *Carve_End;
+};
+
+struct Class_Counts {
+  Block_Count Live;
+  Block_Count Peak;
+};
+
+// These are all zero before any constructor runs, so allocation works during
+//   static initialization.
+//
+static Size_Pool    Pools[Class_Count];
+static Class_Counts Counts[Class_Count + 1];
+static size_t       Reserved_Bytes;
+static Free_Block  *Spare_Chunks;
+
+#ifdef MULTITHREADED
+static std::mutex                 Pool_Lock;
+static std::atomic<Chunk_Table *> Chunks;
+#else
+static Chunk_Table               *Chunks;
+#endif
+
+class Pool_Guard {
+  public:
+    #ifdef MULTITHREADED
+    Pool_Guard()  { Pool_Lock.lock();   }
+   ~Pool_Guard()  { Pool_Lock.unlock(); }
+    #else
+    // Declared so compilers don't report each guard as an unused variable.
+    Pool_Guard()  { }
+   ~Pool_Guard()  { }
+    #endif
+};
+
+
+//
+// Class_Of
+//
+// Returns the smallest class that holds Size bytes, or Large_Class.
+//
+static int Class_Of(size_t Size)
+  {
+    if (Size <= 128)  return Size == 0 ? 0 : static_cast<int>((Size - 1) / 16);
+    if (Size <= 256)  return 8  + static_cast<int>((Size - 129) / 32);
+    if (Size <= 512)  return 12 + static_cast<int>((Size - 257) / 64);
+    if (Size <= 1024) return 16 + static_cast<int>((Size - 513) / 128);
+    return Large_Class;
+  }
+
+
+//
+// Count_Blocks
+//
+// Adds Change to the number of live blocks in a class. The peak is raised
+//   with a compare and swap so that two threads can't leave the smaller of
+//   their values behind.
+//
+static void Count_Blocks(int Size_Class, long Change)
+  {
+    Class_Counts &C = Counts[Size_Class];
+
+    #ifdef MULTITHREADED
+    long Now  = C.Live.fetch_add(Change, std::memory_order_relaxed) + Change;
+    long Peak = C.Peak.load(std::memory_order_relaxed);
+    while (Now > Peak && !C.Peak.compare_exchange_weak(Peak, Now, std::memory_order_relaxed)) ;
+    #else
+    long Now = (C.Live += Change);
+    if (Now > C.Peak) C.Peak = Now;
+    #endif
+  }
+
+
+//
+// Register_Report
+//
+// The report is only wanted automatically while debugging. The caller holds
+//   the pool lock.
+//
+static void Register_Report()
+  {
+    #ifdef DEBUG
+    static bool Registered = false;
+    if (!Registered) {
+      Registered = true;
+      atexit(Memory_Report);
+    }
+    #endif
+  }
+
+
+//
+// Raw_Allocate
+//
+// This is malloc() with the Memory_Panic() discipline.
+//
+static void *Raw_Allocate(size_t Size)
+  {
+    void *New_Space;
+
+    do {
+      New_Space = malloc(Size);
+      if (!New_Space) Memory_Panic();
+    } while (!New_Space);
+
+    return New_Space;
+  }
+
+
+//
+// Chunk table access
+//
+// The table and its slots are read without the lock, so they are atomic in a
+//   multithreaded program.
+//
+static Chunk_Table *Current_Table()
+  {
+    #ifdef MULTITHREADED
+    return Chunks.load(std::memory_order_acquire);
+    #else
+    return Chunks;
+    #endif
+  }
+
+static size_t Slot_Value(const Chunk_Slot &Slot)
+  {
+    #ifdef MULTITHREADED
+    return Slot.load(std::memory_order_acquire);
+    #else
+    return Slot;
+    #endif
+  }
+
+static size_t First_Slot(const Chunk_Table *Table, size_t Key)
+  {
+    // The chunks of a region have consecutive keys; spread them out.
+    return (Key * 2654435761UL) & (Table->Size - 1);
+  }
+
+
+//
+// New_Table
+//
+// Returns an empty chunk table with Size slots.
+//
+static Chunk_Table *New_Table(size_t Size)
+  {
+    Chunk_Table *Table = static_cast<Chunk_Table *>(
+      Raw_Allocate(sizeof(Chunk_Table) + (Size - 1) * sizeof(Chunk_Slot)));
+
+    Table->Size = Size;
+    Table->Used = 0;
+    for (size_t i = 0; i < Size; i++) {
+      #ifdef MULTITHREADED
+      new (&Table->Slots[i]) Chunk_Slot(0);
+      #else
+      Table->Slots[i] = 0;
+      #endif
+    }
+    return Table;
+  }
+
+
+//
+// Insert_Chunk
+//
+// Enters a key in a table that has room for it. The caller holds the pool
+//   lock, or is the only one who can see the table.
+//
+static void Insert_Chunk(Chunk_Table *Table, size_t Key)
+  {
+    size_t i = First_Slot(Table, Key);
+
+    while (Slot_Value(Table->Slots[i]) != 0) i = (i + 1) & (Table->Size - 1);
+    #ifdef MULTITHREADED
+    Table->Slots[i].store(Key, std::memory_order_release);
+    #else
+    Table->Slots[i] = Key;
+    #endif
+    Table->Used++;
+  }
+
+
+//
+// In_Chunk
+//
+// Returns true if p points into one of the pools' chunks.
+//
+static bool In_Chunk(const void *p)
+  {
+    size_t       Key   = reinterpret_cast<size_t>(p) / Chunk_Size;
+    Chunk_Table *Table = Current_Table();
+
+    if (Table == 0) return false;
+    for (size_t i = First_Slot(Table, Key); ; i = (i + 1) & (Table->Size - 1)) {
+      size_t Entry = Slot_Value(Table->Slots[i]);
+      if (Entry == Key) return true;
+      if (Entry == 0)   return false;
+    }
+  }
+
+
+//
+// Add_Region
+//
+// Takes Region_Size chunks from malloc() and enters them in the table and on
+//   the list of spare chunks. One more chunk than that is allocated so that
+//   the region holds Region_Size of them aligned on Chunk_Size. Memory is
+//   allocated without holding the lock since Memory_Panic() may need to free
+//   blocks, so a bigger table is made first, if one is needed, and the lock
+//   is taken again to see whether it still is. A table that is replaced is
+//   kept since another thread may be searching it.
+//
+static void Add_Region()
+  {
+    char *Region = static_cast<char *>(Raw_Allocate((Region_Size + 1) * Chunk_Size));
+    char *First  = Region + (Chunk_Size - reinterpret_cast<size_t>(Region) % Chunk_Size);
+
+    Chunk_Table *Bigger = 0;
+    for (;;) {
+      size_t Wanted;
+      {
+        Pool_Guard   Guard;
+        Chunk_Table *Table = Current_Table();
+
+        if (Bigger != 0 && (Table == 0 || Bigger->Size > Table->Size)) {
+          if (Table != 0) {
+            for (size_t i = 0; i < Table->Size; i++) {
+              size_t Entry = Slot_Value(Table->Slots[i]);
+              if (Entry != 0) Insert_Chunk(Bigger, Entry);
+            }
+          }
+          #ifdef MULTITHREADED
+          Chunks.store(Bigger, std::memory_order_release);
+          #else
+          Chunks = Bigger;
+          #endif
+          Table  = Bigger;
+          Bigger = 0;
+        }
+
+        if (Table != 0 && 2 * (Table->Used + Region_Size) <= Table->Size) {
+          for (size_t i = Region_Size; i > 0; i--) {
+            char *Chunk = First + (i - 1) * Chunk_Size;
+            Insert_Chunk(Table, reinterpret_cast<size_t>(Chunk) / Chunk_Size);
+
+            Free_Block *Spare = reinterpret_cast<Free_Block *>(Chunk);
+            Spare->Next  = Spare_Chunks;
+            Spare_Chunks = Spare;
+          }
+          Reserved_Bytes += (Region_Size + 1) * Chunk_Size;
+          break;
+        }
+
+        Wanted = (Table == 0) ? 64 : 2 * Table->Size;
+        while (2 * ((Table == 0 ? 0 : Table->Used) + Region_Size) > Wanted) Wanted *= 2;
+      }
+      if (Bigger != 0) free(Bigger);
+      Bigger = New_Table(Wanted);
+    }
+    if (Bigger != 0) free(Bigger);
+  }
+
+
+//
+// Take_Blocks
+//
+// Returns a list of up to Wanted free blocks of the given class (at least
+//   one), setting Got to the number. When the pool has none a spare chunk is
+//   given to it, and when there are no spare chunks a region is added.
+//
+static Free_Block *Take_Blocks(int Size_Class, int Wanted, int &Got)
+  {
+    Size_Pool  &Pool   = Pools[Size_Class];
+    size_t      Stride = Small_Header + Class_Sizes[Size_Class];
+    Free_Block *Head   = 0;
+
+    Got = 0;
+    for (;;) {
+      {
+        Pool_Guard Guard;
+
+        while (Got < Wanted && Pool.Free_List != 0) {
+          Free_Block *Block = Pool.Free_List;
+          Pool.Free_List = Block->Next;
+          Block->Next = Head;
+          Head = Block;
+          Got++;
+        }
+        while (Got < Wanted && static_cast<size_t>(Pool.Carve_End - Pool.Carve_Next) >= Stride) {
+          Free_Block *Block = reinterpret_cast<Free_Block *>(Pool.Carve_Next + Small_Header);
+          Pool.Carve_Next += Stride;
+          Block->Next = Head;
+          Head = Block;
+          Got++;
+        }
+        if (Got > 0) return Head;
+
+        if (Spare_Chunks != 0) {
+          char *Chunk = reinterpret_cast<char *>(Spare_Chunks);
+          Spare_Chunks = Spare_Chunks->Next;
+          reinterpret_cast<Chunk_Header *>(Chunk)->Size_Class = Size_Class;
+          Pool.Carve_Next = Chunk + sizeof(Chunk_Header);
+          Pool.Carve_End  = Chunk + Chunk_Size;
+          Register_Report();
+          continue;
+        }
+      }
+      Add_Region();
+    }
+  }
+
+
+//
+// Return_Blocks
+//
+static void Return_Blocks(int Size_Class, Free_Block *Head)
+  {
+    if (Head == 0) return;
+
+    Free_Block *Tail = Head;
+    while (Tail->Next != 0) Tail = Tail->Next;
+
+    Pool_Guard Guard;
+    Tail->Next = Pools[Size_Class].Free_List;
+    Pools[Size_Class].Free_List = Head;
+  }
+
+
+//
+// struct Thread_Cache
+//
+// A thread's own free blocks. When the thread ends they go back to the pools
+//   and anything the thread frees after that goes straight to the pools too.
+//
+struct Thread_Cache {
+  Free_Block *Lists[Class_Count];
+  int         Sizes[Class_Count];
+  long        Changes[Class_Count + 1];  // Blocks allocated less blocks freed, not yet counted.
+
+ ~Thread_Cache();
+};
+
+static THREAD_LOCAL Thread_Cache *Current_Cache = 0;
+static THREAD_LOCAL bool          Cache_Retired = false;
+
+Thread_Cache::~Thread_Cache()
+  {
+    for (int i = 0; i < Class_Count; i++) {
+      Return_Blocks(i, Lists[i]);
+      Lists[i] = 0;
+      Sizes[i] = 0;
+    }
+    for (int i = 0; i <= Class_Count; i++) {
+      Count_Blocks(i, Changes[i]);
+      Changes[i] = 0;
+    }
+    Current_Cache = 0;
+    Cache_Retired = true;
+  }
+
+
+//
+// My_Cache
+//
+// Returns this thread's cache, or NULL if the thread is ending.
+//
+static Thread_Cache *My_Cache()
+  {
+    if (Current_Cache != 0) return Current_Cache;
+    if (Cache_Retired) return 0;
+
+    static THREAD_LOCAL Thread_Cache Cache;
+    Current_Cache = &Cache;
+    return Current_Cache;
+  }
+
+
+//
+// Note_Change
+//
+// A thread saves up its changes to the counts until they amount to a batch so
+//   that the shared counts (which every thread would be writing) are not
+//   touched on every call. The peaks can be low by up to a batch per thread.
+//   Large blocks cost a call to malloc() anyway so they are counted at once.
+//
+static void Note_Change(Thread_Cache *Cache, int Size_Class, long Change)
+  {
+    if (Cache == 0 || Size_Class == Large_Class) {
+      Count_Blocks(Size_Class, Change);
+      return;
+    }
+
+    long &Pending = Cache->Changes[Size_Class];
+    Pending += Change;
+    if (Pending >= Transfer_Size || Pending <= -Transfer_Size) {
+      Count_Blocks(Size_Class, Pending);
+      Pending = 0;
+    }
+  }
+
+
+//
+// Class_Of_Block
+//
+// Returns the class of a block from Pool_Allocate(): the class of its chunk,
+//   or Large_Class if it isn't in one. Debug builds make sure that it is a
+//   live block from there.
+//
+static int Class_Of_Block(void *p)
+  {
+    #ifdef DEBUG
+    Block_Header *Header = static_cast<Block_Header *>(p) - 1;
+    if (Header->Info.Magic != Header_Magic) {
+      fprintf(stderr, "Memory: %p was not allocated by My_Malloc() (or was freed already)\n", p);
+      abort();
+    }
+    #endif
+
+    if (!In_Chunk(p)) return Large_Class;
+    char *Chunk = static_cast<char *>(p) - reinterpret_cast<size_t>(p) % Chunk_Size;
+    return reinterpret_cast<Chunk_Header *>(Chunk)->Size_Class;
+  }
+
+
+//
+// Pool_Allocate
+//
+static void *Pool_Allocate(size_t Size)
+  {
+    int           Size_Class = Class_Of(Size);
+    Thread_Cache *Cache      = My_Cache();
+
+    if (Size_Class == Large_Class) {
+      Block_Header *Header = static_cast<Block_Header *>(Raw_Allocate(sizeof(Block_Header) + Size));
+      Header->Info.Magic = Header_Magic;
+      Header->Info.Size  = Size;
+      Note_Change(Cache, Large_Class, 1);
+      {
+        Pool_Guard Guard;
+        Register_Report();
+      }
+      return Header + 1;
+    }
+
+    Free_Block *Block;
+    int         Got;
+
+    if (Cache == 0) {
+      Block = Take_Blocks(Size_Class, 1, Got);
+    }
+    else {
+      if (Cache->Lists[Size_Class] == 0) {
+        Cache->Lists[Size_Class] = Take_Blocks(Size_Class, Transfer_Size, Got);
+        Cache->Sizes[Size_Class] = Got;
+      }
+      Block = Cache->Lists[Size_Class];
+      Cache->Lists[Size_Class] = Block->Next;
+      Cache->Sizes[Size_Class]--;
+    }
+    #ifdef DEBUG
+    (reinterpret_cast<Block_Header *>(Block) - 1)->Info.Magic = Header_Magic;
+    #endif
+    Note_Change(Cache, Size_Class, 1);
+    return Block;
+  }
+
+
+//
+// Pool_Free
+//
+// A thread that has collected more than Cache_Limit free blocks of a class
+//   gives a batch of them back so that they can be used by other threads.
+//
+static void Pool_Free(void *p)
+  {
+    int           Size_Class = Class_Of_Block(p);
+    Thread_Cache *Cache      = My_Cache();
+
+    Note_Change(Cache, Size_Class, -1);
+    #ifdef DEBUG
+    (static_cast<Block_Header *>(p) - 1)->Info.Magic = 0;
+    #endif
+    if (Size_Class == Large_Class) {
+      free(static_cast<Block_Header *>(p) - 1);
+      return;
+    }
+
+    Free_Block *Block = static_cast<Free_Block *>(p);
+
+    if (Cache == 0) {
+      Block->Next = 0;
+      Return_Blocks(Size_Class, Block);
+      return;
+    }
+
+    Block->Next = Cache->Lists[Size_Class];
+    Cache->Lists[Size_Class] = Block;
+    if (++Cache->Sizes[Size_Class] > Cache_Limit) {
+      Free_Block *Batch = Cache->Lists[Size_Class];
+      Free_Block *Last  = Batch;
+      for (int i = 1; i < Transfer_Size; i++) Last = Last->Next;
+      Cache->Lists[Size_Class] = Last->Next;
+      Cache->Sizes[Size_Class] -= Transfer_Size;
+      Last->Next = 0;
+      Return_Blocks(Size_Class, Batch);
+    }
+  }
+
+
+//
+// Memory_Report
+//
+// Prints the live and peak block counts of each class that has been used
+//   to stderr. The calling thread's changes are counted first; other
+//   threads' may not be until they end.
+//
+void Memory_Report(void)
+  {
+    long Leaked = 0;
+
+    if (Current_Cache != 0) {
+      for (int i = 0; i <= Class_Count; i++) {
+        Count_Blocks(i, Current_Cache->Changes[i]);
+        Current_Cache->Changes[i] = 0;
+      }
+    }
+
+    fprintf(stderr, "Memory pools: %lu KBytes reserved\n", static_cast<unsigned long>(Reserved_Bytes / 1024));
+    fprintf(stderr, "%10s %10s %10s\n", "Size", "Live", "Peak");
+    for (int i = 0; i <= Class_Count; i++) {
+      long Live = Counts[i].Live;
+      long Peak = Counts[i].Peak;
+      if (Peak == 0) continue;
+
+      if (i == Large_Class)
+        fprintf(stderr, "%10s %10ld %10ld\n", "larger", Live, Peak);
+      else
+        fprintf(stderr, "%10lu %10ld %10ld\n", static_cast<unsigned long>(Class_Sizes[i]), Live, Peak);
+      Leaked += Live;
+    }
+    if (Leaked != 0) fprintf(stderr, "%ld blocks still allocated\n", Leaked);
+  }
+
+
+// My_Malloc() never returns NULL. If it fails to find memory on the malloc()
+//   heap, it calls Memory_Panic(), an application call-back function. The
+//   function Memory_Panic() might throw an exception.
+
+void *My_Malloc(size_t Size)
+  {
+    return Pool_Allocate(Size);
+  }
+
+// My_Calloc() has the same semantics as calloc() except that it cannot
+//   fail from the point of view of the application.
+
+void *My_Calloc(size_t Nmbr_Items, size_t Size)
+  {
+    size_t  Bytes     = Nmbr_Items * Size;
+    void   *New_Space = My_Malloc(Bytes);
+
+    memset(New_Space, 0, Bytes);
+    return New_Space;
+  }
+
+// And so forth for My_Realloc(). A block that still fits in its class is
+//   returned as is. Large blocks are resized by realloc() itself.
+
+void *My_Realloc(void *Old_Space, size_t New_Size)
+  {
+    if (Old_Space == 0) return My_Malloc(New_Size);
+
+    int   Size_Class = Class_Of_Block(Old_Space);
+    void *New_Space;
+
+    if (Size_Class != Large_Class) {
+      if (New_Size <= Class_Sizes[Size_Class]) return Old_Space;
+
+      New_Space = My_Malloc(New_Size);
+      memcpy(New_Space, Old_Space, Class_Sizes[Size_Class]);
+      My_Free(Old_Space);
+      return New_Space;
+    }
+
+    if (Class_Of(New_Size) != Large_Class) {
+      New_Space = My_Malloc(New_Size);
+      memcpy(New_Space, Old_Space, New_Size);
+      My_Free(Old_Space);
+      return New_Space;
+    }
+
+    Block_Header *Header = static_cast<Block_Header *>(Old_Space) - 1;
+    Block_Header *New_Header;
+    do {
+      New_Header = static_cast<Block_Header *>(realloc(Header, sizeof(Block_Header) + New_Size));
+      if (!New_Header) Memory_Panic();
+    } while (!New_Header);
+    New_Header->Info.Size = New_Size;
+    return New_Header + 1;
+  }
+
+// There is no compelling reason to provide my own free(). However, for
+//   symmetery, I will do so. The counters it keeps allow some rudimentary
+//   checking for memory leaks.
+
+void My_Free(void *p)
+  {
+    if (p != 0) Pool_Free(p);
+  }
+
+#else
+
+// Without the pools, these are thin wrappers around the C library.
+
+void Memory_Report(void)
+  {
+    fprintf(stderr, "Memory pools: not used in this build\n");
+  }
+
 // My_Malloc() never returns NULL. If it fails to find memory on the malloc()
 //   heap, it calls Memory_Panic(), an application call-back function. The
 //   function Memory_Panic() might throw an exception.
@@ -97,16 +833,13 @@ void *My_Realloc(void *Old_Space, size_t New_Size)
     return New_Space;
   }
 
-// There is no compelling reason to provide my own free(). However, for
-//   symmetery, I will do so. Besides, by putting counters in here and
-//   in My_Malloc(), I should be able to do some rudimentary checking for
-//   memory leaks.
-
 void My_Free(void *p)
   {
     free(p);
   }
 
+#endif
+
 #ifdef MY_MALLOC
 
 // Let's be sure ::operator new() is implemented in terms of My_Malloc()
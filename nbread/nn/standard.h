@@ -38,9 +38,14 @@ Please send comments or bug reports to
   //   code to be inserted into non-windows specific modules at compile time.
 
 #include <stddef.h>
+#if __cplusplus >= 199711L
+#include <iostream>
+#else
 #include <iostream.h>
+#endif
   // I need this for all I/O -- including in-core streams and other special
-  //   effects. Do I really want to include this in all modules?
+  //   effects. Do I really want to include this in all modules? Compilers
+  //   that follow the 1998 standard only have the new style header.
 
 //-----------------------------------
 //           The bool Type
@@ -48,8 +53,8 @@ Please send comments or bug reports to
 
 // Borland C++ v5.x and Watcom C++ v11.0 support it. None of the other compilers
 //   I use do, but some have a #define for bool in a system header file (gcc seems
-//   to be like that).
-#if COMPILER != BORLAND && COMPILER != WATCOM && !defined(bool)
+//   to be like that). Any compiler that follows the 1998 standard has it.
+#if COMPILER != BORLAND && COMPILER != WATCOM && __cplusplus < 199711L && !defined(bool)
 typedef int bool;
 #define true  1
 #define false 0
@@ -154,8 +159,13 @@ class bad_alloc {
 //
 // The MY_MALLOC discipline is obsolete. New software should never use malloc()
 //   and new compilers will throw exceptions on failed allocations by default.
-
-#ifdef MY_MALLOC
+//   The My_Malloc() family is still useful, though: it is backed by size class
+//   pools that are faster than malloc() for small blocks and that count the
+//   blocks in use. Defining MY_MALLOC routes malloc() and operator new there.
+//
+// My_Free() and My_Realloc() only accept memory from the My_Malloc() family.
+//   Under MY_MALLOC, memory from a library function such as strdup() must be
+//   given to the real free(); write (free)(p) to get past the macro.
 
 // These functions have the same semantics as the standard library functions
 //   except that they never return an error indication. Instead, if they
@@ -177,6 +187,12 @@ void *My_Realloc(void *, size_t);
 void  My_Free(void *);
 void  Memory_Panic(void);
 
+// Prints the number of blocks in use (and the most ever in use) for each size
+//   class to stderr. Debug builds do this at exit to expose leaks.
+void  Memory_Report(void);
+
+#ifdef MY_MALLOC
+
 // Macros that redirect calls to memory management functions to my code. If
 //   MY_MALLOC is in force, then this file must be #included *after* <stdlib.h>
 //   otherwise these macros will change the meaning of the declarations in
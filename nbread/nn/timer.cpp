@@ -4,13 +4,15 @@ LAST REVISION : March 1991
 SUBJECT       : Implmentation of class Timer
 PROGRAMMER    : (C) Copyright 1995 by Peter Chapin
 
-Objects from class Timer are useful for timing relatively long events in
-programs. They use the system clock as a base for generating time delays
-and thus are not suitable (in most cases) for short delays.
+Objects from class Timer are useful for timing events in programs, long or
+short. They use the system's monotonic clock (QueryPerformanceCounter() on
+Win32 and clock_gettime() on Unix), which counts real time with a resolution
+of a microsecond or better and is not affected when the time of day is
+changed. On other systems they fall back to clock(), which is coarse and may
+measure processor time rather than real time.
 
 Timers do not load the system in any way while they are timing. Only when
-they are started and stopped do they check the system clock. They can thus
-be fooled if the system clock is changed during the timing interval.
+they are started and stopped (or read) do they check the clock.
 
 Timers allow for multiple starts and stops. In addition, their internal
 state can be obtained by consumer code.
@@ -24,9 +26,76 @@ state can be obtained by consumer code.
 *****************************************************************************/
 
 #include "environ.h"
+
+#include <time.h>
+
 #include "standard.h"
 #include "timer.h"
 
+/*----------------------------------------------------------------------------
+long long Timer::Now();
+
+The following function returns the clock reading in nanoseconds. The origin
+is arbitrary, so only differences between readings mean anything.
+
+The performance counter's frequency is read once. The whole seconds and the
+remainder are scaled separately so that the multiplication can't overflow no
+matter how long the system has been up.
+----------------------------------------------------------------------------*/
+
+long long Timer::Now()
+  {
+    #if OS == WIN32
+    static long long Frequency = 0;
+    LARGE_INTEGER Reading;
+
+    if (Frequency == 0) {
+      QueryPerformanceFrequency(&Reading);
+      Frequency = Reading.QuadPart;
+    }
+    QueryPerformanceCounter(&Reading);
+    long long Seconds = Reading.QuadPart / Frequency;
+    long long Rest    = Reading.QuadPart % Frequency;
+    return Seconds * 1000000000LL + (Rest * 1000000000LL) / Frequency;
+
+    #elif OS == UNIX
+    struct timespec Reading;
+    clock_gettime(CLOCK_MONOTONIC, &Reading);
+    return static_cast<long long>(Reading.tv_sec) * 1000000000LL + Reading.tv_nsec;
+
+    #else
+    return (static_cast<long long>(clock()) * 1000000000LL) / CLOCKS_PER_SEC;
+    #endif
+  }
+
+
+/*----------------------------------------------------------------------------
+long long Timer::Resolution();
+
+The following function returns the smallest interval, in nanoseconds, that
+the clock can distinguish (at least one).
+----------------------------------------------------------------------------*/
+
+long long Timer::Resolution()
+  {
+    #if OS == WIN32
+    LARGE_INTEGER Frequency;
+    QueryPerformanceFrequency(&Frequency);
+    long long Result = 1000000000LL / Frequency.QuadPart;
+
+    #elif OS == UNIX
+    struct timespec Precision;
+    clock_getres(CLOCK_MONOTONIC, &Precision);
+    long long Result = static_cast<long long>(Precision.tv_sec) * 1000000000LL + Precision.tv_nsec;
+
+    #else
+    long long Result = 1000000000LL / CLOCKS_PER_SEC;
+    #endif
+
+    return Result < 1 ? 1 : Result;
+  }
+
+
 /*----------------------------------------------------------------------------
 void Timer::Start();
 
@@ -40,7 +109,7 @@ changed.
 void Timer::Start()
   {
     Internal_State = RUNNING;
-    Start_Time     = clock();
+    Start_Time     = Now();
     return;
   }
 
@@ -55,38 +124,143 @@ objects allow frequent starts and stops.
 
 void Timer::Stop()
   {
-    Stop_Time      = clock();
+    if (Internal_State == RUNNING) Accumulated += Now() - Start_Time;
     Internal_State = STOPPED;
-    Accumulated   += Stop_Time - Start_Time;
     return;
   }
 
+
+/*----------------------------------------------------------------------------
+long long Timer::Split();
+
+The following function returns the total accumulated time in nanoseconds.
+If the timer is running the current interval is included. The state of the
+timer is unchanged.
+----------------------------------------------------------------------------*/
+
+long long Timer::Split()
+  {
+    if (Internal_State != RUNNING) return Accumulated;
+    return Accumulated + Now() - Start_Time;
+  }
+
+
+/*----------------------------------------------------------------------------
+long long Timer::Lap();
+
+The following function returns the accumulated time in nanoseconds since the
+end of the previous lap and starts a new lap. Only time while the timer was
+running counts. Feeding the laps of a running timer into a Latency_Histogram
+is a cheap way to time each pass through a loop.
+----------------------------------------------------------------------------*/
+
+long long Timer::Lap()
+  {
+    long long Total  = Split();
+    long long Result = Total - Lap_Mark;
+    Lap_Mark = Total;
+    return Result;
+  }
+
+
 /*----------------------------------------------------------------------------
 long Timer::Time();
 
 The following function returns the total accumulated time in 100th seconds.
 Note that if the timer is running when this function is called, it
 correctly evaluates the time. The state of the timer is unchanged.
-
-The function is careful to return the accumulated time in a portable way.
-The fraction 100/CLOCKS_PER_SEC will adjust the value stored in the
-arithmetic type clock_t to the number of 100th seconds on all machines.
-There may be a problem, however, with overflow when the multiplication of
-100 is done. Notice that it is also assumed that clock_t can hold the
-result sensibly.
 ----------------------------------------------------------------------------*/
 
 long Timer::Time()
   {
-    clock_t Total_Time;
+    return static_cast<long>(Split() / 10000000LL);
+  }
 
-    if (Internal_State != RUNNING) {
-      Total_Time = ( ((clock_t)100)*Accumulated )/(clock_t)CLOCKS_PER_SEC;
-    }
-    else {
-      Total_Time = Accumulated + clock() - Start_Time;
-      Total_Time = ( ((clock_t)100)*Total_Time )/(clock_t)CLOCKS_PER_SEC;
+
+/*----------------------------------------------------------------------------
+void Latency_Histogram::Reset();
+----------------------------------------------------------------------------*/
+
+void Latency_Histogram::Reset()
+  {
+    for (int i = 0; i < Bucket_Count; i++) Buckets[i] = 0;
+    Total_Count = 0;
+    Total_Value = 0;
+    Smallest    = ~0ULL;
+    Largest     = 0;
+  }
+
+
+/*----------------------------------------------------------------------------
+unsigned long long Latency_Histogram::Highest_Equivalent(int Bucket);
+
+The following function returns the largest value that falls into the given
+bucket. It is the inverse of Bucket_Of().
+----------------------------------------------------------------------------*/
+
+unsigned long long Latency_Histogram::Highest_Equivalent(int Bucket)
+  {
+    int Shift = Bucket / Sub_Count - 1;
+    if (Shift <= 0) return Bucket;
+
+    unsigned long long Lowest = static_cast<unsigned long long>(Sub_Count + Bucket % Sub_Count) << Shift;
+    return Lowest + ((1ULL << Shift) - 1);
+  }
+
+
+/*----------------------------------------------------------------------------
+void Latency_Histogram::Merge(const Latency_Histogram &Other);
+
+The following function adds the samples of another histogram to this one.
+This allows each thread to keep its own histogram and combine them at the
+end.
+----------------------------------------------------------------------------*/
+
+void Latency_Histogram::Merge(const Latency_Histogram &Other)
+  {
+    for (int i = 0; i < Bucket_Count; i++) Buckets[i] += Other.Buckets[i];
+    Total_Count += Other.Total_Count;
+    Total_Value += Other.Total_Value;
+    if (Other.Smallest < Smallest) Smallest = Other.Smallest;
+    if (Other.Largest  > Largest)  Largest  = Other.Largest;
+  }
+
+
+/*----------------------------------------------------------------------------
+double Latency_Histogram::Mean();
+----------------------------------------------------------------------------*/
+
+double Latency_Histogram::Mean() const
+  {
+    if (Total_Count == 0) return 0.0;
+    return static_cast<double>(Total_Value) / static_cast<double>(Total_Count);
+  }
+
+
+/*----------------------------------------------------------------------------
+unsigned long long Latency_Histogram::Percentile(double Percent);
+
+The following function finds the bucket holding the sample of the given rank
+and returns the largest value in that bucket. The true maximum is returned
+for the 100th percentile since it is known exactly.
+----------------------------------------------------------------------------*/
+
+unsigned long long Latency_Histogram::Percentile(double Percent) const
+  {
+    if (Total_Count == 0) return 0;
+    if (Percent >= 100.0) return Largest;
+
+    unsigned long long Rank = static_cast<unsigned long long>(Percent / 100.0 * Total_Count + 0.5);
+    if (Rank < 1) Rank = 1;
+
+    unsigned long long Seen = 0;
+    for (int i = 0; i < Bucket_Count; i++) {
+      Seen += Buckets[i];
+      if (Seen >= Rank) {
+        unsigned long long Result = Highest_Equivalent(i);
+        return Result < Largest ? Result : Largest;
+      }
     }
-    return (long)Total_Time;
+    return Largest;
   }
 
@@ -15,8 +15,6 @@ PROGRAMMER    : (C) Copyright 1995 by Peter Chapin
 #ifndef TIMER_HPP
 #define TIMER_HPP
 
-#include <time.h>
-
 class Timer {
 
   public:
@@ -27,19 +25,117 @@ class Timer {
     };
 
   private:
-    clock_t      Start_Time;      // Time that the timer was last started.
-    clock_t      Stop_Time;       // Time that the timer was last stopped.
-    clock_t      Accumulated;     // Total accumulated time.
+    long long    Start_Time;      // Clock reading when the timer was last started.
+    long long    Accumulated;     // Total accumulated time (ns) before the last start.
+    long long    Lap_Mark;        // Accumulated time at the end of the last lap.
     Timer_State  Internal_State;  // Current state of timer object.
 
   public:
-                Timer()  { Internal_State = RESET; Accumulated = 0; }
-    void        Reset()  { Internal_State = RESET; Accumulated = 0; }
+                Timer()  { Reset(); }
+    void        Reset()  { Internal_State = RESET; Accumulated = 0; Lap_Mark = 0; }
     Timer_State State()  { return Internal_State; }
     void        Start();
     void        Stop();
     long        Time();
+      // Total accumulated time in 100ths of a second.
+
+    long long   Split();
+      // Total accumulated time in nanoseconds. The timer keeps running.
+
+    long long   Lap();
+      // Accumulated time in nanoseconds since the last lap ended (or since the
+      //   timer was reset), and starts a new lap. The timer keeps running.
+
+    static long long Now();
+      // Reads the clock (nanoseconds from an arbitrary origin).
+
+    static long long Resolution();
+      // The clock's resolution in nanoseconds.
   };
 
+
+//
+// class Latency_Histogram
+//
+// This class counts samples (normally times in nanoseconds, as from Timer::Lap)
+//   in buckets of roughly constant relative width, after the manner of the
+//   HDR histogram. Each power of two is divided into Sub_Count buckets, so a
+//   sample is known to within about 3% no matter how large it is, and no range
+//   has to be chosen in advance. Recording a sample is a bit scan and an
+//   increment.
+//
+class Latency_Histogram {
+
+  public:
+    enum {
+      Sub_Bits     = 5,
+      Sub_Count    = 1 << Sub_Bits,
+      Bucket_Count = (64 - Sub_Bits + 1) * Sub_Count
+    };
+
+  private:
+    unsigned long      Buckets[Bucket_Count];
+    unsigned long long Total_Count;
+    unsigned long long Total_Value;
+    unsigned long long Smallest;
+    unsigned long long Largest;
+
+    static int Bucket_Of(unsigned long long Value);
+    static unsigned long long Highest_Equivalent(int Bucket);
+
+  public:
+    Latency_Histogram()  { Reset(); }
+    void Reset();
+
+    void Record(unsigned long long Value);
+    void Merge(const Latency_Histogram &Other);
+
+    unsigned long long Count() const { return Total_Count; }
+    unsigned long long Min()   const { return Total_Count == 0 ? 0 : Smallest; }
+    unsigned long long Max()   const { return Largest; }
+    double             Mean()  const;
+
+    unsigned long long Percentile(double Percent) const;
+      // The largest value that is equivalent (falls in the same bucket) to the
+      //   sample at the given percentile (0.0 to 100.0).
+  };
+
+
+//
+// Latency_Histogram::Bucket_Of
+//
+// Values below Sub_Count have a bucket each. Above that, the bits after the
+//   highest one select one of the Sub_Count buckets for that power of two.
+//
+inline int Latency_Histogram::Bucket_Of(unsigned long long Value)
+  {
+    if (Value < Sub_Count) return static_cast<int>(Value);
+
+    #if COMPILER == GCC
+    int Top = 63 - __builtin_clzll(Value);
+    #else
+    int Top = 0;
+    for (int Step = 32; Step != 0; Step /= 2) {
+      if ((Value >> (Top + Step)) != 0) Top += Step;
+    }
+    #endif
+
+    int Shift = Top - Sub_Bits;
+    return (Shift + 1) * Sub_Count + static_cast<int>(Value >> Shift) - Sub_Count;
+  }
+
+
+//
+// Latency_Histogram::Record
+//
+inline void Latency_Histogram::Record(unsigned long long Value)
+  {
+    Buckets[Bucket_Of(Value)]++;
+    Total_Count++;
+    Total_Value += Value;
+    if (Value < Smallest) Smallest = Value;
+    if (Value > Largest)  Largest  = Value;
+  }
+
 #endif
 
@@ -0,0 +1,480 @@
+/****************************************************************************
+FILE          : tindex.cpp
+LAST REVISION : October 2026
+SUBJECT       : Implementation of the topic file indexer.
+PROGRAMMER    : (C) Copyright 2026 by VTC^3
+
+Header lines are found by searching the topic's text for '|' characters with
+memchr(), which the run time libraries implement with wide (vector)
+compares, and keeping those that start a line. Message bodies rarely
+contain '|' (a body line that starts with one is escaped by Add() in lc.cpp)
+so almost all of the file is passed over at the speed memchr() can read it.
+****************************************************************************/
+
+#include "environ.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#if OS == UNIX
+#include <unistd.h>     // For getpid().
+#else
+#include <process.h>    // For getpid().
+#endif
+
+#include "standard.h"
+#include "tindex.h"
+
+#include "../rfcdate.hpp"
+
+// The sidecar file starts with a Sidecar_Header and holds one Sidecar_Record
+//   for each message, in file order. It is only ever read by the program that
+//   wrote it, so the structures are written as they are in memory. Offsets are
+//   from the start of the topic file.
+//
+static const char Sidecar_Magic[8] = "LCIDX01";
+
+typedef struct {
+  char          Magic[8];
+  long          Record_Size;     // =sizeof(Sidecar_Record) of the writer.
+  long          Indexed_Length;  // The length of the topic file when indexed.
+  long          Resume_Offset;   // The start of the first line not yet complete.
+  unsigned long Tail_Sum;        // Checksum of the bytes just before Indexed_Length.
+  long          Count;           // Number of records that follow.
+} Sidecar_Header;
+
+typedef struct {
+  long  Username_Offset;
+  int   Username_Length;
+  long  Date_Offset;
+  int   Date_Length;
+  long  Subject_Offset;
+  int   Subject_Length;
+  long  FTell_Position;
+  Date  Posted_On;
+} Sidecar_Record;
+
+// The number of bytes covered by Tail_Sum.
+static const long Tail_Size = 4096;
+
+//
+// Extract_MessageDate
+//
+// The following function takes the Date_String in a Message and figures out
+//   what the computable date is. It installs the result into the same Message
+//   under Posted_On.
+//
+static void Extract_MessageDate(Message *The_Message)
+  {
+    static const Date Dummy = { 1, 1, 0, 0, 1992 };
+      // Placeholder date/time: January 1, 0 hours 0 minutes (midnight) 1992.
+
+    static Date_Parser Parser;
+      // Shared with NBread. It accepts both the new style (with hours and minutes) and
+      //   the old style dates, and it copes with misspelled day names such as "Thurs".
+
+    Date_Parts Parts;
+    char       Date_Text[80+1];
+
+    // The span isn't null terminated. Dates longer than the buffer are nonsense anyway.
+    int Length = The_Message->Date_String.Length;
+    if (Length > 80) Length = 80;
+    memcpy(Date_Text, The_Message->Date_String.Start, Length);
+    Date_Text[Length] = '\0';
+
+    // Start with the placeholder and overwrite whatever fields the parser found. A
+    //   missing year is left as 1992 and an unknown month as January.
+    //
+    The_Message->Posted_On = Dummy;
+    Parser.Parse(Date_Text, Parts);
+
+    if (Parts.Month > 0) The_Message->Posted_On.Month = Parts.Month;
+    if (Parts.Day   > 0) The_Message->Posted_On.Day   = Parts.Day;
+    if (Parts.Year  > 0) The_Message->Posted_On.Year  = Parts.Year;
+    The_Message->Posted_On.Hour   = Parts.Hour;
+    The_Message->Posted_On.Minute = Parts.Minute;
+  }
+
+
+//
+// Next_Field
+//
+// Takes the text up to the next '|' (or the end of the line) as a field and
+//   advances past the '|'. A missing field is empty.
+//
+static Text_Span Next_Field(const char *&Field, const char *Line_End)
+  {
+    const char *Bar = static_cast<const char *>(memchr(Field, '|', Line_End - Field));
+    if (Bar == NULL) Bar = Line_End;
+
+    Text_Span Result;
+    Result.Start  = Field;
+    Result.Length = static_cast<int>(Bar - Field);
+
+    Field = (Bar == Line_End) ? Line_End : Bar + 1;
+    return Result;
+  }
+
+
+//
+// Tail_Checksum
+//
+// Computes a checksum (FNV-1a) of the Tail_Size bytes that end at Length, or
+//   of all of them if there are fewer.
+//
+static unsigned long Tail_Checksum(const char *Begin, long Length)
+  {
+    long          First = (Length > Tail_Size) ? Length - Tail_Size : 0;
+    unsigned long Sum   = 2166136261UL;
+
+    for (long i = First; i < Length; i++) {
+      Sum ^= static_cast<unsigned char>(Begin[i]);
+      Sum  = (Sum * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return Sum;
+  }
+
+
+//
+// Span_Of
+//
+// Converts a span in the sidecar back to one in the text. Returns 0 if the
+//   span doesn't lie within the first Length bytes.
+//
+static int Span_Of(const char *Begin, long Length, long Offset, int Size, Text_Span &Span)
+  {
+    if (Offset < 0 || Size < 0 || Offset > Length || Size > Length - Offset) return 0;
+    Span.Start  = Begin + Offset;
+    Span.Length = Size;
+    return 1;
+  }
+
+
+//
+// Copy_Span
+//
+// Copies a span's text to Next and points the span at the copy.
+//
+static void Copy_Span(Text_Span &Span, char *&Next)
+  {
+    if (Span.Start == NULL) return;
+    memcpy(Next, Span.Start, Span.Length);
+    Span.Start = Next;
+    Next += Span.Length;
+  }
+
+
+//
+// Topic_Indexer::Topic_Indexer
+//
+// An empty index is just the placeholder and the terminator.
+//
+Topic_Indexer::Topic_Indexer() : Text(NULL), Text_Length(0), List(2, Message())
+  { }
+
+
+//
+// Topic_Indexer::Open_Topic
+//
+// Makes the topic file's text available as Text. Without mapping the file is read in
+//   whole; a file too big for one block of memory (over 64K in a 16 bit program) can't be
+//   indexed. An empty file has no text, as with a mapping.
+//
+bool Topic_Indexer::Open_Topic(const char *File_Name)
+  {
+    #ifdef TINDEX_MAPPED
+    if (!Map.Open(File_Name)) return false;
+    Text        = Map.Begin();
+    Text_Length = static_cast<long>(Map.Length());
+    return true;
+    #else
+    FILE *Topic = fopen(File_Name, "rb");
+    if (Topic == NULL) return false;
+
+    long Size = -1;
+    if (fseek(Topic, 0, SEEK_END) == 0) Size = ftell(Topic);
+    rewind(Topic);
+
+    int Good = Size >= 0 && static_cast<long>(static_cast<size_t>(Size)) == Size;
+    if (Good) {
+      Contents.resize(static_cast<size_t>(Size));
+      if (Size > 0 && fread(&Contents[0], 1, static_cast<size_t>(Size), Topic) != static_cast<size_t>(Size))
+        Good = 0;
+    }
+    fclose(Topic);
+    if (!Good) {
+      Close_Topic();
+      return false;
+    }
+    Text        = Contents.empty() ? NULL : &Contents[0];
+    Text_Length = Size;
+    return true;
+    #endif
+  }
+
+
+//
+// Topic_Indexer::Close_Topic
+//
+void Topic_Indexer::Close_Topic()
+  {
+    #ifdef TINDEX_MAPPED
+    Map.Close();
+    #else
+    std::vector<char>().swap(Contents);
+    #endif
+    Text        = NULL;
+    Text_Length = 0;
+  }
+
+
+//
+// Topic_Indexer::Index
+//
+// The messages are collected in file order, first from the sidecar and then
+//   by scanning whatever the sidecar doesn't cover, and then reversed so that
+//   the newest is first. The spans point into the file's text until the
+//   sidecar has been saved (it records them as offsets in the file) and are
+//   then moved to Fields.
+//
+int Topic_Indexer::Index(const char *File_Name)
+  {
+    List.assign(1, Message());
+
+    if (!Open_Topic(File_Name)) {
+      List.push_back(Message());
+      return 0;
+    }
+
+    std::string Sidecar_Name(File_Name);
+    Sidecar_Name.append(".idx");
+
+    long Length  = Text_Length;
+    long Indexed = -1;
+    long Resume  = Load_Sidecar(Sidecar_Name, Indexed);
+    if (Resume < Length) Scan(Text + Resume);
+
+    // The sidecar is rewritten only if the file has changed since it was.
+    if (Indexed != Length) {
+
+      // Find the start of the last line. If it isn't complete, more of it
+      //   may be appended later, so the next scan has to start there.
+      //
+      long Line_Start = Length;
+      while (Line_Start > 0 && Text[Line_Start - 1] != '\n') Line_Start--;
+      Save_Sidecar(Sidecar_Name, Line_Start);
+    }
+
+    // The placeholder holds the position just past the end of the file. Together
+    //   with the positions of the messages it gives each message's size.
+    //
+    List[0].FTell_Position = Length + 1;
+    std::reverse(List.begin() + 1, List.end());
+    List.push_back(Message());
+
+    Copy_Fields();
+    Close_Topic();
+    return Count();
+  }
+
+
+//
+// Topic_Indexer::Load_Sidecar
+//
+// Adds the messages recorded in the sidecar to the list and returns the offset
+//   at which scanning should resume. The length of the file the sidecar covers
+//   is put in Indexed. If there is no usable sidecar, nothing is added, the
+//   result is zero, and Indexed is left alone.
+//
+long Topic_Indexer::Load_Sidecar(const std::string &Sidecar_Name, long &Indexed)
+  {
+    FILE *Sidecar = fopen(Sidecar_Name.c_str(), "rb");
+    if (Sidecar == NULL) return 0;
+
+    const char    *Begin  = Text;
+    long           Length = Text_Length;
+    Sidecar_Header Header;
+
+    // The count is checked against the size of the sidecar before anything is
+    //   allocated for it, so a damaged count can't ask for a huge vector.
+    //
+    long Sidecar_Size = -1;
+    if (fseek(Sidecar, 0, SEEK_END) == 0) Sidecar_Size = ftell(Sidecar);
+    rewind(Sidecar);
+
+    int Good =
+      Sidecar_Size >= static_cast<long>(sizeof(Header)) &&
+      fread(&Header, sizeof(Header), 1, Sidecar) == 1 &&
+      memcmp(Header.Magic, Sidecar_Magic, sizeof(Sidecar_Magic)) == 0 &&
+      Header.Record_Size    == static_cast<long>(sizeof(Sidecar_Record)) &&
+      Header.Indexed_Length <= Length &&
+      Header.Resume_Offset  >= 0 &&
+      Header.Resume_Offset  <= Header.Indexed_Length &&
+      Header.Count          >= 0 &&
+      Header.Count          <= (Sidecar_Size - static_cast<long>(sizeof(Header))) / Header.Record_Size &&
+      Header.Tail_Sum == Tail_Checksum(Begin, Header.Indexed_Length);
+
+    // Read the records in one piece. A short read means the sidecar was cut off.
+    std::vector<Sidecar_Record> Records;
+    if (Good) {
+      Records.resize(Header.Count);
+      if (Header.Count > 0 &&
+          fread(&Records[0], sizeof(Sidecar_Record), Header.Count, Sidecar) != static_cast<size_t>(Header.Count))
+        Good = 0;
+    }
+    fclose(Sidecar);
+    if (!Good) return 0;
+
+    List.reserve(Records.size() + 2);
+    for (size_t i = 0; i < Records.size(); i++) {
+      Sidecar_Record &Record = Records[i];
+      Message         The_Message;
+
+      // A message whose header line wasn't complete is found again by the scan.
+      if (Record.Username_Offset - 1 >= Header.Resume_Offset) break;
+
+      if (!Span_Of(Begin, Header.Indexed_Length, Record.Username_Offset, Record.Username_Length, The_Message.Username) ||
+          !Span_Of(Begin, Header.Indexed_Length, Record.Date_Offset,     Record.Date_Length,     The_Message.Date_String) ||
+          !Span_Of(Begin, Header.Indexed_Length, Record.Subject_Offset,  Record.Subject_Length,  The_Message.Subject_Line)) {
+        List.resize(1);
+        return 0;
+      }
+      The_Message.Posted_On      = Record.Posted_On;
+      The_Message.FTell_Position = Record.FTell_Position;
+      List.push_back(The_Message);
+    }
+    Indexed = Header.Indexed_Length;
+    return Header.Resume_Offset;
+  }
+
+
+//
+// Topic_Indexer::Save_Sidecar
+//
+// The sidecar is written under a temporary name and then renamed so that a
+//   reader never sees half of it. The temporary name includes the process ID
+//   since several users may index the same topic at once. Failure is not an
+//   error; the topic is just indexed from the start next time.
+//
+void Topic_Indexer::Save_Sidecar(const std::string &Sidecar_Name, long Resume_Offset)
+  {
+    const char *Begin = Text;
+    char        Suffix[32];
+    sprintf(Suffix, ".%ld.new", static_cast<long>(getpid()));
+
+    std::string New_Name(Sidecar_Name);
+    New_Name.append(Suffix);
+
+    FILE *Sidecar = fopen(New_Name.c_str(), "wb");
+    if (Sidecar == NULL) return;
+
+    Sidecar_Header Header;
+    memset(&Header, 0, sizeof(Header));
+    memcpy(Header.Magic, Sidecar_Magic, sizeof(Sidecar_Magic));
+    Header.Record_Size    = sizeof(Sidecar_Record);
+    Header.Indexed_Length = Text_Length;
+    Header.Resume_Offset  = Resume_Offset;
+    Header.Tail_Sum       = Tail_Checksum(Begin, Header.Indexed_Length);
+    Header.Count          = static_cast<long>(List.size()) - 1;
+
+    std::vector<Sidecar_Record> Records(List.size() - 1);
+    for (size_t i = 1; i < List.size(); i++) {
+      Sidecar_Record &Record = Records[i - 1];
+      Message        &The_Message = List[i];
+
+      Record.Username_Offset = static_cast<long>(The_Message.Username.Start     - Begin);
+      Record.Username_Length = The_Message.Username.Length;
+      Record.Date_Offset     = static_cast<long>(The_Message.Date_String.Start  - Begin);
+      Record.Date_Length     = The_Message.Date_String.Length;
+      Record.Subject_Offset  = static_cast<long>(The_Message.Subject_Line.Start - Begin);
+      Record.Subject_Length  = The_Message.Subject_Line.Length;
+      Record.FTell_Position  = The_Message.FTell_Position;
+      Record.Posted_On       = The_Message.Posted_On;
+    }
+
+    int Written = fwrite(&Header, sizeof(Header), 1, Sidecar) == 1;
+    if (Written && !Records.empty())
+      Written = fwrite(&Records[0], sizeof(Sidecar_Record), Records.size(), Sidecar) == Records.size();
+    if (fclose(Sidecar) != 0) Written = 0;
+    if (!Written) {
+      remove(New_Name.c_str());
+      return;
+    }
+
+    // Rename won't replace an existing file except on Unix.
+    #if OS != UNIX
+    remove(Sidecar_Name.c_str());
+    #endif
+    if (rename(New_Name.c_str(), Sidecar_Name.c_str()) != 0) remove(New_Name.c_str());
+  }
+
+
+//
+// Topic_Indexer::Copy_Fields
+//
+// One buffer holds all the fields so that a topic with many messages costs a
+//   single allocation. It has a spare byte so that it is never empty.
+//
+void Topic_Indexer::Copy_Fields()
+  {
+    size_t Total = 0;
+    for (size_t i = 1; i < List.size(); i++) {
+      Total += List[i].Username.Length + List[i].Date_String.Length + List[i].Subject_Line.Length;
+    }
+    Fields.assign(Total + 1, '\0');
+
+    char *Next = &Fields[0];
+    for (size_t i = 1; i < List.size(); i++) {
+      Copy_Span(List[i].Username,     Next);
+      Copy_Span(List[i].Date_String,  Next);
+      Copy_Span(List[i].Subject_Line, Next);
+    }
+  }
+
+
+//
+// Topic_Indexer::Scan
+//
+// Adds the messages whose header lines start at or after From to the list.
+//   From must be the start of a line.
+//
+void Topic_Indexer::Scan(const char *From)
+  {
+    const char *Begin = Text;
+    const char *End   = Text + Text_Length;
+    const char *Scan  = From;
+
+    while (Scan < End) {
+      const char *Bar = static_cast<const char *>(memchr(Scan, '|', End - Scan));
+      if (Bar == NULL) break;
+      Scan = Bar + 1;
+
+      // Skip this '|' if it doesn't start a line.
+      if (Bar != Begin && Bar[-1] != '\n') continue;
+
+      const char *Line_End = static_cast<const char *>(memchr(Bar, '\n', End - Bar));
+      const char *Next     = (Line_End == NULL) ? End : Line_End + 1;
+      if (Line_End == NULL) Line_End = End;
+
+      // Somebody forgot to check for carriage returns... The file is binary
+      //   (it used to be encrypted) so they are still there.
+      const char *Return = static_cast<const char *>(memchr(Bar, '\r', Line_End - Bar));
+      if (Return != NULL) Line_End = Return;
+
+      Message     The_Message;
+      const char *Field = Bar + 1;
+      The_Message.Username     = Next_Field(Field, Line_End);
+      The_Message.Date_String  = Next_Field(Field, Line_End);
+      The_Message.Subject_Line = Next_Field(Field, Line_End);
+      Extract_MessageDate(&The_Message);
+
+      // Remember the file position for the start of the line right after the header.
+      The_Message.FTell_Position = static_cast<long>(Next - Begin);
+      List.push_back(The_Message);
+
+      // The next header can start right after the newline.
+      Scan = Next;
+    }
+  }
@@ -0,0 +1,94 @@
+/****************************************************************************
+FILE          : tindex.h
+LAST REVISION : October 2026
+SUBJECT       : Interface to the topic file indexer.
+PROGRAMMER    : (C) Copyright 2026 by VTC^3
+
+A Topic_Indexer maps a topic file into memory and finds the header line
+('|' Username '|' Date '|' Subject) of every message in it. Where files
+can't be mapped (MS-DOS, which lc was written for) the whole file is read
+into a buffer instead. When the scan is done the fields are copied into one
+buffer owned by the indexer and the file is released. A topic file that is edited or cut short later (by
+another user's copy of the program, say) can't then fault this one the way
+a read past the end of a shrunken mapping would. The fields are valid until
+the next topic is indexed. There is no limit on the number of messages.
+
+The message list has the layout the rest of the program expects. Element
+zero is a placeholder whose FTell_Position is one past the end of the file.
+The messages follow, newest first, and a message with no Username ends the
+list.
+
+Each topic's index is also saved in a sidecar file, named by adding ".idx"
+to the topic file's name. Topic files only ever grow (Add() in lc.cpp
+appends to them), so when a topic is indexed again only the bytes added
+since the sidecar was written need to be scanned. The sidecar records how
+much of the topic file it covers and a checksum of the last few kilobytes of
+that part. If the file has become shorter or the checksum no longer matches,
+the topic was edited rather than appended to and it is indexed from the
+start. If the sidecar can't be written (the topic directory is read only,
+say) every index is a full one, as before.
+
+The indexer uses ../rfcdate.cpp from NBread's directory and, on Win32 and
+Unix, ../mapfile.cpp as well. They include NBread's environ.hpp (found next
+to them), not environ.h, and must be compiled and linked with lc. See
+notes.txt for the compilers that can build lc.
+****************************************************************************/
+
+#ifndef TINDEX_H
+#define TINDEX_H
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "message.h"
+
+// Topic files are mapped where Mapped_File can do it. Elsewhere they are read.
+#if OS == WIN32 || OS == UNIX
+#define TINDEX_MAPPED
+#include "../mapfile.hpp"
+#endif
+
+class Topic_Indexer {
+  public:
+    Topic_Indexer();
+
+    int Index(const char *File_Name);
+      // Indexes the named topic file, replacing the previous index. Returns
+      //   the number of messages (zero if the file can't be opened).
+
+    Message *Messages()    { return &List[0]; }
+    int      Count() const { return static_cast<int>(List.size()) - 2; }
+
+  private:
+    #ifdef TINDEX_MAPPED
+    Mapped_File          Map;
+    #else
+    std::vector<char>    Contents;     // The whole topic file.
+    #endif
+    const char          *Text;         // The topic file's text while it is being indexed.
+    long                 Text_Length;
+    std::vector<Message> List;
+    std::vector<char>    Fields;       // The header fields, copied out of the file.
+
+    bool Open_Topic(const char *File_Name);
+    void Close_Topic();
+    long Load_Sidecar(const std::string &Sidecar_Name, long &Indexed);
+    void Save_Sidecar(const std::string &Sidecar_Name, long Resume_Offset);
+    void Scan(const char *From);
+    void Copy_Fields();
+
+    // Topic_Indexers can't be copied. The spans point into Fields.
+    Topic_Indexer(const Topic_Indexer &);
+    Topic_Indexer &operator=(const Topic_Indexer &);
+};
+
+// Returns 1 if the span holds exactly the given text; 0 otherwise.
+inline int Span_Is(const Text_Span &Span, const char *Text)
+  {
+    return Span.Start != NULL &&
+           static_cast<size_t>(Span.Length) == strlen(Text) &&
+           memcmp(Span.Start, Text, Span.Length) == 0;
+  }
+
+#endif
@@ -143,7 +143,7 @@ to a nicer format. It is not very important to the program.
 char *AdjDate(char *ANSI_Date)
   {
     static char  Buffer[13];
-    auto   char *Buffer_Pntr;
+    char        *Buffer_Pntr;
 
     strcpy(Buffer, ANSI_Date);
     for (Buffer_Pntr  = strchr(Buffer,'\0');
@@ -0,0 +1,214 @@
+/****************************************************************************
+FILE          : ntable.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the Notice_Table class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cctype>
+#include <cstring>
+
+using namespace std;
+
+#include "ntable.hpp"
+
+//
+// Bit_Count
+//
+// Returns the number of set bits in a word. This is the usual parallel counting trick; it
+//   avoids a loop per bit and doesn't depend on compiler intrinsics.
+//
+static int Bit_Count(unsigned long Word)
+  {
+    int Count = 0;
+    while (Word != 0) {
+      unsigned long Low = Word & 0xFFFFFFFFUL;
+      Low = Low - ((Low >> 1) & 0x55555555UL);
+      Low = (Low & 0x33333333UL) + ((Low >> 2) & 0x33333333UL);
+      Low = (Low + (Low >> 4)) & 0x0F0F0F0FUL;
+      Count += static_cast<int>(((Low * 0x01010101UL) & 0xFFFFFFFFUL) >> 24);
+
+      // Deal with the upper half on machines where long is 64 bits.
+      Word = (sizeof(unsigned long) > 4) ? (Word >> 16) >> 16 : 0;
+    }
+    return Count;
+  }
+
+
+//
+// Notice_Table::Notice_Table
+//
+// Offset zero in the blob is always an empty string. Rows without a summary point there.
+//
+Notice_Table::Notice_Table()
+  {
+    Strings.push_back('\0');
+  }
+
+
+//
+// Notice_Table::Store
+//
+unsigned Notice_Table::Store(const char *Text)
+  {
+    if (Text == 0 || *Text == '\0') return 0;
+
+    unsigned Offset = static_cast<unsigned>(Strings.size());
+    Strings.insert(Strings.end(), Text, Text + strlen(Text) + 1);
+    return Offset;
+  }
+
+
+//
+// Notice_Table::Add
+//
+int Notice_Table::Add(const char *Path)
+  {
+    int Row = Size();
+
+    Path_Offset.push_back(Store(Path));
+    Subject_Offset.push_back(0);
+    Poster_Offset.push_back(0);
+    Date_Offset.push_back(0);
+    ID_Offset.push_back(0);
+    References_Offset.push_back(0);
+    Key.push_back(0);
+    Summary_Flags.push_back(0);
+    if (Row % Bits_PerWord == 0) Read_Bits.push_back(0);
+
+    return Row;
+  }
+
+
+//
+// Notice_Table::Clear
+//
+// The swap idiom is used so that the memory is actually released and not just marked as
+//   unused.
+//
+void Notice_Table::Clear()
+  {
+    Notice_Table Empty;
+    Swap(Empty);
+  }
+
+
+//
+// Notice_Table::Swap
+//
+void Notice_Table::Swap(Notice_Table &Other)
+  {
+    Strings.swap(Other.Strings);
+    Path_Offset.swap(Other.Path_Offset);
+    Subject_Offset.swap(Other.Subject_Offset);
+    Poster_Offset.swap(Other.Poster_Offset);
+    Date_Offset.swap(Other.Date_Offset);
+    ID_Offset.swap(Other.ID_Offset);
+    References_Offset.swap(Other.References_Offset);
+    Key.swap(Other.Key);
+    Summary_Flags.swap(Other.Summary_Flags);
+    Read_Bits.swap(Other.Read_Bits);
+  }
+
+
+//
+// Notice_Table::Find
+//
+// Paths on the noticeboard are case insensitive so the comparison is too.
+//
+int Notice_Table::Find(const char *Path) const
+  {
+    for (int Row = 0; Row < Size(); Row++) {
+      const char *L = &Strings[Path_Offset[Row]];
+      const char *R = Path;
+      while (*L != '\0' && toupper(static_cast<unsigned char>(*L)) == toupper(static_cast<unsigned char>(*R))) {
+        L++;
+        R++;
+      }
+      if (*L == '\0' && *R == '\0') return Row;
+    }
+    return -1;
+  }
+
+
+//
+// Notice_Table::Set_Summary
+//
+void Notice_Table::Set_Summary(
+  int         Row,
+  const char *Subject,
+  const char *Poster,
+  const char *Display_Date,
+  long long   Date_Key)
+  {
+    Subject_Offset[Row] = Store(Subject);
+    Poster_Offset[Row]  = Store(Poster);
+    Date_Offset[Row]    = Store(Display_Date);
+    Key[Row]            = Date_Key;
+    Summary_Flags[Row]  = 1;
+  }
+
+
+//
+// Notice_Table::Set_Threading
+//
+void Notice_Table::Set_Threading(int Row, const char *Message_ID, const char *References)
+  {
+    ID_Offset[Row]         = Store(Message_ID);
+    References_Offset[Row] = Store(References);
+  }
+
+
+//
+// Notice_Table::Set_Read
+//
+void Notice_Table::Set_Read(int Row, bool Read)
+  {
+    unsigned long Mask = 1UL << (Row % Bits_PerWord);
+    if (Read) Read_Bits[Row / Bits_PerWord] |=  Mask;
+    else      Read_Bits[Row / Bits_PerWord] &= ~Mask;
+  }
+
+
+//
+// Notice_Table::Unread_Count
+//
+// Bits beyond the last row in the final word are always clear, so the count of read rows
+//   is just the population count of the whole array.
+//
+int Notice_Table::Unread_Count() const
+  {
+    int Read_Count = 0;
+    vector<unsigned long>::const_iterator Stepper;
+    for (Stepper = Read_Bits.begin(); Stepper != Read_Bits.end(); Stepper++) {
+      Read_Count += Bit_Count(*Stepper);
+    }
+    return Size() - Read_Count;
+  }
@@ -0,0 +1,120 @@
+/****************************************************************************
+FILE          : ntable.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the Notice_Table class.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+A Notice_Table holds the summary information for every notice in one topic.
+Instead of one heap object per notice, the table is organized as a set of
+parallel arrays (one per field) with all of the text stored in a single
+string blob. Rows are identified by their index. Fields that refer to text
+hold offsets into the blob rather than pointers so that the blob can grow
+without invalidating them.
+
+Because everything lives in a handful of contiguous arrays, the whole table
+is released in one operation and scans over a single field (sorting by date,
+counting unread notices, etc) walk through memory sequentially.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef NTABLE_H
+#define NTABLE_H
+
+#include <vector>
+
+class Notice_Table {
+  public:
+    Notice_Table();
+
+    int Add(const char *Path);
+      // Appends a row for the notice file with the given full path. Returns the row
+      //   index. The summary fields of the new row are empty until Set_Summary().
+
+    int  Size() const { return static_cast<int>(Path_Offset.size()); }
+
+    void Clear();
+      // Releases every row and all of the text in one operation.
+
+    void Swap(Notice_Table &Other);
+      // Exchanges the contents of two tables in constant time.
+
+    int Find(const char *Path) const;
+      // Returns the row for the given path (compared without regard to case) or -1.
+
+    const char *Path(int Row)         const { return &Strings[Path_Offset[Row]];    }
+    const char *Subject(int Row)      const { return &Strings[Subject_Offset[Row]]; }
+    const char *Poster(int Row)       const { return &Strings[Poster_Offset[Row]];  }
+    const char *Display_Date(int Row) const { return &Strings[Date_Offset[Row]];    }
+    long long   Date_Key(int Row)     const { return Key[Row]; }
+    const char *Message_ID(int Row)   const { return &Strings[ID_Offset[Row]];         }
+    const char *References(int Row)   const { return &Strings[References_Offset[Row]]; }
+      // Field access. The pointers are invalidated by any operation that adds text.
+
+    bool Has_Summary(int Row) const { return Summary_Flags[Row] != 0; }
+
+    void Set_Summary(
+      int         Row,
+      const char *Subject,
+      const char *Poster,
+      const char *Display_Date,
+      long long   Date_Key
+    );
+      // Installs the summary information for a row. Larger date keys are later dates.
+
+    void Set_Threading(int Row, const char *Message_ID, const char *References);
+      // Installs the message identifiers used to thread a row. References lists the
+      //   identifiers of the notice's ancestors, oldest first.
+
+    bool Is_Read(int Row) const
+      { return (Read_Bits[Row / Bits_PerWord] >> (Row % Bits_PerWord)) & 1UL; }
+
+    void Set_Read(int Row, bool Read);
+      // Updates the cached read state of a row. The history database remains the
+      //   authority; these bits only mirror it.
+
+    int Unread_Count() const;
+      // Counts the rows whose read bit is clear.
+
+  private:
+    enum { Bits_PerWord = 8 * sizeof(unsigned long) };
+
+    std::vector<char>          Strings;         // Every string in the table, null terminated.
+    std::vector<unsigned>      Path_Offset;     // Offsets into Strings for each field...
+    std::vector<unsigned>      Subject_Offset;
+    std::vector<unsigned>      Poster_Offset;
+    std::vector<unsigned>      Date_Offset;
+    std::vector<unsigned>      ID_Offset;
+    std::vector<unsigned>      References_Offset;
+    std::vector<long long>     Key;             // UTC seconds; used for sorting.
+    std::vector<unsigned char> Summary_Flags;   // =1 when the row's summary is filled in.
+    std::vector<unsigned long> Read_Bits;       // One bit per row; set when read.
+
+    unsigned Store(const char *Text);
+      // Copies text into the blob and returns its offset.
+};
+
+#endif
@@ -0,0 +1,438 @@
+/****************************************************************************
+FILE          : rfcdate.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the date parser.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <cctype>
+#include <cstring>
+
+#include "rfcdate.hpp"
+
+enum Daylight_Rules { No_Daylight, US_Daylight, EU_Daylight };
+
+static const char *Month_Names[] = {
+  "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC", 0 };
+
+static const char *Day_Names[] = {
+  "SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT", 0 };
+
+struct Named_Zone {
+  const char *Name;
+  long        Hours;  // East of UTC.
+};
+
+// The zones RFC 822 allowed, plus a few that commonly appear anyway.
+static const Named_Zone Named_Zones[] = {
+  { "UT",   0 }, { "UTC",  0 }, { "GMT",  0 }, { "Z",    0 },
+  { "EST", -5 }, { "EDT", -4 }, { "CST", -6 }, { "CDT", -5 },
+  { "MST", -7 }, { "MDT", -6 }, { "PST", -8 }, { "PDT", -7 },
+  { "BST",  1 }, { "CET",  1 }, { "CEST", 2 }, { 0,      0 }
+};
+
+//
+// Upper
+//
+static inline char Upper(char Ch)
+  {
+    return static_cast<char>(toupper(static_cast<unsigned char>(Ch)));
+  }
+
+
+//
+// Is_Digit, Is_Alpha
+//
+static inline bool Is_Digit(char Ch) { return Ch >= '0' && Ch <= '9'; }
+static inline bool Is_Alpha(char Ch) { return isalpha(static_cast<unsigned char>(Ch)) != 0; }
+
+
+//
+// Find_Name
+//
+// Looks up the first three letters of a token in a table of three letter names. The rest
+//   of the token must be letters too (so that "Thurs" and "December" are accepted). Returns
+//   the index of the name or -1.
+//
+static int Find_Name(const char **Names, const char *Token, int Length)
+  {
+    if (Length < 3) return -1;
+    for (int i = 3; i < Length; i++) {
+      if (!Is_Alpha(Token[i])) return -1;
+    }
+    for (int Index = 0; Names[Index] != 0; Index++) {
+      const char *Name = Names[Index];
+      if (Upper(Token[0]) == Name[0] && Upper(Token[1]) == Name[1] && Upper(Token[2]) == Name[2])
+        return Index;
+    }
+    return -1;
+  }
+
+
+//
+// Scan_Number
+//
+// Reads an unsigned decimal number. Stepper is left at the first non-digit.
+//
+static int Scan_Number(const char *&Stepper, const char *End)
+  {
+    int Value = 0;
+    while (Stepper < End && Is_Digit(*Stepper)) {
+      Value = 10 * Value + (*Stepper - '0');
+      Stepper++;
+    }
+    return Value;
+  }
+
+
+//
+// Day_Number
+//
+// Returns the number of days since 1970-01-01 for a date in the proleptic Gregorian
+//   calendar. This is the well known algorithm based on 400 year eras.
+//
+static long Day_Number(int Year, int Month, int Day)
+  {
+    long Y   = Year - (Month <= 2 ? 1 : 0);
+    long Era = (Y >= 0 ? Y : Y - 399) / 400;
+    long YOE = Y - Era * 400;
+    long DOY = (153 * (Month + (Month > 2 ? -3 : 9)) + 2) / 5 + Day - 1;
+    long DOE = YOE * 365 + YOE / 4 - YOE / 100 + DOY;
+    return Era * 146097 + DOE - 719468;
+  }
+
+
+//
+// Sunday
+//
+// Returns the day of the month of the Nth Sunday in the given month. If N is zero the last
+//   Sunday is returned.
+//
+static int Sunday(int Year, int Month, int N)
+  {
+    static const int Month_Length[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    if (N > 0) {
+      long First   = Day_Number(Year, Month, 1);
+      int  Weekday = static_cast<int>(((First + 4) % 7 + 7) % 7);  // 1970-01-01 was a Thursday.
+      return 1 + (7 - Weekday) % 7 + 7 * (N - 1);
+    }
+
+    int Last_Day = Month_Length[Month - 1];
+    if (Month == 2 && (Year % 4 == 0 && (Year % 100 != 0 || Year % 400 == 0))) Last_Day++;
+    long Last    = Day_Number(Year, Month, Last_Day);
+    int  Weekday = static_cast<int>(((Last + 4) % 7 + 7) % 7);
+    return Last_Day - Weekday;
+  }
+
+
+//
+// In_Daylight
+//
+// Returns true if the given wall clock time falls within daylight saving time. The wall
+//   clock time is expressed as seconds in the same scale as Civil_Seconds().
+//
+static bool In_Daylight(
+  int Rules, const Date_Parts &Parts, long Standard_Offset, long Daylight_Offset)
+  {
+    long long Wall = Date_Parser::Civil_Seconds(
+      Parts.Year, Parts.Month, Parts.Day, Parts.Hour, Parts.Minute, Parts.Second);
+    long long Start;
+    long long End;
+
+    if (Rules == US_Daylight) {
+      // Changes happen at 02:00 local time.
+      if (Parts.Year >= 2007) {
+        Start = Date_Parser::Civil_Seconds(Parts.Year,  3, Sunday(Parts.Year,  3, 2), 2, 0, 0);
+        End   = Date_Parser::Civil_Seconds(Parts.Year, 11, Sunday(Parts.Year, 11, 1), 2, 0, 0);
+      }
+      else if (Parts.Year >= 1987) {
+        Start = Date_Parser::Civil_Seconds(Parts.Year,  4, Sunday(Parts.Year,  4, 1), 2, 0, 0);
+        End   = Date_Parser::Civil_Seconds(Parts.Year, 10, Sunday(Parts.Year, 10, 0), 2, 0, 0);
+      }
+      else if (Parts.Year >= 1967) {
+        Start = Date_Parser::Civil_Seconds(Parts.Year,  4, Sunday(Parts.Year,  4, 0), 2, 0, 0);
+        End   = Date_Parser::Civil_Seconds(Parts.Year, 10, Sunday(Parts.Year, 10, 0), 2, 0, 0);
+      }
+      else return false;
+    }
+    else if (Rules == EU_Daylight) {
+      // Changes happen at 01:00 UTC.
+      if (Parts.Year < 1981) return false;
+      int End_Month = (Parts.Year >= 1996) ? 10 : 9;
+      Start = Date_Parser::Civil_Seconds(Parts.Year, 3, Sunday(Parts.Year, 3, 0), 1, 0, 0) + Standard_Offset;
+      End   = Date_Parser::Civil_Seconds(
+        Parts.Year, End_Month, Sunday(Parts.Year, End_Month, 0), 1, 0, 0) + Daylight_Offset;
+    }
+    else return false;
+
+    return Wall >= Start && Wall < End;
+  }
+
+
+//
+// Date_Parser::Date_Parser
+//
+Date_Parser::Date_Parser() : Next_Slot(0)
+  {
+    for (int i = 0; i < Cache_Size; i++) Cache[i].Name[0] = '\0';
+  }
+
+
+//
+// Date_Parser::Civil_Seconds
+//
+long long Date_Parser::Civil_Seconds(int Year, int Month, int Day, int Hour, int Minute, int Second)
+  {
+    return static_cast<long long>(Day_Number(Year, Month, Day)) * 86400L +
+      Hour * 3600L + Minute * 60L + Second;
+  }
+
+
+//
+// Date_Parser::Decode_Zone
+//
+// Zones are either one of the names in the table above or POSIX TZ style strings such as
+//   "EST5EDT" (standard name, hours WEST of UTC, daylight name). Single letter military
+//   zones are deliberately not recognized; RFC 5322 says to treat them as unknown.
+//
+void Date_Parser::Decode_Zone(const char *Name, int Length, Zone_Rule &Rule)
+  {
+    Rule.Standard_Offset = 0;
+    Rule.Daylight_Offset = 0;
+    Rule.Rules           = No_Daylight;
+    Rule.Known           = false;
+
+    for (const Named_Zone *Zone = Named_Zones; Zone->Name != 0; Zone++) {
+      int i = 0;
+      while (i < Length && Zone->Name[i] != '\0' && Upper(Name[i]) == Zone->Name[i]) i++;
+      if (i == Length && Zone->Name[i] == '\0') {
+        Rule.Standard_Offset = Zone->Hours * 3600L;
+        Rule.Known           = true;
+        return;
+      }
+    }
+
+    // Try the POSIX form. The standard zone name must be at least three letters.
+    const char *Stepper = Name;
+    const char *End     = Name + Length;
+    while (Stepper < End && Is_Alpha(*Stepper)) Stepper++;
+    if (Stepper - Name < 3 || Stepper == End) return;
+
+    int Sign = 1;
+    if (*Stepper == '+' || *Stepper == '-') {
+      if (*Stepper == '-') Sign = -1;
+      Stepper++;
+    }
+    if (Stepper == End || !Is_Digit(*Stepper)) return;
+    long West = Scan_Number(Stepper, End) * 3600L;
+    if (Stepper < End && *Stepper == ':') {
+      Stepper++;
+      West += Scan_Number(Stepper, End) * 60L;
+    }
+    Rule.Standard_Offset = -Sign * West;
+    Rule.Daylight_Offset = Rule.Standard_Offset + 3600L;
+    Rule.Known           = true;
+
+    // Is there a daylight saving time zone name?
+    const char *DST_Name = Stepper;
+    while (Stepper < End && Is_Alpha(*Stepper)) Stepper++;
+    if (Stepper - DST_Name < 3) return;
+
+    // The POSIX form allows explicit transition rules after the name. Those are rare in
+    //   practice; the US rules are assumed unless the zone looks European.
+    Rule.Rules = (Rule.Standard_Offset >= 0 && Rule.Standard_Offset <= 3 * 3600L) ? EU_Daylight : US_Daylight;
+    if (Stepper < End && (Is_Digit(*Stepper) || *Stepper == '+' || *Stepper == '-')) {
+      Sign = 1;
+      if (*Stepper == '+' || *Stepper == '-') {
+        if (*Stepper == '-') Sign = -1;
+        Stepper++;
+      }
+      Rule.Daylight_Offset = -Sign * Scan_Number(Stepper, End) * 3600L;
+    }
+  }
+
+
+//
+// Date_Parser::Lookup_Zone
+//
+// The cache is small and replaced round robin. Zone strings that don't fit in a slot are
+//   still decoded, but they will never be found again.
+//
+const Date_Parser::Zone_Rule &Date_Parser::Lookup_Zone(const char *Name, int Length)
+  {
+    for (int i = 0; i < Cache_Size; i++) {
+      if (Length < static_cast<int>(sizeof(Cache[i].Name)) &&
+          Cache[i].Name[Length] == '\0' && memcmp(Cache[i].Name, Name, Length) == 0)
+        return Cache[i];
+    }
+
+    Zone_Rule &Slot = Cache[Next_Slot];
+    Next_Slot = (Next_Slot + 1) % Cache_Size;
+
+    Decode_Zone(Name, Length, Slot);
+    if (Length < static_cast<int>(sizeof(Slot.Name))) {
+      memcpy(Slot.Name, Name, Length);
+      Slot.Name[Length] = '\0';
+    }
+    else {
+      Slot.Name[0] = '\0';
+    }
+    return Slot;
+  }
+
+
+//
+// Date_Parser::Parse
+//
+// The date is broken into tokens at white space and commas; comments in parentheses are
+//   skipped. Each token is then recognized by its form rather than its position, which
+//   lets the same scanner handle the RFC 5322 order (day month year) and the ctime order
+//   (month day time year).
+//
+bool Date_Parser::Parse(const char *Text, Date_Parts &Parts)
+  {
+    Parts.Year        = -1;
+    Parts.Month       = -1;
+    Parts.Day         = -1;
+    Parts.Hour        = 0;
+    Parts.Minute      = 0;
+    Parts.Second      = 0;
+    Parts.Zone_Offset = 0;
+    Parts.Have_Time   = false;
+    Parts.Have_Zone   = false;
+
+    const char *Zone_Name   = 0;
+    int         Zone_Length = 0;
+
+    const char *Stepper = Text;
+    while (*Stepper != '\0') {
+
+      // Skip separators and comments.
+      if (*Stepper == ' ' || *Stepper == '\t' || *Stepper == ',' || *Stepper == '\r' || *Stepper == '\n') {
+        Stepper++;
+        continue;
+      }
+      if (*Stepper == '(') {
+        int Depth = 0;
+        do {
+          if (*Stepper == '(') Depth++;
+          if (*Stepper == ')') Depth--;
+          Stepper++;
+        } while (*Stepper != '\0' && Depth > 0);
+        continue;
+      }
+
+      // Find the end of the token.
+      const char *Token = Stepper;
+      while (*Stepper != '\0' && *Stepper != ' ' && *Stepper != '\t' && *Stepper != ',' &&
+             *Stepper != '\r' && *Stepper != '\n' && *Stepper != '(') Stepper++;
+      const char *End    = Stepper;
+      int         Length = static_cast<int>(End - Token);
+
+      // Time of day.
+      if (Is_Digit(*Token) && memchr(Token, ':', Length) != 0) {
+        const char *p = Token;
+        Parts.Hour   = Scan_Number(p, End);
+        if (p < End && *p == ':') { p++; Parts.Minute = Scan_Number(p, End); }
+        if (p < End && *p == ':') { p++; Parts.Second = Scan_Number(p, End); }
+        Parts.Have_Time = true;
+      }
+
+      // Numeric zone.
+      else if ((*Token == '+' || *Token == '-') && Length == 5 && Is_Digit(Token[1])) {
+        const char *p = Token + 1;
+        int Value = Scan_Number(p, End);
+        if (p != End) continue;
+        long Offset = (Value / 100) * 3600L + (Value % 100) * 60L;
+        Parts.Zone_Offset = (*Token == '-') ? -Offset : Offset;
+        Parts.Have_Zone   = true;
+        Zone_Name = 0;
+      }
+
+      // Day of the month or year.
+      else if (Is_Digit(*Token)) {
+        const char *p = Token;
+        int Value = Scan_Number(p, End);
+        if (p != End) continue;
+        if (Parts.Day < 0 && Length <= 2 && Value >= 1 && Value <= 31) {
+          Parts.Day = Value;
+        }
+        else if (Parts.Year < 0) {
+          if      (Length == 2) Parts.Year = Value + (Value < 50 ? 2000 : 1900);
+          else if (Length == 3) Parts.Year = Value + 1900;
+          else                  Parts.Year = Value;
+        }
+      }
+
+      // Names: months, days of the week, and zones.
+      else if (Is_Alpha(*Token)) {
+        int Month;
+        if (Parts.Month < 0 && (Month = Find_Name(Month_Names, Token, Length)) >= 0) {
+          Parts.Month = Month + 1;
+        }
+        else if (Find_Name(Day_Names, Token, Length) >= 0) {
+          // The day of the week is redundant.
+        }
+        else if (!Parts.Have_Zone && Zone_Name == 0) {
+          Zone_Name   = Token;
+          Zone_Length = Length;
+        }
+      }
+    }
+
+    if (Parts.Year < 0 || Parts.Month < 0 || Parts.Day < 0) return false;
+
+    // Zone rules can depend on the date so zone names are applied last.
+    if (Zone_Name != 0) {
+      const Zone_Rule &Rule = Lookup_Zone(Zone_Name, Zone_Length);
+      if (Rule.Known) {
+        bool Daylight = In_Daylight(Rule.Rules, Parts, Rule.Standard_Offset, Rule.Daylight_Offset);
+        Parts.Zone_Offset = Daylight ? Rule.Daylight_Offset : Rule.Standard_Offset;
+        Parts.Have_Zone   = true;
+      }
+    }
+    return true;
+  }
+
+
+//
+// Date_Parser::To_UTC
+//
+bool Date_Parser::To_UTC(const char *Text, long long &Seconds)
+  {
+    Date_Parts Parts;
+
+    Seconds = 0;
+    if (!Parse(Text, Parts)) return false;
+    Seconds = Civil_Seconds(Parts.Year, Parts.Month, Parts.Day, Parts.Hour, Parts.Minute, Parts.Second) -
+      Parts.Zone_Offset;
+    return true;
+  }
@@ -0,0 +1,95 @@
+/****************************************************************************
+FILE          : rfcdate.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the date parser.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+The Date_Parser class turns the dates found in notices into UTC seconds since
+1970-01-01. It understands RFC 5322 dates ("Thu, 29 Dec 2005 22:57:28 -0500")
+as well as the older forms used on the noticeboard: POSIX style zone names
+with daylight saving time rules ("EST5EDT"), the obsolete named zones (EST,
+PDT, GMT, etc), and the ctime-like dates of the LC topic files ("Mon Jan 5
+14:30 1997", with or without the time).
+
+The scanner is hand written; it doesn't use sscanf or allocate memory.
+Recently seen zone strings are remembered so that the zone rules for a topic
+(which usually all come from the same place) are only worked out once.
+
+A Date_Parser is not thread safe. Use one per thread.
+
+This header is self contained so that programs outside of NBread can use it.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef RFCDATE_H
+#define RFCDATE_H
+
+struct Date_Parts {
+  int  Year;         // Four digit year.
+  int  Month;        // 1 .. 12
+  int  Day;          // 1 .. 31
+  int  Hour;         // 0 .. 23
+  int  Minute;
+  int  Second;
+  long Zone_Offset;  // Seconds east of UTC in effect at the given time.
+  bool Have_Time;    // =false if the date had no time of day (it is then midnight).
+  bool Have_Zone;    // =false if no zone was recognized (UTC is then assumed).
+};
+
+class Date_Parser {
+  public:
+    Date_Parser();
+
+    bool Parse(const char *Text, Date_Parts &Parts);
+      // Breaks the date into its parts. Returns false if the day, month, and year could
+      //   not all be found. Fields that weren't found are set to -1 (time fields to 0).
+
+    bool To_UTC(const char *Text, long long &Seconds);
+      // Converts the date to UTC seconds since the epoch. Returns false (and sets Seconds
+      //   to zero) if the date couldn't be parsed.
+
+    static long long Civil_Seconds(int Year, int Month, int Day, int Hour, int Minute, int Second);
+      // Seconds since the epoch for the given broken down UTC time.
+
+  private:
+    struct Zone_Rule {
+      char Name[16];         // The zone string as it appeared (empty if slot unused).
+      long Standard_Offset;  // Seconds east of UTC.
+      long Daylight_Offset;  // Seconds east of UTC during daylight saving time.
+      int  Rules;            // Which daylight saving time rules apply, if any.
+      bool Known;            // =false if the zone string wasn't understood.
+    };
+
+    enum { Cache_Size = 8 };
+    Zone_Rule Cache[Cache_Size];
+    int       Next_Slot;
+
+    const Zone_Rule &Lookup_Zone(const char *Name, int Length);
+    static void      Decode_Zone(const char *Name, int Length, Zone_Rule &Rule);
+};
+
+#endif
@@ -0,0 +1,208 @@
+/****************************************************************************
+FILE          : summary.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the notice summary extractor.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+// This is the first module of nbread.exe to use the C++11 thread library. See notes.txt.
+#if eCOMPILER == eOPENWATCOM || (eCOMPILER == eMICROSOFT && _MSC_VER < 1900)
+#error nbread needs a C++11 compiler with <thread>, <atomic> and <mutex> (Visual C++ 2015 or later)
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#if eOPSYS == eWIN32
+#include <windows.h>
+#undef min
+#undef max
+#elif eOPSYS == ePOSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#include "header.hpp"
+#include "metrics.hpp"
+#include "summary.hpp"
+#include "trace.hpp"
+
+static spica::metric_counter Summary_Files("summary.files_read");
+static spica::metric_counter Summary_Bytes("summary.bytes_read");
+
+//
+// Read_Prefix
+//
+// This function reads up to Size bytes from the start of the named file with one
+//   positioned read. It returns the number of bytes read or -1 if the file can't be opened.
+//
+static int Read_Prefix(const char *Path, char *Buffer, int Size)
+  {
+    #if eOPSYS == eWIN32
+    HANDLE File = CreateFile(
+      Path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (File == INVALID_HANDLE_VALUE) return -1;
+
+    OVERLAPPED Where;
+    memset(&Where, 0, sizeof(Where));
+    DWORD Count = 0;
+    if (!ReadFile(File, Buffer, Size, &Count, &Where)) Count = 0;
+    CloseHandle(File);
+    return static_cast<int>(Count);
+
+    #elif eOPSYS == ePOSIX
+    int File = open(Path, O_RDONLY);
+    if (File == -1) return -1;
+
+    ssize_t Count = pread(File, Buffer, Size, 0);
+    close(File);
+    return Count < 0 ? 0 : static_cast<int>(Count);
+
+    #else
+    #error Read_Prefix not implemented for this operating system!
+    #endif
+  }
+
+
+//
+// Message_IDs
+//
+// Extracts the message identifiers (the text between angle brackets) from a header value
+//   and appends them to Result separated by spaces. Anything outside of the brackets,
+//   such as comments or phrases in In-Reply-To, is ignored.
+//
+static void Message_IDs(const string &Value, string &Result)
+  {
+    string::size_type Open = Value.find('<');
+    while (Open != string::npos) {
+      string::size_type Close = Value.find('>', Open + 1);
+      if (Close == string::npos) break;
+      if (Close > Open + 1) {
+        if (!Result.empty()) Result += ' ';
+        Result.append(Value, Open + 1, Close - Open - 1);
+      }
+      Open = Value.find('<', Close + 1);
+    }
+  }
+
+
+//
+// Read_Summary
+//
+bool Read_Summary(const char *Path, Notice_Summary &Result)
+  {
+    char Buffer[Summary_PrefixSize];
+
+    int Count = Read_Prefix(Path, Buffer, Summary_PrefixSize);
+    Result.Opened = (Count >= 0);
+    Summary_Files.add();
+    if (Count > 0) Summary_Bytes.add(Count);
+    if (Count <= 0) return Result.Opened;
+
+    Header_Block Headers;
+    Headers.Parse(Buffer, Buffer + Count);
+    Result.Subject = Headers.Value("Subject");
+    Result.From    = Headers.Value("From");
+    Result.Date    = Headers.Value("Date");
+
+    // The parent is the last reference. Older software only sends In-Reply-To so use it
+    //   when it names something other than the last reference.
+    //
+    Message_IDs(Headers.Value("Message-ID"), Result.Message_ID);
+    Message_IDs(Headers.Value("References"), Result.References);
+
+    string Parent;
+    Message_IDs(Headers.Value("In-Reply-To"), Parent);
+    Parent = Parent.substr(0, Parent.find(' '));
+    if (!Parent.empty()) {
+      string::size_type Last = Result.References.rfind(' ');
+      string Last_Reference = (Last == string::npos) ? Result.References : Result.References.substr(Last + 1);
+      if (Last_Reference != Parent) {
+        if (!Result.References.empty()) Result.References += ' ';
+        Result.References += Parent;
+      }
+    }
+    return true;
+  }
+
+
+//
+// Read_Summaries
+//
+// Each worker claims the next unprocessed notice from a shared counter, so slow files
+//   don't hold up the other workers. Every result slot is written by exactly one worker.
+//
+void Read_Summaries(
+  const vector<string>   &Paths,
+  vector<Notice_Summary> &Results,
+  int                     Thread_Count)
+  {
+    const int Notices_PerThread = 16;
+      // Don't start a thread for fewer notices than this. Opening the files is cheap.
+
+    int Count = static_cast<int>(Paths.size());
+    Results.clear();
+    Results.resize(Count);
+
+    if (Thread_Count <= 0) {
+      Thread_Count = static_cast<int>(thread::hardware_concurrency());
+      if (Thread_Count <= 0) Thread_Count = 2;
+    }
+    if (Thread_Count > Count / Notices_PerThread) Thread_Count = Count / Notices_PerThread;
+    if (Thread_Count < 1) Thread_Count = 1;
+
+    atomic<int> Next_Index(0);
+
+    struct Worker {
+      static void Run(const vector<string> *Paths, vector<Notice_Summary> *Results, atomic<int> *Next)
+        {
+          spica::Trace_Span Span("Read_Summaries worker");
+          int Count = static_cast<int>(Paths->size());
+          int Index;
+          while ((Index = (*Next)++) < Count) {
+            Read_Summary((*Paths)[Index].c_str(), (*Results)[Index]);
+          }
+        }
+    };
+
+    // The calling thread works too.
+    vector<thread> Workers;
+    for (int i = 1; i < Thread_Count; i++) {
+      Workers.push_back(thread(Worker::Run, &Paths, &Results, &Next_Index));
+    }
+    Worker::Run(&Paths, &Results, &Next_Index);
+
+    for (vector<thread>::iterator Stepper = Workers.begin(); Stepper != Workers.end(); Stepper++) {
+      Stepper->join();
+    }
+  }
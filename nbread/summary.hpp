@@ -0,0 +1,77 @@
+/****************************************************************************
+FILE          : summary.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the notice summary extractor.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+The functions here pull the summary headers (Subject, From, and Date) and the
+threading headers (Message-ID, References, and In-Reply-To) out of notice
+files. Only a bounded prefix of each file is read, with a single positioned
+read, and parsing (see header.hpp) stops at the blank line that ends the
+headers. A whole topic's worth of notices can be processed as a batch by a
+group of worker threads.
+
+These functions use only standard strings. They don't touch spica::String
+(or anything else that isn't thread safe) so that they can run on worker
+threads. The caller is expected to clean up and store the results.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef SUMMARY_H
+#define SUMMARY_H
+
+#include <string>
+#include <vector>
+
+// The most that will be read from the front of a notice. Headers that start beyond this
+//   point are ignored.
+//
+const int Summary_PrefixSize = 8192;
+
+struct Notice_Summary {
+  bool        Opened;   // =false if the notice file could not be read at all.
+  std::string Subject;  // Raw header values (empty if the header was not found).
+  std::string From;
+  std::string Date;
+  std::string Message_ID;  // Just the identifier, without the angle brackets.
+  std::string References;  // Ancestor identifiers, oldest first, separated by spaces.
+
+  Notice_Summary() : Opened(false) { }
+};
+
+bool Read_Summary(const char *Path, Notice_Summary &Result);
+  // Reads the summary headers of one notice. Returns false if the file can't be opened.
+
+void Read_Summaries(
+  const std::vector<std::string> &Paths,
+  std::vector<Notice_Summary>    &Results,
+  int                             Thread_Count = 0
+);
+  // Reads the summary headers of every notice in Paths. Results[i] corresponds to
+  //   Paths[i]. A Thread_Count of zero picks a count based on the hardware.
+
+#endif
@@ -0,0 +1,372 @@
+/*! \file    trace.cpp
+    \brief   Implementation of a portable trace record buffer.
+    \author  Peter C. Chapin <PChapin@vtc.vsc.edu>
+
+Messages and spans are kept in separate rings of the same kind. Each slot in a ring has a
+state word that says which position last claimed it and whether the record is complete. A
+poster for position p moves the state to 2p+1 while it copies the record and to 2p+2 when it is
+done. The consumer takes a record only if the state is 2p+2 both before and after it copies the
+slot, so a record that is overwritten while being read is detected and skipped. A poster that
+finds its slot still being written by a poster from the previous lap (or already taken by a
+later one) abandons its record rather than wait.
+*/
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+
+#include "trace.hpp"
+
+namespace spica {
+
+    std::atomic<int>  trace_threshold(INT_MAX);
+    std::atomic<bool> trace_spans(false);
+
+    //--------------------------------------------
+    //           Internally Linked Data
+    //--------------------------------------------
+
+    //
+    // class record_ring
+    //
+    // A ring of Size records shared by any number of posters and one consumer at a time. A
+    // poster calls claim(), fills in the record it gets (if any), and calls commit(). Positions
+    // count up forever; the slot is the position modulo the ring size.
+    //
+    template<typename Record, std::size_t Size>
+    class record_ring {
+    public:
+        Record *claim(unsigned long long &position);
+        void    commit(unsigned long long position);
+        std::size_t drain(std::vector<Record> &records, bool wait = true);
+        unsigned long long lost() const { return lost_count.load(std::memory_order_relaxed); }
+
+    private:
+        struct slot {
+            std::atomic<unsigned long long> state;
+            Record                          record;
+        };
+
+        slot ring[Size];
+        std::atomic<unsigned long long> next_position;
+
+        // The consumer's position and the count of records it never got. The lock only
+        // serializes consumers. Posters never take it.
+        //
+        std::mutex          drain_lock;
+        unsigned long long  drain_position;
+        std::atomic<unsigned long long> lost_count;
+    };
+
+    // These are zero initialized before any constructor runs, so they can be used at any time.
+    static record_ring<trace_record, trace_ringSize> messages;
+    static record_ring<span_record, span_ringSize>   spans;
+
+    // Thread numbers are handed out on a thread's first post.
+    static std::atomic<unsigned> next_thread(1);
+
+    // The nesting depth of the open spans on this thread.
+    static thread_local unsigned span_depth = 0;
+
+
+    //---------------------------------------------------------
+    //           Internally Linked Support Functions
+    //---------------------------------------------------------
+
+    //
+    // current_thread
+    //
+    static unsigned current_thread()
+    {
+        static thread_local unsigned number = 0;
+        if (number == 0) number = next_thread.fetch_add(1, std::memory_order_relaxed);
+        return number;
+    }
+
+
+    //
+    // monotonic_time
+    //
+    // Returns the time in nanoseconds from an arbitrary starting point. The clock never goes
+    // backwards.
+    //
+    static unsigned long long monotonic_time()
+    {
+        return static_cast<unsigned long long>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+
+    //
+    // record_ring::claim
+    //
+    // Returns the record to fill in, or zero if the slot is still busy from the previous lap
+    // (or was already taken by a later one). The record is then abandoned rather than waited
+    // for; the consumer will count it as lost.
+    //
+    template<typename Record, std::size_t Size>
+    Record *record_ring<Record, Size>::claim(unsigned long long &position)
+    {
+        position = next_position.fetch_add(1, std::memory_order_relaxed);
+        slot &target = ring[position & (Size - 1)];
+
+        unsigned long long state = target.state.load(std::memory_order_relaxed);
+        if ((state & 1) != 0 || state > 2 * position ||
+            !target.state.compare_exchange_strong(state, 2 * position + 1, std::memory_order_acquire)) {
+            return 0;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        return &target.record;
+    }
+
+
+    //
+    // record_ring::commit
+    //
+    template<typename Record, std::size_t Size>
+    void record_ring<Record, Size>::commit(unsigned long long position)
+    {
+        ring[position & (Size - 1)].state.store(2 * position + 2, std::memory_order_release);
+    }
+
+
+    //
+    // record_ring::drain
+    //
+    // A slot that hasn't been completed yet stops the drain; the next drain will pick it up.
+    // If its poster abandoned it, though, it will never be completed, so once the ring has
+    // moved half a lap past it the slot is given up for lost. If 'wait' is false and another
+    // consumer is draining, nothing is taken.
+    //
+    template<typename Record, std::size_t Size>
+    std::size_t record_ring<Record, Size>::drain(std::vector<Record> &records, bool wait)
+    {
+        std::unique_lock<std::mutex> guard(drain_lock, std::defer_lock);
+        if (wait) guard.lock();
+        else if (!guard.try_lock()) return 0;
+        std::size_t count = 0;
+
+        unsigned long long head = next_position.load(std::memory_order_acquire);
+        if (head - drain_position > Size) {
+            lost_count.fetch_add(head - Size - drain_position, std::memory_order_relaxed);
+            drain_position = head - Size;
+        }
+
+        while (drain_position < head) {
+            slot &source = ring[drain_position & (Size - 1)];
+            unsigned long long wanted = 2 * drain_position + 2;
+
+            unsigned long long before = source.state.load(std::memory_order_acquire);
+            if (before < wanted && head - drain_position <= Size / 2) break;
+
+            bool taken = false;
+            if (before == wanted) {
+                Record copy = source.record;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (source.state.load(std::memory_order_relaxed) == before) {
+                    records.push_back(copy);
+                    count++;
+                    taken = true;
+                }
+            }
+            if (!taken) lost_count.fetch_add(1, std::memory_order_relaxed);
+            drain_position++;
+        }
+        return count;
+    }
+
+
+    //--------------------------------------
+    //           Public Functions
+    //--------------------------------------
+
+    //
+    // set_traceThreshold
+    //
+    void set_traceThreshold(int level)
+    {
+        trace_threshold.store(level, std::memory_order_relaxed);
+    }
+
+
+    //
+    // trace_post
+    //
+    void trace_post(int level, char kind, const char *text, const char *file, int line)
+    {
+        if (!trace_enabled(level)) return;
+
+        unsigned long long position;
+        trace_record *record = messages.claim(position);
+        if (record == 0) return;
+
+        record->number = position + 1;
+        record->level  = level;
+        record->kind   = kind;
+        record->thread = current_thread();
+        record->file   = file;
+        record->line   = line;
+
+        std::size_t length = (text == 0) ? 0 : std::strlen(text);
+        if (length >= trace_textSize) length = trace_textSize - 1;
+        std::memcpy(record->text, text, length);
+        record->text[length] = '\0';
+
+        messages.commit(position);
+    }
+
+
+    //
+    // trace_drain
+    //
+    std::size_t trace_drain(std::vector<trace_record> &records)
+    {
+        return messages.drain(records);
+    }
+
+
+    //
+    // trace_crashDrain
+    //
+    std::size_t trace_crashDrain(std::vector<trace_record> &records)
+    {
+        return messages.drain(records, false);
+    }
+
+
+    //
+    // trace_lost
+    //
+    unsigned long long trace_lost()
+    {
+        return messages.lost();
+    }
+
+
+    //
+    // format_traceRecord
+    //
+    void format_traceRecord(const trace_record &record, std::string &line)
+    {
+        char prefix[64];
+
+        switch (record.kind) {
+        case 'T':
+            std::sprintf(prefix, "%4llu TP: (%d) ", record.number, record.level);
+            break;
+        case 'X':
+            std::sprintf(prefix, "%4llu EX: (0) ", record.number);
+            break;
+        default:
+            std::sprintf(prefix, "%4llu   : (%d) ", record.number, record.level);
+            break;
+        }
+        line  = prefix;
+        line += record.text;
+
+        if (record.file != 0) {
+            char location[32];
+            std::sprintf(location, " LINE=%d", record.line);
+            line += " FILE=";
+            line += record.file;
+            line += location;
+        }
+    }
+
+
+    //
+    // set_traceSpans
+    //
+    void set_traceSpans(bool enabled)
+    {
+        trace_spans.store(enabled, std::memory_order_relaxed);
+    }
+
+
+    //
+    // Trace_Span::Trace_Span
+    //
+    Trace_Span::Trace_Span(const char *span_name) :
+        name(span_name), start(0)
+    {
+        if (!trace_spans.load(std::memory_order_relaxed)) return;
+        span_depth++;
+        start = monotonic_time();
+    }
+
+
+    //
+    // Trace_Span::~Trace_Span
+    //
+    // The span is recorded when it ends, so enclosing spans appear after the spans they
+    // contain. The export doesn't care about the order.
+    //
+    Trace_Span::~Trace_Span()
+    {
+        if (start == 0) return;
+        unsigned long long finish = monotonic_time();
+        span_depth--;
+
+        unsigned long long position;
+        span_record *record = spans.claim(position);
+        if (record == 0) return;
+
+        record->name   = name;
+        record->start  = start;
+        record->finish = finish;
+        record->thread = current_thread();
+        record->depth  = span_depth;
+        spans.commit(position);
+    }
+
+
+    //
+    // span_drain
+    //
+    std::size_t span_drain(std::vector<span_record> &records)
+    {
+        return spans.drain(records);
+    }
+
+
+    //
+    // export_chromeTrace
+    //
+    // The output is the JSON object format read by chrome://tracing and Perfetto. Each span
+    // is a complete ("X") event. Times are in microseconds from the earliest span.
+    //
+    std::size_t export_chromeTrace(std::ostream &output)
+    {
+        std::vector<span_record> records;
+        span_drain(records);
+
+        unsigned long long origin = 0;
+        for (std::vector<span_record>::iterator p = records.begin(); p != records.end(); ++p) {
+            if (origin == 0 || p->start < origin) origin = p->start;
+        }
+
+        output << "{\"traceEvents\":[";
+        for (std::vector<span_record>::iterator p = records.begin(); p != records.end(); ++p) {
+            char event[160];
+            std::sprintf(event,
+                "\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+                p->thread,
+                (p->start - origin) / 1000.0,
+                (p->finish - p->start) / 1000.0,
+                p->depth);
+
+            output << (p == records.begin() ? "\n" : ",\n") << "{\"name\":\"";
+            for (const char *c = p->name; *c != '\0'; ++c) {
+                if (*c == '"' || *c == '\\') output << '\\';
+                output << *c;
+            }
+            output << "\"," << event;
+        }
+        output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        return records.size();
+    }
+}
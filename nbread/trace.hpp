@@ -0,0 +1,134 @@
+/*! \file    trace.hpp
+    \brief   Interface to a portable trace record buffer.
+    \author  Peter C. Chapin <PChapin@vtc.vsc.edu>
+
+This component collects trace messages from any number of threads into a fixed size ring of
+records. Posting a message takes no locks and allocates no memory: the poster claims the next
+position with one atomic increment and copies the message into that slot. When the ring is full
+the oldest records are overwritten, so the ring always holds the most recent messages (as the
+debugging window always has). Messages above the current trace threshold are rejected before
+anything is formatted or copied.
+
+The records are taken out of the ring by a consumer, such as the Win32 debugging window or a
+console viewer, with trace_drain(). Formatting into display text is done then, by the consumer.
+
+Timing spans are kept in a second ring. A Trace_Span object records the time from its
+construction to its destruction, along with its thread and how deeply it is nested in other
+spans on that thread. Spans are off unless set_traceSpans() turns them on, and then cost two
+clock readings. They can be exported in the Chrome trace format for viewing in chrome://tracing
+or Perfetto.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace spica {
+
+    // The most text a record holds. Longer messages are truncated.
+    const std::size_t trace_textSize = 200;
+
+    // The number of records in the ring. This must be a power of two.
+    const std::size_t trace_ringSize = 1024;
+
+    // The number of spans kept. This must be a power of two.
+    const std::size_t span_ringSize = 16384;
+
+    //
+    // struct trace_record
+    //
+    // One message. The kind is 'T' for a Tracer, 'D' for a debugstream, and 'X' for an exception
+    // notification. The file name is only set for Tracers; it must be a string literal (or
+    // otherwise live forever) because only the pointer is kept.
+    //
+    struct trace_record {
+        unsigned long long number;  // Position in the sequence of all messages, from one.
+        int                level;
+        char               kind;
+        unsigned           thread;  // Small number identifying the posting thread.
+        const char        *file;
+        int                line;
+        char               text[trace_textSize];
+    };
+
+    // Records with a level above this are discarded. The default keeps everything.
+    extern std::atomic<int> trace_threshold;
+
+    inline bool trace_enabled(int level)
+    { return level <= trace_threshold.load(std::memory_order_relaxed); }
+
+    void set_traceThreshold(int level);
+
+    // Adds a record to the ring (if its level is enabled). The text is copied.
+    void trace_post(int level, char kind, const char *text, const char *file = 0, int line = 0);
+
+    // Moves the records posted since the last drain into 'records' (appending) and returns how
+    // many were added. Records that were overwritten before they could be drained are counted
+    // in trace_lost(). There should be one consumer at a time; concurrent calls are serialized.
+    //
+    std::size_t trace_drain(std::vector<trace_record> &records);
+
+    // Like trace_drain() but returns zero at once, without waiting, if another drain is in
+    // progress. This is meant for crash handlers.
+    //
+    std::size_t trace_crashDrain(std::vector<trace_record> &records);
+
+    // The number of records that were overwritten or abandoned before being drained.
+    unsigned long long trace_lost();
+
+    // Formats a record as a line of display text, in the style of the debugging window.
+    void format_traceRecord(const trace_record &record, std::string &line);
+
+    //
+    // struct span_record
+    //
+    // One completed span. Times are in nanoseconds on a monotonic clock with an arbitrary
+    // origin. The depth is the number of enclosing spans on the same thread.
+    //
+    struct span_record {
+        const char        *name;
+        unsigned long long start;
+        unsigned long long finish;
+        unsigned           thread;
+        unsigned           depth;
+    };
+
+    // =true when spans are being recorded.
+    extern std::atomic<bool> trace_spans;
+
+    void set_traceSpans(bool enabled);
+
+    //
+    // class Trace_Span
+    //
+    // Times the scope that contains it. The name must be a string literal (or otherwise live
+    // forever) because only the pointer is kept. Spans that start while recording is off are
+    // not recorded.
+    //
+    class Trace_Span {
+    public:
+        explicit Trace_Span(const char *span_name);
+       ~Trace_Span();
+
+    private:
+        const char        *name;
+        unsigned long long start;  // Zero if this span isn't being recorded.
+
+        // Spans can't be copied. Each one is recorded once.
+        Trace_Span(const Trace_Span &);
+        Trace_Span &operator=(const Trace_Span &);
+    };
+
+    // Moves the spans completed since the last drain into 'records' (appending).
+    std::size_t span_drain(std::vector<span_record> &records);
+
+    // Drains the spans and writes them as Chrome trace JSON. Returns the number written.
+    std::size_t export_chromeTrace(std::ostream &output);
+}
+
+#endif
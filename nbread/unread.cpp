@@ -0,0 +1,482 @@
+/****************************************************************************
+FILE          : unread.cpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the unread notice counter.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#include "environ.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+#if eOPSYS == eWIN32
+#include <windows.h>
+#undef min
+#undef max
+#endif
+
+using namespace std;
+
+#include "config.hpp"
+#include "nbdir.hpp"
+#include "unread.hpp"
+
+//
+// Trimmed
+//
+static string Trimmed(const string &Text)
+  {
+    string::size_type First = Text.find_first_not_of(" \t");
+    if (First == string::npos) return string();
+    string::size_type Last = Text.find_last_not_of(" \t");
+    return Text.substr(First, Last - First + 1);
+  }
+
+
+//
+// Folded_Path
+//
+// Returns a path with both kinds of separator made '/' and the letters in upper case, so
+//   that a Windows path and a Unix path to the same notice can be compared.
+//
+static string Folded_Path(const string &Path)
+  {
+    string Result(Path);
+    for (string::iterator Stepper = Result.begin(); Stepper != Result.end(); Stepper++) {
+      if (*Stepper == '\\') *Stepper = '/';
+      else *Stepper = static_cast<char>(toupper(static_cast<unsigned char>(*Stepper)));
+    }
+    return Result;
+  }
+
+
+//
+// Relative_Path
+//
+// If the folded path lies under the folded root, puts the rest of it in Remainder and
+//   returns true.
+//
+static bool Relative_Path(const string &Path, const string &Root, string &Remainder)
+  {
+    if (Root.empty() || Path.size() <= Root.size() || Path.compare(0, Root.size(), Root) != 0) return false;
+
+    string::size_type Start = Root.size();
+    if (Root[Start - 1] != '/') {
+      if (Path[Start] != '/') return false;
+      Start++;
+    }
+    Remainder = Path.substr(Start);
+    return true;
+  }
+
+
+//
+// Notify_Configuration
+//
+void Notify_Configuration(const string &Root, vector<Notify_Topic> &Topics)
+  {
+    // These are the topics that nbnotify has always watched.
+    static const char *Default_Topics[][2] = {
+      { "everyone", "Announcements for Everyone" },
+      { "lstfnd",   "Lost and Found"             },
+      { "meetings", "Meetings"                   },
+      { "rides",    "Rides"                      },
+      { "classifi", "Classifieds"                }
+    };
+
+    Topics.clear();
+
+    string *Mailbox = spica::lookup_parameter("Mailbox_Directory");
+    if (Mailbox != 0 && !Mailbox->empty()) {
+      Notify_Topic Mail;
+      Mail.Name    = "mail";
+      Mail.Title   = "E-Mail Messages";
+      Mail.Path    = *Mailbox;
+      Mail.Mailbox = true;
+      Topics.push_back(Mail);
+    }
+
+    vector<string> Names;
+    string *Configured = spica::lookup_parameter("Notify_Topics");
+    if (Configured == 0) {
+      for (size_t i = 0; i < sizeof(Default_Topics) / sizeof(Default_Topics[0]); i++) {
+        Names.push_back(Default_Topics[i][0]);
+      }
+    }
+    else {
+      string::size_type Start = 0;
+      while (Start <= Configured->size()) {
+        string::size_type Comma = Configured->find(',', Start);
+        if (Comma == string::npos) Comma = Configured->size();
+        string Name = Trimmed(Configured->substr(Start, Comma - Start));
+        if (!Name.empty()) Names.push_back(Name);
+        Start = Comma + 1;
+      }
+    }
+
+    for (size_t i = 0; i < Names.size(); i++) {
+      Notify_Topic Topic;
+      Topic.Name    = Names[i];
+      Topic.Title   = Names[i];
+      Topic.Path    = Join_Path(Root, Names[i]);
+      Topic.Mailbox = false;
+
+      // Subtopics are named with the usual separator. Allow '/' in the configuration too.
+      for (string::iterator Stepper = Topic.Path.begin(); Stepper != Topic.Path.end(); Stepper++) {
+        if (*Stepper == '/' || *Stepper == '\\') *Stepper = Path_Separator;
+      }
+
+      string *Title = spica::lookup_parameter(("Notify_Title." + Names[i]).c_str());
+      if (Title != 0 && !Title->empty()) Topic.Title = *Title;
+      else {
+        for (size_t j = 0; j < sizeof(Default_Topics) / sizeof(Default_Topics[0]); j++) {
+          if (Names[i] == Default_Topics[j][0]) Topic.Title = Default_Topics[j][1];
+        }
+      }
+      Topics.push_back(Topic);
+    }
+  }
+
+
+//
+// History_Source::History_Source
+//
+// The version is taken from the file's time and size. If the file doesn't exist the
+//   version is zero (an empty history). When paths are mapped the roots are mixed in as
+//   well, so that counts cached under a different mapping aren't used.
+//
+History_Source::History_Source(const string &File_Name, const string &Root) :
+  Name(File_Name), Stamp(0), Loaded(0)
+  {
+    long long Modified;
+    long long Size;
+    if (Path_Information(Name, Modified, Size)) Stamp = Modified ^ (Size << 40) ^ Size;
+
+    string *Configured = spica::lookup_parameter("History_Root");
+    if (Configured != 0 && !Trimmed(*Configured).empty()) {
+      History_Root = Folded_Path(Trimmed(*Configured));
+      Local_Root   = Folded_Path(Root);
+
+      unsigned long long Hash = 14695981039346656037ULL;
+      string Roots(History_Root + '\n' + Local_Root);
+      for (string::size_type i = 0; i < Roots.size(); i++) {
+        Hash = (Hash ^ static_cast<unsigned char>(Roots[i])) * 1099511628211ULL;
+      }
+      Stamp ^= static_cast<long long>(Hash >> 1);
+    }
+  }
+
+
+//
+// History_Source::~History_Source
+//
+History_Source::~History_Source()
+  {
+    delete Loaded;
+  }
+
+
+//
+// History_Source::Has_Read
+//
+// A path outside the local root (or any path, if there is no mapping) is looked up as it
+//   is.
+//
+bool History_Source::Has_Read(const string &Path)
+  {
+    if (Loaded == 0) {
+      Loaded = new History(Name.c_str());
+      Loaded->Inhibit_Write();
+      if (!History_Root.empty()) Loaded->Visit(Add_Mapped, this);
+    }
+
+    string Remainder;
+    if (!History_Root.empty() && Relative_Path(Folded_Path(Path), Local_Root, Remainder))
+      return Mapped.find(Remainder) != Mapped.end();
+    return Loaded->Has_Read(Path.c_str());
+  }
+
+
+//
+// History_Source::Add_Mapped
+//
+// History paths that aren't under History_Root can't match a local path, so they are left
+//   out.
+//
+void History_Source::Add_Mapped(const spica::String &Path, void *Self)
+  {
+    History_Source *Source = static_cast<History_Source *>(Self);
+    string          Remainder;
+
+    if (Relative_Path(Folded_Path(static_cast<const char *>(Path)), Source->History_Root, Remainder))
+      Source->Mapped.insert(Remainder);
+  }
+
+
+// The first line of an unread cache file.
+static const char Cache_Magic[] = "NBUNREAD1";
+
+//
+// Unread_Cache::Load
+//
+// Each line after the first holds one directory:
+//
+//   modified history-version total unread path
+//
+// The path is last since it may contain spaces.
+//
+bool Unread_Cache::Load(const char *File_Name)
+  {
+    Entries.clear();
+
+    FILE *Cache_File = fopen(File_Name, "r");
+    if (Cache_File == 0) return false;
+
+    char Line[4096];
+    bool Good = (fgets(Line, sizeof(Line), Cache_File) != 0 && strncmp(Line, Cache_Magic, strlen(Cache_Magic)) == 0);
+    while (Good && fgets(Line, sizeof(Line), Cache_File) != 0) {
+      Entry Item;
+      int   Path_Start = 0;
+      if (sscanf(Line, "%lld %lld %d %d %n",
+            &Item.Modified, &Item.History_Version, &Item.Total, &Item.Unread, &Path_Start) != 4 ||
+          Path_Start == 0) {
+        Good = false;
+        break;
+      }
+
+      string Path(Line + Path_Start);
+      while (!Path.empty() && (Path[Path.size() - 1] == '\n' || Path[Path.size() - 1] == '\r')) {
+        Path.erase(Path.size() - 1);
+      }
+      Entries[Path] = Item;
+    }
+    fclose(Cache_File);
+
+    if (!Good) Entries.clear();
+    return Good;
+  }
+
+
+//
+// Unread_Cache::Save
+//
+bool Unread_Cache::Save(const char *File_Name) const
+  {
+    string New_Name(File_Name);
+    New_Name.append(".new");
+
+    FILE *Cache_File = fopen(New_Name.c_str(), "w");
+    if (Cache_File == 0) return false;
+
+    fprintf(Cache_File, "%s\n", Cache_Magic);
+    for (map<string, Entry>::const_iterator Stepper = Entries.begin(); Stepper != Entries.end(); Stepper++) {
+      fprintf(Cache_File, "%lld %lld %d %d %s\n",
+        Stepper->second.Modified,
+        Stepper->second.History_Version,
+        Stepper->second.Total,
+        Stepper->second.Unread,
+        Stepper->first.c_str());
+    }
+    bool Written = (ferror(Cache_File) == 0);
+    if (fclose(Cache_File) != 0) Written = false;
+    if (!Written) {
+      remove(New_Name.c_str());
+      return false;
+    }
+
+    #if eOPSYS == eWIN32
+    return MoveFileEx(New_Name.c_str(), File_Name, MOVEFILE_REPLACE_EXISTING) != 0;
+    #else
+    return rename(New_Name.c_str(), File_Name) == 0;
+    #endif
+  }
+
+
+//
+// Unread_Cache::Lookup
+//
+bool Unread_Cache::Lookup(
+  const string &Path, long long Modified, long long History_Version, Unread_Count &Count) const
+  {
+    map<string, Entry>::const_iterator Found = Entries.find(Path);
+    if (Found == Entries.end()) return false;
+    if (Found->second.Modified != Modified || Found->second.History_Version != History_Version) return false;
+
+    Count.Readable = true;
+    Count.Total    = Found->second.Total;
+    Count.Unread   = Found->second.Unread;
+    return true;
+  }
+
+
+//
+// Unread_Cache::Store
+//
+void Unread_Cache::Store(
+  const string &Path, long long Modified, long long History_Version, const Unread_Count &Count)
+  {
+    Entry &Item = Entries[Path];
+    Item.Modified        = Modified;
+    Item.History_Version = History_Version;
+    Item.Total           = Count.Total;
+    Item.Unread          = Count.Unread;
+  }
+
+
+//
+// Count_Unread
+//
+// Listing the directories is the slow part (particularly on a file server), so that is done
+//   in parallel. Each worker claims the next topic from a shared counter. Directories that
+//   the cache already knows about are only looked at, not listed.
+//
+// A directory that was modified within the last couple of seconds isn't cached. Some file
+//   systems only keep times to the second (or two), so a notice added later in the same
+//   second wouldn't change the time.
+//
+void Count_Unread(
+  const vector<Notify_Topic> &Topics,
+  History_Source             &Read_Notices,
+  vector<Unread_Count>       &Counts,
+  Unread_Cache               *Cache,
+  int                         Thread_Count)
+  {
+    const long long Settle_Time = 2;
+      // Seconds before a directory's time can be trusted.
+
+    int Count = static_cast<int>(Topics.size());
+    vector<vector<Notice_File> > Listings(Count);
+    vector<long long>            Modified(Count, 0);
+    vector<char>                 From_Cache(Count, 0);
+    Counts.clear();
+    Counts.resize(Count);
+
+    long long Version = Read_Notices.Version();
+    long long Now     = static_cast<long long>(time(0));
+
+    if (Thread_Count <= 0) {
+      Thread_Count = static_cast<int>(thread::hardware_concurrency());
+      if (Thread_Count <= 0) Thread_Count = 2;
+    }
+    if (Thread_Count > Count) Thread_Count = Count;
+    if (Thread_Count < 1) Thread_Count = 1;
+
+    atomic<int> Next_Index(0);
+
+    // The workers only read the cache. It is updated afterwards.
+    struct Worker {
+      const vector<Notify_Topic>   *Topics;
+      vector<vector<Notice_File> > *Listings;
+      vector<long long>            *Modified;
+      vector<char>                 *From_Cache;
+      vector<Unread_Count>         *Counts;
+      const Unread_Cache           *Cache;
+      long long                     Version;
+      atomic<int>                  *Next;
+
+      void operator()() const
+        {
+          int Count = static_cast<int>(Topics->size());
+          int Index;
+          while ((Index = (*Next)++) < Count) {
+            const Notify_Topic &Topic = (*Topics)[Index];
+            long long Size;
+            if (!Path_Information(Topic.Path, (*Modified)[Index], Size)) continue;
+
+            if (Cache != 0 &&
+                Cache->Lookup(Topic.Path, (*Modified)[Index], Topic.Mailbox ? 0 : Version, (*Counts)[Index])) {
+              (*From_Cache)[Index] = 1;
+              continue;
+            }
+            (*Counts)[Index].Readable =
+              Scan_Topic(Topic.Path, 0, &(*Listings)[Index], Topic.Mailbox ? ".CNM" : ".CNB");
+          }
+        }
+    };
+    Worker Work = { &Topics, &Listings, &Modified, &From_Cache, &Counts, Cache, Version, &Next_Index };
+
+    // The calling thread works too.
+    vector<thread> Workers;
+    for (int i = 1; i < Thread_Count; i++) {
+      Workers.push_back(thread(Work));
+    }
+    Work();
+
+    for (vector<thread>::iterator Stepper = Workers.begin(); Stepper != Workers.end(); Stepper++) {
+      Stepper->join();
+    }
+
+    // Now check the new listings against the history. It is only read if there are any.
+    for (int i = 0; i < Count; i++) {
+      if (From_Cache[i] || !Counts[i].Readable) continue;
+
+      const vector<Notice_File> &Listing = Listings[i];
+      Counts[i].Total  = static_cast<int>(Listing.size());
+      Counts[i].Unread = Counts[i].Total;
+      if (!Topics[i].Mailbox) {
+        for (vector<Notice_File>::const_iterator Stepper = Listing.begin(); Stepper != Listing.end(); Stepper++) {
+          if (Read_Notices.Has_Read(Stepper->Path)) Counts[i].Unread--;
+        }
+      }
+
+      if (Cache != 0 && Modified[i] / 1000000000LL < Now - Settle_Time) {
+        Cache->Store(Topics[i].Path, Modified[i], Topics[i].Mailbox ? 0 : Version, Counts[i]);
+      }
+    }
+  }
+
+
+//
+// JSON_String
+//
+// Returns Text as a quoted JSON string.
+//
+string JSON_String(const string &Text)
+  {
+    string Result("\"");
+    for (string::const_iterator Stepper = Text.begin(); Stepper != Text.end(); Stepper++) {
+      unsigned char Ch = static_cast<unsigned char>(*Stepper);
+      if (Ch == '"' || Ch == '\\') {
+        Result += '\\';
+        Result += static_cast<char>(Ch);
+      }
+      else if (Ch < 0x20) {
+        char Escape[8];
+        sprintf(Escape, "\\u%04x", Ch);
+        Result += Escape;
+      }
+      else Result += static_cast<char>(Ch);
+    }
+    Result += '"';
+    return Result;
+  }
@@ -0,0 +1,161 @@
+/****************************************************************************
+FILE          : unread.hpp
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the unread notice counter.
+PROGRAMMER    : (C) Copyright 2026 by VTC Computer Club
+
+These functions are the portable core of the notifiers. The list of topics
+to watch comes from the configuration: Notify_Topics names the topics (as
+directories under the noticeboard root, separated by commas) and an
+optional Notify_Title.<name> parameter gives each one a friendly title. An
+optional Mailbox_Directory is counted as well. Without Notify_Topics the
+traditional five topics are used.
+
+The topic directories are listed concurrently by a group of worker threads.
+The history is only consulted afterwards, on the calling thread, since
+spica::String (which the History class uses) is not thread safe.
+
+An Unread_Cache remembers each directory's modification time along with
+its counts and the version of the history they were computed against. A
+directory whose time hasn't changed since then is not listed at all, and
+if no directory needs listing the history file is never read. On a quiet
+noticeboard a check only has to look at the directories themselves.
+
+The history file is written by nbread, which records each notice by the
+path it used, such as s:\nb\everyone\X.CNB. A program that sees the
+noticeboard somewhere else (/mnt/nb on a Unix machine, say) would never
+find its paths there. The History_Root parameter gives the noticeboard root
+as nbread saw it (s:\nb). When it is set, a notice counts as read if its
+path relative to the local root matches a history path relative to
+History_Root, with the separators folded together and case ignored.
+
+
+LICENSE
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANT-
+ABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+Please send comments or bug reports to
+
+     VTC^3
+     c/o Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     VTC3-L@vtc.vsc.edu
+****************************************************************************/
+
+#ifndef UNREAD_H
+#define UNREAD_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "history.hpp"
+
+struct Notify_Topic {
+  std::string Name;     // As given in the configuration.
+  std::string Title;    // For display.
+  std::string Path;     // Full path to the directory.
+  bool        Mailbox;  // =true for the mail directory. All mail in it counts as unread.
+};
+
+struct Unread_Count {
+  bool Readable;        // =false if the directory could not be listed.
+  int  Total;           // Number of notices (or messages) in the directory.
+  int  Unread;          // Number of those not in the history.
+
+  Unread_Count() : Readable(false), Total(0), Unread(0) { }
+};
+
+class History_Source {
+  public:
+    History_Source(const std::string &File_Name, const std::string &Local_Root);
+      // Local_Root is the noticeboard root as this program sees it. It is only used if
+      //   the History_Root parameter is set.
+
+   ~History_Source();
+
+    long long Version() const { return Stamp; }
+      // Identifies the current contents of the history file (and the way paths are
+      //   compared). It is based on the time and size of the file so it can be found
+      //   without reading the file.
+
+    bool Has_Read(const std::string &Path);
+      // Returns true if the notice with the given path is in the history. The history is
+      //   read the first time it is needed. It is never written back.
+
+  private:
+    std::string           Name;
+    std::string           History_Root;  // Folded (see unread.cpp). Empty if not mapping.
+    std::string           Local_Root;    // Folded.
+    long long             Stamp;
+    History              *Loaded;
+    std::set<std::string> Mapped;        // Folded history paths relative to History_Root.
+
+    static void Add_Mapped(const spica::String &Path, void *Self);
+
+    // History_Sources can't be copied. They own the History object.
+    History_Source(const History_Source &);
+    History_Source &operator=(const History_Source &);
+};
+
+class Unread_Cache {
+  public:
+    bool Load(const char *File_Name);
+      // Reads a cache file. A missing or damaged file leaves the cache empty.
+
+    bool Save(const char *File_Name) const;
+      // Writes the cache (to a new file which then replaces the old one).
+
+    bool Lookup(
+      const std::string &Path, long long Modified, long long History_Version, Unread_Count &Count) const;
+      // Returns true (and the counts) if the directory was counted when it had the given
+      //   modification time, against the given version of the history.
+
+    void Store(
+      const std::string &Path, long long Modified, long long History_Version, const Unread_Count &Count);
+      // Remembers the counts of a directory.
+
+  private:
+    struct Entry {
+      long long Modified;         // Directory modification time when it was counted.
+      long long History_Version;  // The history the unread count is relative to.
+      int       Total;
+      int       Unread;
+    };
+
+    std::map<std::string, Entry> Entries;  // Indexed by directory path.
+};
+
+void Notify_Configuration(const std::string &Root, std::vector<Notify_Topic> &Topics);
+  // Builds the list of topics to watch from the configuration (which must already have
+  //   been read). Root is the noticeboard root directory.
+
+void Count_Unread(
+  const std::vector<Notify_Topic> &Topics,
+  History_Source                  &Read_Notices,
+  std::vector<Unread_Count>       &Counts,
+  Unread_Cache                    *Cache = 0,
+  int                              Thread_Count = 0
+);
+  // Counts the unread notices in each topic. Counts[i] corresponds to Topics[i]. If a
+  //   cache is given it is used and brought up to date. A Thread_Count of zero picks a
+  //   count based on the hardware.
+
+std::string JSON_String(const std::string &Text);
+  // Returns Text as a quoted JSON string, for the programs that report counts as JSON.
+
+#endif
@@ -15,13 +15,14 @@ done reliably.
 #include <cstring>
 #include <deque>
 #include <fstream>
-#include <iomanip>
 #include <string>
+#include <vector>
 
 #include <windows.h>
 #undef max
 #undef min
 
+#include "logwrite.hpp"
 #include "windebug.hpp"
 #include "windebug.rh"
 #include "winexcept.hpp"
@@ -40,21 +41,23 @@ namespace spica {
         //
         const int MAX_MESSAGECOUNT = 250;
 
+        // How often new messages are collected from the trace ring (milliseconds).
+        const UINT COLLECT_INTERVAL = 200;
+
+        // The log file is rotated when it reaches this size, and this many old logs are kept.
+        const std::size_t LOG_ROTATESIZE = 4 * 1024 * 1024;
+        const int         LOG_KEEPCOUNT  = 3;
+
         //--------------------------------------------
         //           Internally Linked Data
         //--------------------------------------------
 
-        // This deque contains the debugging messages. It can be updated even if the debugging
-        // window is not around. Pretty cool, eh?
+        // This deque contains the debugging messages that have been collected from the trace
+        // ring. Messages are posted to the ring even if the debugging window is not around and
+        // the ring keeps the most recent ones. Pretty cool, eh?
         //
         static std::deque<std::string> debug_messages;
 
-        // This is the number of the next line to be displayed in the debug window. Numbering
-        // each line makes it easier to notice changes in the window and easier to refer to
-        // specific messages.
-        //
-        static int L_number = 1;
-
         // The window handle for the (one and only) debugging window.
         static HWND handle;
 
@@ -73,11 +76,17 @@ namespace spica {
         //
         static int V_position = 0, H_position = 0;
 
-        // This is the file object where debug messages are logged. Note that the destructor
-        // will close this file so that there is no need to worry about cleaning it up when the
-        // program exits.
+        // This is the writer that logs debug messages to a file. The lines are written by the
+        // writer's own thread. It is created the first time logging is started and never
+        // destroyed; lines still in memory when the program exits, and the messages still in
+        // the trace ring, are written by the writer's exit hook.
+        //
+        static log_writer *log_file = 0;
+
+        // The identifier of the timer that collects messages. The timer isn't attached to the
+        // debugging window so collection (and logging) continues after the window is closed.
         //
-        static std::ofstream log_file;
+        static UINT_PTR collect_timer = 0;
         
         // =true when debug messages are being logged to a file.
         static bool logging = false;
@@ -95,16 +104,6 @@ namespace spica {
         //
         static CRITICAL_SECTION debugMessages_mutex;
 
-        // This object is used to synchronize access to the L_number variable. Without this a
-        // second thread might end up reading the same value of L_number before the first thread
-        // has updated it. This situation occurs in the Say() members of debugstream and
-        // notifystream. This has to be a different mutex than the debugMessages_mutex because
-        // the stream classes have no direct knowledge of the debug messages deque and
-        // supporting information. In addition, two separate threads might be trying to Say()
-        // debug information at the same time.
-        //
-        static CRITICAL_SECTION lineNumber_mutex;
-        
         class Init_DebuggingCritical {
         private:
             CRITICAL_SECTION *cs;
@@ -118,13 +117,9 @@ namespace spica {
         };
 
         // This object will insure that the debugMessages_mutex will be initialized even if no
-        // debugging window is ever created. Threads can add messages to debug_messages before
-        // there is a debugging window.
+        // debugging window is ever created.
         //
         static Init_DebuggingCritical initializer_1(&debugMessages_mutex);
-
-        // This object will insure that lineNumber_mutex will be initialized properly as well.
-        static Init_DebuggingCritical initializer_2(&lineNumber_mutex);
 #endif
 
         //---------------------------------------------------------
@@ -132,21 +127,28 @@ namespace spica {
         //---------------------------------------------------------
 
         //
-        // display_debugText
+        // collect_debugText
         //
-        // This function writes a line of text into the debugging window's list of text. This
-        // function can be called even if the debugging window hasn't yet been created.
+        // This function moves any new messages from the trace ring into the debugging window's
+        // list of text (and the log file). It is called on the debugging window's thread.
         //
-        static void display_debugText(const std::string &line)
+        static void collect_debugText()
         {
+            std::vector<trace_record> records;
+            if (trace_drain(records) == 0) return;
+
 #if defined(eMULTITHREADED)
             Critical_Grabber critical(&debugMessages_mutex);
 #endif
 
-            if (logging) log_file << line << std::endl;
-     
-            // Add this line to the list.
-            debug_messages.push_back(line);
+            std::string line;
+            for (std::vector<trace_record>::iterator p = records.begin(); p != records.end(); ++p) {
+                format_traceRecord(*p, line);
+                if (logging) log_file->write(line);
+
+                // Add this line to the list.
+                debug_messages.push_back(line);
+            }
 
             // Check to see if we are to throw away a string in the list.
             while (debug_messages.size() > MAX_MESSAGECOUNT) {
@@ -168,6 +170,39 @@ namespace spica {
         }
 
 
+        //
+        // drain_debugText
+        //
+        // This is the log writer's drain hook. It moves whatever is left in the trace ring into
+        // the log file when the collect timer won't run again: at exit, and after a crash, where
+        // it gives up wherever it would have to wait for a lock. The list of text isn't touched;
+        // the window won't be painted again.
+        //
+        static void drain_debugText(bool crashing)
+        {
+            if (!logging || log_file == 0) return;
+
+            std::vector<trace_record> records;
+            if ((crashing ? trace_crashDrain(records) : trace_drain(records)) == 0) return;
+
+            std::string line;
+            for (std::vector<trace_record>::iterator p = records.begin(); p != records.end(); ++p) {
+                format_traceRecord(*p, line);
+                if (crashing) log_file->crash_write(line);
+                else log_file->write(line);
+            }
+        }
+
+
+        //
+        // collect_timerProc
+        //
+        static VOID CALLBACK collect_timerProc(HWND, UINT, UINT_PTR, DWORD)
+        {
+            collect_debugText();
+        }
+
+
         //
         // register_debugWindow
         //
@@ -461,20 +496,7 @@ namespace spica {
 
             // Function body.
         {
-            std::ostringstream message_text;
-            
-            {
-#if defined(eMULTITHREADED)
-                Critical_Grabber critical(&lineNumber_mutex);
-#endif
-                
-                message_text << std::setw(4) << L_number++
-                             << " TP: (" << level << ") "
-                             << message
-                             << " FILE=" << file
-                             << " LINE=" << line;
-            }
-            display_debugText(message_text.str().c_str());
+            trace_post(level, 'T', message, file, line);
         }
 
         //-------------------------------------------
@@ -483,17 +505,7 @@ namespace spica {
         
         void debugstream::say(int level)
         {
-            std::ostringstream message_text;
-
-            {
-#if defined(eMULTITHREADED)
-                Critical_Grabber critical(&lineNumber_mutex);
-#endif
-      
-                message_text << std::setw(4) << L_number++
-                             << "   : (" << level << ") " << str();
-            }
-            display_debugText(message_text.str());
+            if (trace_enabled(level)) trace_post(level, 'D', str().c_str());
         }
 
         //--------------------------------------------
@@ -510,16 +522,7 @@ namespace spica {
         //
         void notifystream::say(HWND window_handle)
         {
-            std::ostringstream message_text;
-            
-            {
-#if defined(eMULTITHREADED)
-                Critical_Grabber critical(&lineNumber_mutex);
-#endif
-      
-                message_text << std::setw(4) << L_number++ << " EX: (0) " << str();
-            }
-            display_debugText(message_text.str());
+            trace_post(0, 'X', str().c_str());
 
             // Show the user as well and wait for a reaction.
             MessageBox(window_handle,
@@ -585,6 +588,14 @@ namespace spica {
             UpdateWindow(handle);
 
             window_exists = true;
+
+            // Show what has been traced so far and keep watching for more.
+            collect_debugText();
+            if (collect_timer == 0) {
+                collect_timer = SetTimer(0, 0, COLLECT_INTERVAL, collect_timerProc);
+                if (collect_timer == 0)
+                    throw API_Error("Unable to start the debugging timer");
+            }
         }
 
 
@@ -673,6 +684,7 @@ namespace spica {
 
                         // We are ready to get the name of the file. (Finally!)
                         if (GetSaveFileName(&log_info) == TRUE) {
+                            collect_debugText();
 
                             // Open the file and send all the current debug text to it.
                             std::ofstream output_file(file_name);
@@ -701,7 +713,7 @@ namespace spica {
                     case DEBUG_STARTSAVE: {
 
                         // Turn off logging if it is already active.
-                        log_file.close();
+                        if (log_file != 0) log_file->close();
                         logging = false;
 
                         char file_name[260+1];
@@ -720,21 +732,23 @@ namespace spica {
 
                         // We are ready to get the name of the file. (Finally!)
                         if (GetSaveFileName(&log_info) == TRUE) {
-                            log_file.open(file_name);
-                            if (!log_file)
+                            if (log_file == 0) log_file = new log_writer;
+                            if (!log_file->open(file_name, LOG_ROTATESIZE, LOG_KEEPCOUNT))
                                 MessageBox(window_handle,
                                            "Unable to open file!", "Debug Error",
                                            MB_ICONEXCLAMATION
                                            );
-                            else
+                            else {
                                 logging = true;
+                                set_drainHook(drain_debugText);
+                            }
                         }
                     }
                         break;
 
                         // Stop logging debug messages.
                     case DEBUG_STOPSAVE:
-                        log_file.close();
+                        if (log_file != 0) log_file->close();
                         logging = false;
                         break;
 
@@ -14,6 +14,7 @@ station.
 #define WINDEBUG_H
 
 #include <sstream>
+#include "trace.hpp"
 
 namespace spica {
     namespace Win32 {
@@ -25,12 +26,12 @@ namespace spica {
         //
         void create_debugWindow();
         
-        // This class is useful for tracing program execution. Construction sends a message to
-        // the debug window. Destruction does not send a message. We can't fully control when an
-        // object gets destroyed, so such messages would be potentially very misleading. For the
-        // moment, the private members are not really being used. In the future I may implement
-        // some additional member functions that could call upon that private data. I need more
-        // experience with Tracer objects first.
+        // This class is useful for tracing program execution. Construction posts a message to
+        // the trace ring, from which the debug window collects it. Destruction does not send a
+        // message. We can't fully control when an object gets destroyed, so such messages would
+        // be potentially very misleading. For the moment, the private members are not really
+        // being used. In the future I may implement some additional member functions that could
+        // call upon that private data. I need more experience with Tracer objects first.
         //
         class Tracer {
         private:
@@ -52,10 +53,15 @@ namespace spica {
         // This macro makes it easier (possible!) to use Tracer objects. You provide the
         // message, and let the preprocessor fill in the file name and line number as
         // appropriate. Default arguments can't be used in the constructor otherwise every
-        // Tracer will have a file and line location that points to this header file!
+        // Tracer will have a file and line location that points to this header file! The
+        // level is checked against the trace threshold (see trace.hpp) first, so a disabled
+        // trace costs one comparison.
         //
-#define Tracer(level, message)                                  \
-        spica::Win32::Tracer(level, message, __FILE__, __LINE__);
+#define Tracer(level, message)                                               \
+        do {                                                                 \
+            if (spica::trace_enabled(level))                                 \
+                spica::Win32::Tracer(level, message, __FILE__, __LINE__);    \
+        } while (0)
 
 
         //